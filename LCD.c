@@ -2,6 +2,10 @@
 #include "inc/tm4c123gh6pm.h"
 #include "delay.h"
 #include "tiva-gc-inc.h"
+#include "mirror.h"
+#include "dma.h"
+#include "lowres.h"
+#include "fixed.h"
 
 #define DATAMODE_ACTIVESTATE HIGH
 #define RESET_ACTIVESTATE    LOW
@@ -58,9 +62,32 @@
 /* Active settings */
 static LCD_Settings _active_settings = {0};
 
+/* Background initialization state, next step to run by the Timer 1A handler */
+#define LCD_INIT_DONE 0xFF
+static volatile uint8_t _init_step = LCD_INIT_DONE;
+
+/* uDMA pixel transfer state, pixels left after the running transfer */
+static const uint16_t *volatile _dma_next = NULL;
+static volatile uint32_t _dma_left = 0;
+static volatile uint8_t _dma_busy = 0;
+
+/* Line buffers handed out by LCD_DMALine, and the one pushed last */
+static uint16_t _dma_lines[2][LCD_WIDTH] __attribute__((aligned(4)));
+static uint8_t _dma_line = 0;
+
+/* Point sorting for LCD_gPoints, keys are row << 23 | column << 16 | index, and where each
+   row starts among the sorted keys */
+static uint32_t _point_keys[2][LCD_POINTS_BATCH];
+static uint8_t _point_rows[LCD_HEIGHT + 1];
+
+/* Pixels plotted by the line and circle outlines, drawn with LCD_gPoints when full */
+#define LCD_PLOT_MAX 64
+static point _plot[LCD_PLOT_MAX];
+static uint8_t _plot_count = 0;
+
 // standard ascii 5x7 font
 // originally from glcdfont.c from Adafruit project
-static const uint8_t Font[] = {
+const uint8_t LCD_Font[] = {
   0x00, 0x00, 0x00, 0x00, 0x00,
   0x3E, 0x5B, 0x4F, 0x5B, 0x3E,
   0x3E, 0x6B, 0x4F, 0x6B, 0x3E,
@@ -320,11 +347,17 @@ static const uint8_t Font[] = {
 
 // Because compiler complained
 void InitSPI(void);
-void WriteSPI(uint8_t data);
+RAMFUNC void WriteSPI(uint8_t data);
 void LCD_Command(uint8_t command);
-void LCD_Data(uint8_t data);
-void LCD_DataBuffer(uint8_t *buffer, uint32_t count);
+RAMFUNC void LCD_Data(uint8_t data);
+RAMFUNC void LCD_DataBuffer(uint8_t *buffer, uint32_t count);
 void LCD_gCharT(int16_t x, int16_t y, char c, pixel textColor, uint8_t size);
+static void LCD_SSIFrameSize(uint8_t bits);
+static void LCD_PanelArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd);
+static void LCD_SetRun(int16_t x0, int16_t x1, int16_t y, uint8_t newRow);
+static void LCD_PointsBatch(const point *pts, const pixel *colors, uint16_t n, LCD_Color color);
+static void LCD_Plot(int16_t x, int16_t y, pixel color);
+static void LCD_PlotFlush(pixel color);
 
 // Initializes SSI as SPI to EDUMKII display
 void InitSPI(void)
@@ -362,63 +395,138 @@ void InitSPI(void)
     GPIO_PORTF_DEN_R |= 1 | (1 << 4);             // Digital enable
 }
 
+// LCD initialization sequence, split at every wait the panel needs. Both LCD_Init and
+// LCD_InitAsync run these steps, the first one blocking and the second one from a timer
+//  Param:
+//      step: step of the sequence to run, starting at 0
+//  Return:
+//      ms to wait before running the next step, 0 once the panel is ready
+static uint32_t LCD_InitSequence(uint8_t step)
+{
+    switch (step)
+    {
+    case 0:
+        GPIO_PORTF_DATA_R |= HIGH;                    // Pull reset down, is negative logic
+        return 100;
+
+    case 1:
+        LCD_CS(LOW);
+        LCD_Command(LCD_SWRESET);
+        return 150;           // 120 ms or more wait after SW reset
+
+    case 2:
+        LCD_Command(LCD_SLPOUT);                // Turn off sleep mode
+        return 150;           // 120 ms or more wait after sleep out
+
+    case 3:
+        LCD_Command(LCD_FRMCTR1);               // Framerate control
+        LCD_Data(0x01);
+        LCD_Data(0x06);
+        LCD_Data(0x03);
+
+        LCD_Command(LCD_PWCTR1);
+        LCD_Data(0xA2);
+        LCD_Data(0x02);
+        LCD_Data(0x84);
+        LCD_Command(LCD_PWCTR2);
+        LCD_Data(0xC5);
+        LCD_Command(LCD_PWCTR3);
+        LCD_Data(0x0A);
+        LCD_Data(0x00);
+        LCD_Command(LCD_PWCTR4);
+        LCD_Data(0x8A);
+        LCD_Data(0x2A);
+        LCD_Command(LCD_PWCTR5);
+        LCD_Data(0xEE);
+        LCD_Data(0x8A);
+
+        _active_settings.MemoryAccessCTL = LCD_MADCTL_MX | LCD_MADCTL_MY | LCD_MADCTL_BGR;
+        LCD_Command(LCD_MADCTL);                // Set memory access control
+        LCD_Data(_active_settings.MemoryAccessCTL);
+
+        _active_settings.ColorMode = LCD_PIXEL_FORMAT_666;
+        LCD_Command(LCD_COLMOD);                // Set interface pixel format
+        LCD_Data(_active_settings.ColorMode);
+        return 10;
+
+    case 4:
+        _active_settings.InversionMode = LCD_INVOFF;    // Screen inversion off
+        LCD_Command(_active_settings.InversionMode);
+        LCD_Command(LCD_GAMMA_PREDEFINED_4);    // Gamma curve 4
+
+        LCD_Command(LCD_TEOFF);
+
+        LCD_Command(LCD_DISPON);                // Turn LCD on
+        return 150;
+
+    default:
+        LCD_CS(HIGH);
+        return 0;
+    }
+}
+
 // LCD initialization
 //  Color mode: 18-bit/6-6-6 RGB
 void LCD_Init(void)
 {
+    uint32_t wait;
+
     InitSPI();
+    _active_settings.BGColor = LCD_BLACK;
 
-    GPIO_PORTF_DATA_R |= HIGH;                    // Pull reset down, is negative logic
-    delay(100);
-
-    LCD_CS(LOW);
-    LCD_Command(LCD_SWRESET);
-    delay(150);           // 120 ms or more wait after SW reset
-
-    LCD_Command(LCD_SLPOUT);                // Turn off sleep mode
-    delay(150);           // 120 ms or more wait after sleep out
-
-    LCD_Command(LCD_FRMCTR1);               // Framerate control
-    LCD_Data(0x01);
-    LCD_Data(0x06);
-    LCD_Data(0x03);
-
-    LCD_Command(LCD_PWCTR1);
-    LCD_Data(0xA2);
-    LCD_Data(0x02);
-    LCD_Data(0x84);
-    LCD_Command(LCD_PWCTR2);
-    LCD_Data(0xC5);
-    LCD_Command(LCD_PWCTR3);
-    LCD_Data(0x0A);
-    LCD_Data(0x00);
-    LCD_Command(LCD_PWCTR4);
-    LCD_Data(0x8A);
-    LCD_Data(0x2A);
-    LCD_Command(LCD_PWCTR5);
-    LCD_Data(0xEE);
-    LCD_Data(0x8A);
-
-    _active_settings.MemoryAccessCTL = LCD_MADCTL_MX | LCD_MADCTL_MY | LCD_MADCTL_BGR;
-    LCD_Command(LCD_MADCTL);                // Set memory access control
-    LCD_Data(_active_settings.MemoryAccessCTL);
-
-    _active_settings.ColorMode = LCD_PIXEL_FORMAT_666;
-    LCD_Command(LCD_COLMOD);                // Set interface pixel format
-    LCD_Data(_active_settings.ColorMode);
-    delay(10);
+    for (uint8_t step = 0; (wait = LCD_InitSequence(step)); step++)
+        delay(wait);
+}
+
+// LCD initialization in the background
+// Runs the init sequence from the Timer 1A interrupt, so the waits the panel needs
+// can be used for other setup. The SPI link must not be used until LCD_InitDone is 1
+//  Color mode: 18-bit/6-6-6 RGB
+void LCD_InitAsync(void)
+{
+    InitSPI();
+    _active_settings.BGColor = LCD_BLACK;
+    _init_step = 0;
 
-    _active_settings.InversionMode = LCD_INVOFF;    // Screen inversion off
-    LCD_Command(_active_settings.InversionMode);
-    LCD_Command(LCD_GAMMA_PREDEFINED_4);    // Gamma curve 4
+    SYSCTL_RCGCTIMER_R |= 0x02;              // Enable Timer 1
+    while (!(SYSCTL_PRTIMER_R & 0x02));      // Wait for enabled signal
 
-    LCD_Command(LCD_TEOFF);
+    TIMER1_CTL_R = 0;                        // Disable timer during setup
+    TIMER1_CFG_R = 0;                        // 32-bit mode
+    TIMER1_TAMR_R = 0x01;                    // One-shot, counting down
+    TIMER1_ICR_R = 0x01;                     // Clear pending timeout
+    TIMER1_IMR_R = 0x01;                     // Interrupt on timeout
+    NVIC_EN0_R = 1 << 21;                    // Timer 1A is interrupt 21
 
-    LCD_Command(LCD_DISPON);                // Turn LCD on
-    delay(150);
+    // Run the first step right away, it arms the timer for the next one
+    LCD_InitTimerISR();
+}
 
-    _active_settings.BGColor = LCD_BLACK;
-    LCD_CS(HIGH);
+// Returns 1 once the background initialization started with LCD_InitAsync is finished
+uint8_t LCD_InitDone(void)
+{
+    return _init_step == LCD_INIT_DONE;
+}
+
+// Timer 1A interrupt handler, runs one step of the background initialization
+void LCD_InitTimerISR(void)
+{
+    uint32_t wait;
+
+    TIMER1_ICR_R = 0x01;                     // Acknowledge timeout
+
+    wait = LCD_InitSequence(_init_step);
+    if (wait)
+    {
+        _init_step++;
+        TIMER1_TAILR_R = wait * (CLOCKS_PER_SEC / 1000) - 1;
+        TIMER1_CTL_R |= 0x01;                // Start one-shot
+    } else
+    {
+        TIMER1_IMR_R = 0;
+        NVIC_DIS0_R = 1 << 21;
+        _init_step = LCD_INIT_DONE;
+    }
 }
 
 // Get LCD settings
@@ -448,7 +556,7 @@ void LCD_SetInversion(uint8_t flag)
 }
 
 // Write a byte of data to the SPI buffer and wait for it to be sent
-void WriteSPI(uint8_t data)
+RAMFUNC void WriteSPI(uint8_t data)
 {
     SSI2_DR_R = data;
     while (!(SSI2_SR_R & 0x1));
@@ -468,7 +576,7 @@ void LCD_Command(uint8_t command)
 // Sets Register select to Data mode and sends a byte
 //  Param:
 //      data: data byte
-void LCD_Data(uint8_t data)
+RAMFUNC void LCD_Data(uint8_t data)
 {
     GPIO_PORTF_DATA_R |= (1 << 4);    // Data mode
     WriteSPI(data);
@@ -479,7 +587,7 @@ void LCD_Data(uint8_t data)
 //  Param:
 //      buffer: data byte array
 //      count: buffer element count
-void LCD_DataBuffer(uint8_t *buffer, uint32_t count)
+RAMFUNC void LCD_DataBuffer(uint8_t *buffer, uint32_t count)
 {
     GPIO_PORTF_DATA_R |= (1 << 4);    // Data mode
     for (uint32_t i = 0; i < count; i++)
@@ -511,6 +619,20 @@ void LCD_CS(uint8_t flag)
 //      colEnd: ending column < LCD_WIDTH
 //      rowEnd: ending row < LCD_HEIGHT
 void LCD_SetArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd)
+{
+#ifdef GE_LOWRES
+    // Low resolution windows are clipped by LowRes_Pixel, against the logical screen
+    if (LowRes_Enabled)
+    {
+        LowRes_Area(colStart, rowStart, colEnd, rowEnd);
+        return;
+    }
+#endif
+    LCD_PanelArea(colStart, rowStart, colEnd, rowEnd);
+}
+
+// Window on the panel itself, as LCD_SetArea without low resolution mode
+static void LCD_PanelArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd)
 {
     uint8_t buffer[4];
 
@@ -538,6 +660,11 @@ void LCD_SetArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t row
     if (rowEnd >= LCD_HEIGHT)
         rowEnd = LCD_HEIGHT - 1;
 
+#ifdef GE_MIRROR
+    if (Mirror_Enabled)
+        Mirror_Area(colStart, rowStart, colEnd, rowEnd);
+#endif
+
     colStart += 2;
     colEnd += 2;
     rowStart += 3;
@@ -564,6 +691,10 @@ void LCD_SetArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t row
 // Sends RAM write command, after which any number of pixels can be sent
 void LCD_ActivateWrite(void)
 {
+#ifdef GE_LOWRES
+    if (LowRes_Enabled)
+        return;
+#endif
     LCD_Command(LCD_RAMWR);
 }
 
@@ -590,16 +721,346 @@ void LCD_gDrawPixelS(uint8_t x, uint8_t y, pixel color)
     LCD_gDrawPixelE(x, y, color.r, color.g, color.b);
 }
 
+// Window of columns x0 to x1 on row y, followed by the memory write command
+// The row address is only sent when newRow is set, runs on the same row keep the last one
+static void LCD_SetRun(int16_t x0, int16_t x1, int16_t y, uint8_t newRow)
+{
+    uint8_t buffer[4] = {0};
+
+#ifdef GE_LOWRES
+    if (LowRes_Enabled)
+    {
+        LowRes_Area(x0, y, x1, y);
+        return;
+    }
+#endif
+#ifdef GE_MIRROR
+    if (Mirror_Enabled)
+        Mirror_Area(x0, y, x1, y);
+#endif
+
+    buffer[1] = x0 + 2;
+    buffer[3] = x1 + 2;
+    LCD_Command(LCD_CASET);
+    LCD_DataBuffer(buffer, 4);
+
+    if (newRow)
+    {
+        buffer[1] = y + 3;
+        buffer[3] = y + 3;
+        LCD_Command(LCD_RASET);
+        LCD_DataBuffer(buffer, 4);
+    }
+
+    LCD_Command(LCD_RAMWR);
+}
+
+// Draw up to LCD_POINTS_BATCH points, with one color or with colors[i] if colors is not NULL
+static void LCD_PointsBatch(const point *pts, const pixel *colors, uint16_t n, LCD_Color color)
+{
+    uint32_t *keys = _point_keys[0], *sorted = _point_keys[1];
+    uint8_t *rowStart = _point_rows;
+    uint16_t count = 0, i, j;
+    int16_t lastRow = -1;
+
+    for (i = 0; i <= LCD_HEIGHT; i++)
+        rowStart[i] = 0;
+
+    for (i = 0; i < n; i++)
+        if (pts[i].x >= 0 && pts[i].x < LCD_WIDTH && pts[i].y >= 0 && pts[i].y < LCD_HEIGHT)
+            keys[count++] = ((uint32_t) pts[i].y << 23) | ((uint32_t) pts[i].x << 16) | i;
+
+    // Counting sort by row, then insertion sort, which only moves keys within their row
+    for (i = 0; i < count; i++)
+        rowStart[(keys[i] >> 23) + 1]++;
+    for (i = 1; i <= LCD_HEIGHT; i++)
+        rowStart[i] += rowStart[i - 1];
+    for (i = 0; i < count; i++)
+        sorted[rowStart[keys[i] >> 23]++] = keys[i];
+    for (i = 1; i < count; i++)
+    {
+        uint32_t key = sorted[i];
+        for (j = i; j > 0 && sorted[j - 1] > key; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = key;
+    }
+
+    // Runs of adjacent columns on a row, repeated points included
+    for (i = 0; i < count; i = j)
+    {
+        int16_t y = sorted[i] >> 23;
+        int16_t x0 = (sorted[i] >> 16) & 0x7F, x1 = x0;
+
+        for (j = i + 1; j < count && (int16_t) (sorted[j] >> 23) == y && ((sorted[j] >> 16) & 0x7F) <= x1 + 1; j++)
+            x1 = (sorted[j] >> 16) & 0x7F;
+
+        LCD_SetRun(x0, x1, y, y != lastRow);
+        lastRow = y;
+
+        if (!colors)
+        {
+            LCD_PushColor(color, x1 - x0 + 1);
+            continue;
+        }
+        for (uint16_t k = i; k < j; k++)
+        {
+            pixel c = colors[sorted[k] & 0xFFFF];
+
+            // Of repeated points only the last one is sent, keys with the same column are
+            // ordered by index
+            if (k + 1 < j && ((sorted[k + 1] ^ sorted[k]) >> 16) == 0)
+                continue;
+            LCD_PushPixel(c.r, c.g, c.b);
+        }
+    }
+}
+
+// Draw scattered points of one color
+// Points are sorted by row and column and horizontally adjacent ones are sent as a single
+// window, so the cost goes with the number of runs rather than the number of points
+//  Param:
+//      pts: points, in any order
+//      n: number of points
+//      color: pixel
+void LCD_gPoints(const point *pts, uint16_t n, pixel color)
+{
+    LCD_Color encoded = LCD_Encode(color);
+
+    for (uint16_t i = 0; i < n; i += LCD_POINTS_BATCH)
+        LCD_PointsBatch(&pts[i], NULL, min(LCD_POINTS_BATCH, n - i), encoded);
+}
+
+// Draw scattered points, each with its own color, see LCD_gPoints
+//  Param:
+//      pts: points, in any order
+//      colors: color of each point
+//      n: number of points
+void LCD_gPointsColors(const point *pts, const pixel *colors, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i += LCD_POINTS_BATCH)
+        LCD_PointsBatch(&pts[i], &colors[i], min(LCD_POINTS_BATCH, n - i), 0);
+}
+
+// Add a pixel to the ones plotted by an outline, drawing them when the buffer is full
+static void LCD_Plot(int16_t x, int16_t y, pixel color)
+{
+    if (_plot_count == LCD_PLOT_MAX)
+        LCD_PlotFlush(color);
+    _plot[_plot_count].x = x;
+    _plot[_plot_count].y = y;
+    _plot_count++;
+}
+
+// Draw the pixels plotted so far
+static void LCD_PlotFlush(pixel color)
+{
+    LCD_gPoints(_plot, _plot_count, color);
+    _plot_count = 0;
+}
+
 // LCD write pixel data
 // Sends pixel data to current active window. Requires LCD_ActivateWrite
 // to have been the last command
 //  Param:
 //      red, green, blue: color value. Bits [5:0] (6 bits) are sent
-void LCD_PushPixel(uint8_t red, uint8_t green, uint8_t blue)
+RAMFUNC void LCD_PushPixel(uint8_t red, uint8_t green, uint8_t blue)
 {
+#ifdef GE_LOWRES
+    if (LowRes_Enabled)
+    {
+        LowRes_Pixel(red, green, blue);
+        return;
+    }
+#endif
+
     LCD_Data(red << 2);
     LCD_Data(green << 2);
     LCD_Data(blue << 2);
+
+#ifdef GE_MIRROR
+    if (Mirror_Enabled)
+        Mirror_Pixel(red, green, blue);
+#endif
+}
+
+// LCD write the same pixel many times
+// Keeps the transmit FIFO full instead of waiting for each byte to go out, then waits for the
+// last one so a command can follow
+//  Param:
+//      color: encoded color
+//      count: number of pixels
+RAMFUNC void LCD_PushColor(LCD_Color color, uint32_t count)
+{
+    uint8_t r = color, g = color >> 8, b = color >> 16;
+
+#ifdef GE_LOWRES
+    if (LowRes_Enabled)
+    {
+        while (count--)
+            LowRes_Pixel(r >> 2, g >> 2, b >> 2);
+        return;
+    }
+#endif
+#ifdef GE_MIRROR
+    if (Mirror_Enabled)
+        for (uint32_t i = 0; i < count; i++)
+            Mirror_Pixel(r >> 2, g >> 2, b >> 2);
+#endif
+
+    GPIO_PORTF_DATA_R |= (1 << 4);    // Data mode
+    while (count--)
+    {
+        while (!(SSI2_SR_R & 0x2));     // Wait while the FIFO is full
+        SSI2_DR_R = r;
+        while (!(SSI2_SR_R & 0x2));
+        SSI2_DR_R = g;
+        while (!(SSI2_SR_R & 0x2));
+        SSI2_DR_R = b;
+    }
+    while (SSI2_SR_R & 0x10);           // Wait until not busy
+}
+
+// Convert a pixel to RGB565, the format used by LCD_DMAPush
+// Like the panel, only bits [5:0] of each channel are used
+//  Param:
+//      color: pixel
+//  Return:
+//      RGB565 value
+uint16_t LCD_PixelTo565(pixel color)
+{
+    return ((color.r & 0x3E) << 10) | ((color.g & 0x3F) << 5) | ((color.b & 0x3F) >> 1);
+}
+
+// Change the SSI2 frame size once everything queued is sent. uDMA requests are only on with
+// 16-bit frames, which carry pixels
+//  Param:
+//      bits: 8 or 16
+static void LCD_SSIFrameSize(uint8_t bits)
+{
+    while (SSI2_SR_R & 0x10);               // Wait until not busy
+
+    SSI2_DMACTL_R = 0;
+    SSI2_CR1_R &= ~(1 << 1);
+    SSI2_CR0_R = (SSI2_CR0_R & ~0x0F) | (bits - 1);
+    SSI2_CR1_R |= (1 << 1);
+    if (bits == 16)
+        SSI2_DMACTL_R = 0x02;               // uDMA requests for transmit
+}
+
+// Start a uDMA write of 16-bit RGB565 pixels to an area
+// Switches the panel to 16-bit pixels and SSI2 to 16-bit frames until LCD_DMAEnd, so no other
+// LCD function may be used in between. Always writes to the panel, in low resolution mode too
+//  Param:
+//      colStart, rowStart, colEnd, rowEnd: area, as in LCD_SetArea
+void LCD_DMABegin(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd)
+{
+    static uint8_t ready = 0;
+
+    if (!ready)
+    {
+        DMA_Init();
+        DMA_Assign(DMA_CH_SSI2_TX, 2);
+        NVIC_EN1_R = 1 << (57 - 32);        // SSI2 is interrupt 57
+        ready = 1;
+    }
+
+    LCD_Command(LCD_COLMOD);
+    LCD_Data(LCD_PIXEL_FORMAT_565);
+    LCD_DMAArea(colStart, rowStart, colEnd, rowEnd);
+}
+
+// Move a uDMA write to another area, between LCD_DMABegin and LCD_DMAEnd
+// Waits for the last LCD_DMAPush to finish first
+//  Param:
+//      colStart, rowStart, colEnd, rowEnd: area, as in LCD_SetArea
+void LCD_DMAArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd)
+{
+    LCD_DMAWait();
+    LCD_SSIFrameSize(8);
+
+    LCD_PanelArea(colStart, rowStart, colEnd, rowEnd);
+    LCD_Command(LCD_RAMWR);
+
+    // Pixels go out high byte first as single 16-bit frames
+    GPIO_PORTF_DATA_R |= (1 << 4);          // Data mode
+    LCD_SSIFrameSize(16);
+}
+
+// Send RGB565 pixels to the area in the background
+// Waits for the previous LCD_DMAPush to finish first, so one buffer can be filled while the
+// other one is sent
+//  Param:
+//      pixels: pixels, must stay valid until the next LCD_DMAPush or LCD_DMAEnd
+//      count: number of pixels
+void LCD_DMAPush(const uint16_t *pixels, uint32_t count)
+{
+    uint16_t n = (count > DMA_MAX_ITEMS) ? DMA_MAX_ITEMS : count;
+
+    while (_dma_busy);
+
+    if (pixels >= _dma_lines[0] && pixels < _dma_lines[2])
+        _dma_line = (pixels >= _dma_lines[1]);
+
+#ifdef GE_MIRROR
+    if (Mirror_Enabled)
+        for (uint32_t i = 0; i < count; i++)
+            Mirror_Pixel((pixels[i] >> 10) & 0x3E, (pixels[i] >> 5) & 0x3F, (pixels[i] << 1) & 0x3E);
+#endif
+
+    if (!count)
+        return;
+    _dma_next = pixels + n;
+    _dma_left = count - n;
+    _dma_busy = 1;
+    DMA_SendHalfwords(DMA_CH_SSI2_TX, pixels, &SSI2_DR_R, n);
+}
+
+// Get a line buffer to fill and send with LCD_DMAPush
+// It is the one of two buffers not pushed last, so it is free once LCD_DMAPush has waited for
+// the previous push. A buffer that is not pushed is handed out again
+//  Return:
+//      LCD_WIDTH pixels
+uint16_t *LCD_DMALine(void)
+{
+    return _dma_lines[_dma_line ^ 1];
+}
+
+// Wait for the last LCD_DMAPush to be sent
+void LCD_DMAWait(void)
+{
+    while (_dma_busy);
+}
+
+// Wait for the last LCD_DMAPush and go back to 18-bit pixels and 8-bit frames
+void LCD_DMAEnd(void)
+{
+    LCD_DMAWait();
+    LCD_SSIFrameSize(8);
+
+    LCD_Command(LCD_COLMOD);
+    LCD_Data(_active_settings.ColorMode);
+}
+
+// SSI2 interrupt handler used by LCD_DMAPush, set in startup_gcc.c
+// Starts the next part of a push longer than a single uDMA transfer
+void LCD_SSIISR(void)
+{
+    uint16_t n;
+
+    UDMA_CHIS_R = 1u << DMA_CH_SSI2_TX;
+    if (DMA_Busy(DMA_CH_SSI2_TX))
+        return;
+
+    if (!_dma_left)
+    {
+        _dma_busy = 0;
+        return;
+    }
+
+    n = (_dma_left > DMA_MAX_ITEMS) ? DMA_MAX_ITEMS : _dma_left;
+    DMA_SendHalfwords(DMA_CH_SSI2_TX, _dma_next, &SSI2_DR_R, n);
+    _dma_next += n;
+    _dma_left -= n;
 }
 
 // Convert a 3 byte pixel (Eg #FF004A) uint32_t into pixel
@@ -669,7 +1130,7 @@ void LCD_gHLine(int16_t x1, int16_t x2, int16_t y, uint8_t stroke, pixel color)
 
 void LCD_gLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t stroke, pixel color)
 {
-    float m;
+    q16 step, pos;
     int16_t aux;
     uint8_t octant;
     int16_t x, y;
@@ -695,56 +1156,43 @@ void LCD_gLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t stroke, p
         y1 = aux;
     }
 
-    // find slope avoiding division by 0 with vertical lines
-    m = (float) (y2 - y1) / (x2 - x1);
-
-    // find octant
-    if (m > 1.0f)
+    // find octant from the slope, x2 - x1 is never 0 here
+    if (y2 - y1 > x2 - x1)
         octant = 2;
-    else if (m > 0.0f)
+    else if (y2 - y1 > 0)
         octant = 1;
-    else if (m > -1.0f)
+    else if (y2 - y1 > x1 - x2)
         octant = 8;
     else
         octant = 7;
 
-    // 2. Bresenham's
-    x = x1;
-    y = y1;
-
+    // 2. DDA in fixed point: the minor coordinate moves by a fraction of a pixel for every
+    // pixel of the major one, and is rounded to the nearest pixel
     switch (octant)
     {
     case 2:
-        for (y = y1; y <= y2 && y < LCD_HEIGHT; y++)
-        {
-            x = (y - y1) / m + x1;
-            LCD_gDrawPixelE((uint8_t) x, (uint8_t) y, color.r, color.g, color.b);
-        }
+        step = Fix_Div(FIX_INT(x2 - x1), FIX_INT(y2 - y1));
+        pos = FIX_INT(x1) + FIX_HALF;
+        for (y = y1; y <= y2 && y < LCD_HEIGHT; y++, pos += step)
+            LCD_Plot(Fix_Floor(pos), y, color);
         break;
     case 1:
-        for (x = x1; x <= x2 && x < LCD_WIDTH; x++)
-        {
-            y = m * (x - x1) + y1;
-            LCD_gDrawPixelE((uint8_t) x, (uint8_t) y, color.r, color.g, color.b);
-        }
-        break;
     case 8:
-        for (x = x1; x <= x2 && x < LCD_WIDTH; x++)
-        {
-            y = m * (x - x1) + y1;
-            LCD_gDrawPixelE((uint8_t) x, (uint8_t) y, color.r, color.g, color.b);
-        }
+        step = Fix_Div(FIX_INT(y2 - y1), FIX_INT(x2 - x1));
+        pos = FIX_INT(y1) + FIX_HALF;
+        for (x = x1; x <= x2 && x < LCD_WIDTH; x++, pos += step)
+            LCD_Plot(x, Fix_Floor(pos), color);
         break;
     case 7:
-        for (y = y1; y >= y2 && y >= 0; y--)
-        {
-            x = (y - y1) / m + x1;
-            LCD_gDrawPixelE((uint8_t) x, (uint8_t) y, color.r, color.g, color.b);
-        }
+        step = Fix_Div(FIX_INT(x2 - x1), FIX_INT(y1 - y2));
+        pos = FIX_INT(x1) + FIX_HALF;
+        for (y = y1; y >= y2 && y >= 0; y--, pos += step)
+            LCD_Plot(Fix_Floor(pos), y, color);
         break;
     default:
         return;
     }
+    LCD_PlotFlush(color);
 
     // 3. If stroke is not complete, define shift in position for next line
     if (stroke > 1)
@@ -781,14 +1229,19 @@ void LCD_gLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t stroke, p
 //      x, y: column and row of first corner
 //      w, h: width and height
 //      color: pixel
-void LCD_gFillRect(int16_t x, int16_t y, uint8_t w, uint8_t h, pixel color)
+RAMFUNC void LCD_gFillRect(int16_t x, int16_t y, uint8_t w, uint8_t h, pixel color)
 {
-    LCD_SetArea(x, y, x + w - 1, y + h - 1);
+    // Only the part on the screen is sent
+    int16_t x0 = max(x, 0), y0 = max(y, 0);
+    int16_t x1 = min(x + w - 1, LCD_WIDTH - 1), y1 = min(y + h - 1, LCD_HEIGHT - 1);
+
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    LCD_SetArea(x0, y0, x1, y1);
     LCD_ActivateWrite();
 
-    for (int i = 0; i <= h; i++)
-        for (int j = 0; j <= w; j++)
-            LCD_PushPixel(color.r, color.g, color.b);
+    LCD_PushColor(LCD_Encode(color), (uint32_t) (x1 - x0 + 1) * (y1 - y0 + 1));
 }
 
 // Rectangle outline
@@ -834,8 +1287,8 @@ void LCD_gFillTriangle(point v1, point v2, point v3, pixel color)
     // This does not matter though
 
     point top_v, bottom_v, middle_v, aux_v;
-    float invslope1, invslope2;
-    float curx1, curx2;
+    q16 invslope1, invslope2;
+    q16 curx1, curx2;
 
     // Sort points
     if (v1.y < v2.y && v1.y < v3.y)
@@ -880,21 +1333,24 @@ void LCD_gFillTriangle(point v1, point v2, point v3, pixel color)
     }
 
     // auxiliary point to divide the triangle into 2 sections
-    aux_v.x = (int)(top_v.x + ((float)(middle_v.y - top_v.y) / (float)(bottom_v.y - top_v.y)) * (bottom_v.x - top_v.x));
+    aux_v.x = top_v.x;
+    if (bottom_v.y != top_v.y)
+        aux_v.x = Fix_Round(FIX_INT(top_v.x) + Fix_Mul(Fix_Div(FIX_INT(middle_v.y - top_v.y), FIX_INT(bottom_v.y - top_v.y)),
+                                                       FIX_INT(bottom_v.x - top_v.x)));
     aux_v.y = middle_v.y;
 
     // Draw flat bottom triangle
     if (middle_v.y - top_v.y != 0 && aux_v.y - top_v.y != 0)
     {
-        invslope1 = (float) (middle_v.x - top_v.x) / (middle_v.y - top_v.y);
-        invslope2 = (float) (aux_v.x - top_v.x) / (aux_v.y - top_v.y);
+        invslope1 = Fix_Div(FIX_INT(middle_v.x - top_v.x), FIX_INT(middle_v.y - top_v.y));
+        invslope2 = Fix_Div(FIX_INT(aux_v.x - top_v.x), FIX_INT(aux_v.y - top_v.y));
 
-        curx1 = top_v.x;
-        curx2 = top_v.x;
+        curx1 = FIX_INT(top_v.x);
+        curx2 = FIX_INT(top_v.x);
 
         for (int16_t scanlineY = top_v.y; scanlineY > middle_v.y; scanlineY--)
         {
-            LCD_gHLine((int16_t) curx1, (int16_t) curx2, scanlineY, 1, color);
+            LCD_gHLine(Fix_Round(curx1), Fix_Round(curx2), scanlineY, 1, color);
             curx1 += invslope1;
             curx2 += invslope2;
         }
@@ -903,15 +1359,15 @@ void LCD_gFillTriangle(point v1, point v2, point v3, pixel color)
     // Draw flat top triangle
     if (bottom_v.y - middle_v.y != 0 && bottom_v.y - aux_v.y != 0)
     {
-        invslope1 = (float) (bottom_v.x - middle_v.x) / (bottom_v.y - middle_v.y);
-        invslope2 = (float) (bottom_v.x - aux_v.x) / (bottom_v.y - aux_v.y);
+        invslope1 = Fix_Div(FIX_INT(bottom_v.x - middle_v.x), FIX_INT(bottom_v.y - middle_v.y));
+        invslope2 = Fix_Div(FIX_INT(bottom_v.x - aux_v.x), FIX_INT(bottom_v.y - aux_v.y));
 
-        curx1 = bottom_v.x;
-        curx2 = bottom_v.x;
+        curx1 = FIX_INT(bottom_v.x);
+        curx2 = FIX_INT(bottom_v.x);
 
         for (int16_t scanlineY = bottom_v.y; scanlineY <= middle_v.y; scanlineY++)
         {
-            LCD_gHLine((int16_t) curx1, (int16_t) curx2, scanlineY, 1, color);
+            LCD_gHLine(Fix_Round(curx1), Fix_Round(curx2), scanlineY, 1, color);
             curx1 -= invslope1;
             curx2 -= invslope2;
         }
@@ -941,20 +1397,20 @@ void LCD_gPolygon(point *vertices, int n_vertices, uint8_t stroke, pixel color)
 //      r: circle radius
 //      stroke: outline width
 //      color: pixel
-void LCD_gCircle(int16_t x, int16_t y, float r, uint8_t stroke, pixel color)
+void LCD_gCircle(int16_t x, int16_t y, int16_t r, uint8_t stroke, pixel color)
 {
     int16_t x_ = 1, y_ = r;
     int16_t r2 = r * r + 1;
     int16_t res, res2;
 
-    if (r == 0.0f)
+    if (r <= 0)
         return;
 
     // intersections with X and Y are easy using the radius
-    LCD_gDrawPixelE(x + r, y, color.r, color.g, color.b);
-    LCD_gDrawPixelE(x - r, y, color.r, color.g, color.b);
-    LCD_gDrawPixelE(x, y + r, color.r, color.g, color.b);
-    LCD_gDrawPixelE(x, y - r, color.r, color.g, color.b);
+    LCD_Plot(x + r, y, color);
+    LCD_Plot(x - r, y, color);
+    LCD_Plot(x, y + r, color);
+    LCD_Plot(x, y - r, color);
 
     while (y_ / x_ >= 1)
     {
@@ -969,18 +1425,18 @@ void LCD_gCircle(int16_t x, int16_t y, float r, uint8_t stroke, pixel color)
             y_--;
         }
 
-        LCD_gDrawPixelE(x + x_, y - y_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x - x_, y - y_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x + x_, y + y_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x - x_, y + y_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x + y_, y - x_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x - y_, y - x_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x + y_, y + x_, color.r, color.g, color.b);
-        LCD_gDrawPixelE(x - y_, y + x_, color.r, color.g, color.b);
+        LCD_Plot(x + x_, y - y_, color);
+        LCD_Plot(x - x_, y - y_, color);
+        LCD_Plot(x + x_, y + y_, color);
+        LCD_Plot(x - x_, y + y_, color);
+        LCD_Plot(x + y_, y - x_, color);
+        LCD_Plot(x - y_, y - x_, color);
+        LCD_Plot(x + y_, y + x_, color);
+        LCD_Plot(x - y_, y + x_, color);
         x_++;
     }
 
-    return;
+    LCD_PlotFlush(color);
 }
 
 // Filled cricle
@@ -988,13 +1444,13 @@ void LCD_gCircle(int16_t x, int16_t y, float r, uint8_t stroke, pixel color)
 //      x, y: circle center position
 //      r: circle radius
 //      color: pixel
-void LCD_gFillCircle(int16_t x, int16_t y, float r, pixel color)
+void LCD_gFillCircle(int16_t x, int16_t y, int16_t r, pixel color)
 {
     int16_t x_ = 1, y_ = r;
     int16_t r2 = r * r + 1;
     int16_t res, res2;
 
-    if (r == 0.0f)
+    if (r <= 0)
         return;
 
     // intersections with X and Y are easy using the radius
@@ -1041,9 +1497,10 @@ void LCD_gFillCircle(int16_t x, int16_t y, float r, pixel color)
 //      textColor: character color
 //      bgColor: background color
 //      size: scale of the character
-void LCD_gChar(int16_t x, int16_t y, char c, pixel textColor, pixel bgColor, uint8_t size)
+RAMFUNC void LCD_gChar(int16_t x, int16_t y, char c, pixel textColor, pixel bgColor, uint8_t size)
 {
     uint8_t line;
+    LCD_Color fg = LCD_Encode(textColor), bg = LCD_Encode(bgColor);
 
     // no clipping the edges of the screen
     if ((x + 5 * size - 1) >= LCD_WIDTH ||
@@ -1070,19 +1527,13 @@ void LCD_gChar(int16_t x, int16_t y, char c, pixel textColor, pixel bgColor, uin
             for (int col = 0; col < 5; col++)
             {
                 // Only look at pixel in the correct row
-                if (Font[c * 5 + col] & line)
-                {
-                    for (int j = 0; j < size; j++)
-                        LCD_PushPixel(textColor.r, textColor.g, textColor.b);
-                } else
-                {
-                    for (int j = 0; j < size; j++)
-                        LCD_PushPixel(bgColor.r, bgColor.g, bgColor.b);
-                }
+                if (LCD_Font[c * 5 + col] & line)
+                    LCD_PushColor(fg, size);
+                else
+                    LCD_PushColor(bg, size);
             }
             // print blank column to the right of the character
-            for (int j = 0; j < size; j++)
-                LCD_PushPixel(bgColor.r, bgColor.g, bgColor.b);
+            LCD_PushColor(bg, size);
         }
     }
     // print black column on the left of the character
@@ -1113,7 +1564,7 @@ void LCD_gCharT(int16_t x, int16_t y, char c, pixel textColor, uint8_t size)
         if (i == 5)
             line = 0x00;
         else
-            line = Font[c * 5 + i];
+            line = LCD_Font[c * 5 + i];
         for (int j = 0; j < 8; j++, line >>= 1)
         {
             if (line & 0x01)
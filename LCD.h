@@ -40,6 +40,26 @@ typedef struct pixel
 #define LCD_ORANGE      (pixel) { 0x3f, 0x11, 0x00 }
 #define LCD_GOLD        (pixel) { 0x3f, 0x29, 0x00 }
 
+// Color encoded in the 18-bit wire format: the three bytes LCD_PushPixel sends, red in bits
+// [7:0], green in [15:8] and blue in [23:16]. Encoded once, it can be sent any number of times
+// with LCD_PushColor without shifting each channel again
+typedef uint32_t LCD_Color;
+
+// Encode a color from its channels, bits [5:0] are used. A constant expression when the
+// channels are constants, e.g. for tables
+#define LCD_COLOR(red, green, blue) \
+    ((LCD_Color) ((((red) & 0x3Fu) << 2) | (((green) & 0x3Fu) << 10) | (((blue) & 0x3Fu) << 18)))
+
+// Encode a pixel. The LCD_* colors above are folded to constants by the compiler
+//  Param:
+//      color: pixel
+//  Return:
+//      encoded color
+static inline LCD_Color LCD_Encode(pixel color)
+{
+    return LCD_COLOR(color.r, color.g, color.b);
+}
+
 typedef struct LCD_Settings
 {
     uint8_t InversionMode;
@@ -48,6 +68,10 @@ typedef struct LCD_Settings
     pixel BGColor;
 } LCD_Settings;
 
+// 5x7 font used by LCD_gChar and LCD_gString, 5 column bytes per character with the top row
+// in bit 0
+extern const uint8_t LCD_Font[];
+
 
 
 /* Initialization and settings
@@ -57,6 +81,21 @@ typedef struct LCD_Settings
 //  Color mode: 18-bit/6-6-6 RGB
 void LCD_Init(void);
 
+// LCD initialization in the background
+// Same sequence as LCD_Init, but the waits after reset and sleep out are done by
+// Timer 1A, so other setup can run in the meantime. Nothing else may be sent to the
+// LCD until LCD_InitDone returns 1
+//  Color mode: 18-bit/6-6-6 RGB
+void LCD_InitAsync(void);
+
+// Check if the initialization started with LCD_InitAsync is finished
+//  Return:
+//      1 if the LCD is ready, 0 if not
+uint8_t LCD_InitDone(void);
+
+// Timer 1A interrupt handler used by LCD_InitAsync
+void LCD_InitTimerISR(void);
+
 // Get LCD settings
 //  Return:
 //      LCD_Settings: currently active settings
@@ -103,7 +142,60 @@ void LCD_ActivateWrite(void);
 // to have been the last command, and requires an area to have been defined
 //  Param:
 //      red, green, blue: color value. Bits [5:0] (6 bits) are sent
-void LCD_PushPixel(uint8_t red, uint8_t green, uint8_t blue);
+RAMFUNC void LCD_PushPixel(uint8_t red, uint8_t green, uint8_t blue);
+
+// LCD write the same pixel many times
+// Like LCD_PushPixel count times, but the bytes go into the SSI FIFO as fast as it takes them,
+// so long runs are sent at the full SPI rate
+//  Param:
+//      color: encoded color
+//      count: number of pixels
+RAMFUNC void LCD_PushColor(LCD_Color color, uint32_t count);
+
+// Convert a pixel to RGB565, the format used by LCD_DMAPush
+// Like the panel, only bits [5:0] of each channel are used
+//  Param:
+//      color: pixel
+//  Return:
+//      RGB565 value
+uint16_t LCD_PixelTo565(pixel color);
+
+// Start a uDMA write of 16-bit RGB565 pixels to an area
+// Switches the panel to 16-bit pixels and SSI2 to 16-bit frames until LCD_DMAEnd, so no other
+// LCD function may be used in between
+//  Param:
+//      colStart, rowStart, colEnd, rowEnd: area, as in LCD_SetArea
+void LCD_DMABegin(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd);
+
+// Move a uDMA write to another area, between LCD_DMABegin and LCD_DMAEnd
+// Waits for the last LCD_DMAPush to finish first
+//  Param:
+//      colStart, rowStart, colEnd, rowEnd: area, as in LCD_SetArea
+void LCD_DMAArea(int16_t colStart, int16_t rowStart, int16_t colEnd, int16_t rowEnd);
+
+// Send RGB565 pixels to the area in the background
+// Waits for the previous LCD_DMAPush to finish first, so one buffer can be filled while the
+// other one is sent
+//  Param:
+//      pixels: pixels, must stay valid until the next LCD_DMAPush or LCD_DMAEnd
+//      count: number of pixels
+void LCD_DMAPush(const uint16_t *pixels, uint32_t count);
+
+// Get a line buffer to fill and send with LCD_DMAPush
+// It is the one of two buffers not pushed last, so it is free once LCD_DMAPush has waited for
+// the previous push. A buffer that is not pushed is handed out again
+//  Return:
+//      LCD_WIDTH pixels
+uint16_t *LCD_DMALine(void);
+
+// Wait for the last LCD_DMAPush to be sent
+void LCD_DMAWait(void);
+
+// Wait for the last LCD_DMAPush and go back to 18-bit pixels and 8-bit frames
+void LCD_DMAEnd(void);
+
+// SSI2 interrupt handler used by LCD_DMAPush, set in startup_gcc.c
+void LCD_SSIISR(void);
 
 
 
@@ -124,6 +216,31 @@ void LCD_gDrawPixelE(uint8_t x, uint8_t y, uint8_t red, uint8_t green, uint8_t b
 //      color: pixel containing color information
 void LCD_gDrawPixelS(uint8_t x, uint8_t y, pixel color);
 
+// The point functions, and the line and circle outlines that plot through them, work in
+// static buffers rather than on the stack. Like the rest of this driver they are not
+// reentrant: with tasks (task.h), only one task may draw at a time
+
+// Most points sorted at once by LCD_gPoints, larger sets are drawn in parts
+#define LCD_POINTS_BATCH 128
+
+// Draw scattered points of one color
+// Points are sorted by row and column and horizontally adjacent ones are sent as a single
+// window, so the cost goes with the number of runs rather than the number of points. Points
+// off the screen are skipped
+//  Param:
+//      pts: points, in any order
+//      n: number of points
+//      color: pixel
+void LCD_gPoints(const point *pts, uint16_t n, pixel color);
+
+// Draw scattered points, each with its own color, see LCD_gPoints
+// Where points repeat, the last one in the array is drawn
+//  Param:
+//      pts: points, in any order
+//      colors: color of each point
+//      n: number of points
+void LCD_gPointsColors(const point *pts, const pixel *colors, uint16_t n);
+
 // Convert a 3 byte pixel (Eg #FF004A) uint32_t into pixel
 // Precision loss: 8-bit -> 6-bit
 //  Param:
@@ -167,7 +284,7 @@ void LCD_gLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t stroke, p
 //      x, y: column and row of first corner
 //      w, h: width and height
 //      color: pixel
-void LCD_gFillRect(int16_t x, int16_t y, uint8_t w, uint8_t h, pixel color);
+RAMFUNC void LCD_gFillRect(int16_t x, int16_t y, uint8_t w, uint8_t h, pixel color);
 
 // Rectangle outline
 //  Param:
@@ -208,7 +325,7 @@ void LCD_gPolygon(point *vertices, int n_vertices, uint8_t stroke, pixel color);
 //      x, y: circle center position
 //      r: circle radius
 //      color: pixel
-void LCD_gFillCircle(int16_t x, int16_t y, float r, pixel color);
+void LCD_gFillCircle(int16_t x, int16_t y, int16_t r, pixel color);
 
 // Circle outline
 //  Param:
@@ -216,7 +333,7 @@ void LCD_gFillCircle(int16_t x, int16_t y, float r, pixel color);
 //      r: circle radius
 //      stroke: outline width
 //      color: pixel
-void LCD_gCircle(int16_t x, int16_t y, float r, uint8_t stroke, pixel color);
+void LCD_gCircle(int16_t x, int16_t y, int16_t r, uint8_t stroke, pixel color);
 
 // Draw character
 // Draws a 5x7 character on the given position. If the background color is the same as the
@@ -227,7 +344,7 @@ void LCD_gCircle(int16_t x, int16_t y, float r, uint8_t stroke, pixel color);
 //      textColor: character color
 //      bgColor: background color
 //      size: scale of the character
-void LCD_gChar(int16_t x, int16_t y, char c, pixel textColor, pixel bgColor, uint8_t size);
+RAMFUNC void LCD_gChar(int16_t x, int16_t y, char c, pixel textColor, pixel bgColor, uint8_t size);
 
 // Draw character with transparent background
 // Draws a 5x7 character on the given position.
@@ -0,0 +1,228 @@
+#include "affine.h"
+#include "tiva-gc-inc.h"
+
+// A uDMA write is going on, later rows move its window
+static uint8_t _open;
+
+static void Affine_Range(q16 f, q16 df, q16 size, int16_t *lo, int16_t *hi);
+RAMFUNC static void Affine_Sample(const Affine_Source *src, uint16_t *out, int16_t n, q16 u, q16 v,
+                                  q16 du, q16 dv);
+static void Affine_Window(int16_t x0, int16_t y, int16_t x1);
+static void Affine_Row(const Affine_Source *src, int16_t x, int16_t y, int16_t n, q16 u, q16 v,
+                       q16 du, q16 dv);
+
+// Narrow [lo, hi) to the steps i where f + i * df is in [0, size)
+static void Affine_Range(q16 f, q16 df, q16 size, int16_t *lo, int16_t *hi)
+{
+    int64_t first, last;        // first step inside and first step past it
+
+    if (df == 0)
+    {
+        if (f < 0 || f >= size)
+            *hi = *lo;
+        return;
+    }
+
+    if (df > 0)
+    {
+        first = (f >= 0) ? 0 : ((int64_t) -f + df - 1) / df;
+        last = (f < size) ? ((int64_t) size - 1 - f) / df + 1 : 0;
+    }
+    else
+    {
+        first = (f >= size) ? ((int64_t) f - size) / -df + 1 : 0;
+        last = (f >= 0) ? (int64_t) f / -df + 1 : 0;
+    }
+
+    if (first > *lo)
+        *lo = (first < *hi) ? first : *hi;
+    if (last < *hi)
+        *hi = (last > *lo) ? last : *lo;
+}
+
+// Sample n source pixels as RGB565, stepping the coordinates
+RAMFUNC static void Affine_Sample(const Affine_Source *src, uint16_t *out, int16_t n, q16 u, q16 v,
+                                  q16 du, q16 dv)
+{
+    uint32_t w = src->width;
+
+    if (src->flags & AFFINE_WRAP)
+    {
+        uint32_t mu = (w << 16) - 1, mv = ((uint32_t) src->height << 16) - 1;
+
+        if (src->palette)
+        {
+            const uint8_t *pixels = src->pixels;
+            while (n--)
+            {
+                *out++ = src->palette[pixels[(((uint32_t) v & mv) >> 16) * w + (((uint32_t) u & mu) >> 16)]];
+                u += du;
+                v += dv;
+            }
+        }
+        else
+        {
+            const uint16_t *pixels = src->pixels;
+            while (n--)
+            {
+                *out++ = pixels[(((uint32_t) v & mv) >> 16) * w + (((uint32_t) u & mu) >> 16)];
+                u += du;
+                v += dv;
+            }
+        }
+    }
+    else if (src->palette)
+    {
+        const uint8_t *pixels = src->pixels;
+        while (n--)
+        {
+            *out++ = src->palette[pixels[(v >> 16) * w + (u >> 16)]];
+            u += du;
+            v += dv;
+        }
+    }
+    else
+    {
+        const uint16_t *pixels = src->pixels;
+        while (n--)
+        {
+            *out++ = pixels[(v >> 16) * w + (u >> 16)];
+            u += du;
+            v += dv;
+        }
+    }
+}
+
+// Send the next pixels to a window on a row
+static void Affine_Window(int16_t x0, int16_t y, int16_t x1)
+{
+    if (_open)
+        LCD_DMAArea(x0, y, x1, y);
+    else
+    {
+        LCD_DMABegin(x0, y, x1, y);
+        _open = 1;
+    }
+}
+
+// Draw a row of n pixels from x, leaving out the pixels outside the source
+static void Affine_Row(const Affine_Source *src, int16_t x, int16_t y, int16_t n, q16 u, q16 v,
+                       q16 du, q16 dv)
+{
+    uint16_t *line = LCD_DMALine();
+    int16_t lo = 0, hi = n;
+
+    if (!(src->flags & AFFINE_WRAP))
+    {
+        Affine_Range(u, du, FIX_INT(src->width), &lo, &hi);
+        Affine_Range(v, dv, FIX_INT(src->height), &lo, &hi);
+        if (lo >= hi)
+            return;
+        u += lo * du;
+        v += lo * dv;
+        x += lo;
+        n = hi - lo;
+    }
+
+    Affine_Sample(src, line, n, u, v, du, dv);
+
+    if (src->flags & AFFINE_KEY)
+    {
+        uint16_t key = src->palette ? src->palette[0] : src->key;
+        int16_t i = 0, j;
+
+        // Runs of drawn pixels, each in its own window
+        while (i < n)
+        {
+            for (; i < n && line[i] == key; i++);
+            for (j = i; j < n && line[j] != key; j++);
+            if (j > i)
+            {
+                Affine_Window(x + i, y, x + j - 1);
+                LCD_DMAPush(&line[i], j - i);
+            }
+            i = j;
+        }
+    }
+    else
+    {
+        Affine_Window(x, y, x + n - 1);
+        LCD_DMAPush(line, n);
+    }
+}
+
+// Make a matrix that rotates and scales a bitmap around a point
+//  Param:
+//      m: matrix
+//      angle: clockwise rotation on screen, FIX_TURN is a full turn
+//      scale: size on screen of a source pixel
+//      x, y: screen position of the source point
+//      u, v: source point, e.g. the center of the bitmap
+void Affine_RotoZoom(Affine_Matrix *m, uint16_t angle, q16 scale, int16_t x, int16_t y, q16 u, q16 v)
+{
+    q16 s = Fix_Div(Fix_Sin(angle), scale), c = Fix_Div(Fix_Cos(angle), scale);
+
+    // Inverse rotation and scale, from the centers of screen pixels
+    m->a = c;
+    m->b = s;
+    m->d = -s;
+    m->e = c;
+    m->c = u - m->a * x - m->b * y + (m->a + m->b) / 2;
+    m->f = v - m->d * x - m->e * y + (m->d + m->e) / 2;
+}
+
+// Draw a bitmap through a matrix, in a rectangle of the screen
+//  Param:
+//      src: source bitmap
+//      m: matrix from screen to source coordinates
+//      x0, y0, x1, y1: screen rectangle, corners included, clipped to the screen
+void Affine_Blit(const Affine_Source *src, const Affine_Matrix *m, int16_t x0, int16_t y0,
+                 int16_t x1, int16_t y1)
+{
+    q16 u, v;
+
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, LCD_WIDTH - 1);
+    y1 = min(y1, LCD_HEIGHT - 1);
+    if (!src->pixels || x0 > x1 || y0 > y1)
+        return;
+
+    u = m->a * x0 + m->b * y0 + m->c;
+    v = m->d * x0 + m->e * y0 + m->f;
+    for (int16_t y = y0; y <= y1; y++, u += m->b, v += m->e)
+        Affine_Row(src, x0, y, x1 - x0 + 1, u, v, m->a, m->d);
+
+    if (_open)
+        LCD_DMAEnd();
+    _open = 0;
+}
+
+// Draw a bitmap with source coordinates given for every row, in a rectangle of the screen
+//  Param:
+//      src: source bitmap
+//      lines: coordinates at x0 of every row from y0 to y1
+//      x0, y0, x1, y1: screen rectangle, corners included, clipped to the screen
+void Affine_BlitLines(const Affine_Source *src, const Affine_Line *lines, int16_t x0, int16_t y0,
+                      int16_t x1, int16_t y1)
+{
+    int16_t skip = (x0 < 0) ? -x0 : 0, top = y0;
+
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, LCD_WIDTH - 1);
+    y1 = min(y1, LCD_HEIGHT - 1);
+    if (!src->pixels || x0 > x1 || y0 > y1)
+        return;
+
+    for (int16_t y = y0; y <= y1; y++)
+    {
+        const Affine_Line *l = &lines[y - top];
+
+        Affine_Row(src, x0, y, x1 - x0 + 1, l->u + skip * l->du, l->v + skip * l->dv, l->du, l->dv);
+    }
+
+    if (_open)
+        LCD_DMAEnd();
+    _open = 0;
+}
@@ -0,0 +1,75 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+/*
+    Rotated and scaled bitmaps. A 2x3 matrix of q16 numbers (see fixed.h) gives the source pixel for
+    every screen pixel, so the screen is walked row by row and the source coordinates only
+    need an addition per pixel. Each row is sampled into a line buffer and sent by uDMA in
+    one window while the next row is sampled.
+
+    Screen pixels whose source coordinates fall outside the bitmap are left as they are, so a
+    rotated sprite does not paint the corners of its bounding box. Sources can instead wrap
+    around for tiled planes, and Affine_BlitLines takes the coordinates of each row, for
+    planes seen in perspective (mode 7).
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+#include "fixed.h"
+
+// Source flags
+#define AFFINE_WRAP 0x01            // coordinates wrap around, size must be a power of 2
+#define AFFINE_KEY  0x02            // the key color, or the color of index 0, is not drawn
+
+typedef struct Affine_Source
+{
+    const void *pixels;             // RGB565 colors, or palette indices with a palette
+    const uint16_t *palette;        // RGB565 palette, NULL for RGB565 sources
+    uint16_t width, height;
+    uint16_t key;                   // RGB565 color left out with AFFINE_KEY
+    uint8_t flags;                  // AFFINE_*
+} Affine_Source;
+
+// Source coordinates of a screen pixel:
+//     u = a * x + b * y + c
+//     v = d * x + e * y + f
+// The integer part of u, v is the source pixel
+typedef struct Affine_Matrix
+{
+    q16 a, b, c;
+    q16 d, e, f;
+} Affine_Matrix;
+
+// Source coordinates of the first pixel of a row and their step to the next pixel
+typedef struct Affine_Line
+{
+    q16 u, v;
+    q16 du, dv;
+} Affine_Line;
+
+// Make a matrix that rotates and scales a bitmap around a point
+//  Param:
+//      m: matrix
+//      angle: clockwise rotation on screen, FIX_TURN is a full turn
+//      scale: size on screen of a source pixel
+//      x, y: screen position of the source point
+//      u, v: source point, e.g. the center of the bitmap
+void Affine_RotoZoom(Affine_Matrix *m, uint16_t angle, q16 scale, int16_t x, int16_t y, q16 u, q16 v);
+
+// Draw a bitmap through a matrix, in a rectangle of the screen
+//  Param:
+//      src: source bitmap
+//      m: matrix from screen to source coordinates
+//      x0, y0, x1, y1: screen rectangle, corners included, clipped to the screen
+void Affine_Blit(const Affine_Source *src, const Affine_Matrix *m, int16_t x0, int16_t y0,
+                 int16_t x1, int16_t y1);
+
+// Draw a bitmap with source coordinates given for every row, in a rectangle of the screen
+//  Param:
+//      src: source bitmap
+//      lines: coordinates at x0 of every row from y0 to y1
+//      x0, y0, x1, y1: screen rectangle, corners included, clipped to the screen
+void Affine_BlitLines(const Affine_Source *src, const Affine_Line *lines, int16_t x0, int16_t y0,
+                      int16_t x1, int16_t y1);
+
+#endif // AFFINE_H
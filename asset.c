@@ -0,0 +1,281 @@
+#include "asset.h"
+#include "audio.h"
+#include "image.h"
+#include "pix.h"
+
+// Empty pack, replaced by the generated one when the build has assets
+__attribute__((weak)) const uint32_t Asset_Pack[] = { ASSET_MAGIC, ASSET_VERSION };
+
+static Image_Decoder _decoder;
+
+static const Asset_Entry *Asset_GetEntry(uint16_t id, uint8_t type);
+
+// Entry of an asset of the given type, NULL if there is none
+static const Asset_Entry *Asset_GetEntry(uint16_t id, uint8_t type)
+{
+    const Asset_Entry *entries = (const Asset_Entry *) ((const Asset_Header *) Asset_Pack + 1);
+
+    if (id >= Asset_Count() || entries[id].type != type)
+        return NULL;
+    return &entries[id];
+}
+
+// Get the number of assets in the pack
+//  Return:
+//      number of assets, 0 if the pack is missing or invalid
+uint16_t Asset_Count(void)
+{
+    const Asset_Header *header = (const Asset_Header *) Asset_Pack;
+
+    if (header->magic != ASSET_MAGIC || header->version != ASSET_VERSION)
+        return 0;
+    return header->count;
+}
+
+// Get an asset
+//  Param:
+//      id: asset ID
+//      type: expected type, ASSET_*
+//  Return:
+//      header of the asset, NULL if there is no such asset of that type
+const void *Asset_Get(uint16_t id, uint8_t type)
+{
+    const Asset_Entry *entry = Asset_GetEntry(id, type);
+
+    if (!entry)
+        return NULL;
+    return (const uint8_t *) Asset_Pack + entry->offset;
+}
+
+// Get the colors of a palette
+//  Param:
+//      id: palette asset ID
+//  Return:
+//      RGB565 colors, NULL if there is no such palette
+const uint16_t *Asset_GetPalette(uint16_t id)
+{
+    const Asset_Palette *palette = Asset_Get(id, ASSET_PALETTE);
+
+    if (!palette)
+        return NULL;
+    return Asset_Data(palette, sizeof(Asset_Palette));
+}
+
+// Draw a bitmap, clipped to the screen
+// RGB565 bitmaps are sent from flash by uDMA, row by row. Compressed bitmaps are decoded and
+// indexed bitmaps go through their palette one row at a time, index 0 included. Everything is
+// sent in a single window
+//  Param:
+//      id: bitmap asset ID
+//      x, y: top left corner
+void Asset_Blit(uint16_t id, int16_t x, int16_t y)
+{
+    const Asset_Entry *entry = Asset_GetEntry(id, ASSET_BITMAP);
+    const Asset_Bitmap *bmp;
+    const uint16_t *palette = NULL;
+    int16_t x0, y0, x1, y1;
+    uint8_t n;
+
+    if (!entry)
+        return;
+    bmp = (const Asset_Bitmap *) ((const uint8_t *) Asset_Pack + entry->offset);
+
+    x0 = max(x, 0);
+    y0 = max(y, 0);
+    x1 = min(x + bmp->width - 1, LCD_WIDTH - 1);
+    y1 = min(y + bmp->height - 1, LCD_HEIGHT - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+    n = x1 - x0 + 1;
+
+    if (entry->format == ASSET_INDEXED8 && !(palette = Asset_GetPalette(bmp->palette)))
+        return;
+
+    LCD_DMABegin(x0, y0, x1, y1);
+
+    if (entry->format == ASSET_RGB565)
+    {
+        const uint16_t *pixels = Asset_Data(bmp, sizeof(Asset_Bitmap));
+
+        // Rows that are not clipped are contiguous in flash, so they go in a single push
+        if (n == bmp->width)
+            LCD_DMAPush(&pixels[(y0 - y) * bmp->width], (uint32_t) n * (y1 - y0 + 1));
+        else
+            for (int16_t row = y0; row <= y1; row++)
+                LCD_DMAPush(&pixels[(row - y) * bmp->width + (x0 - x)], n);
+    }
+    else if (entry->format == ASSET_COMPRESSED)
+    {
+        // The stream can only be read from the start, rows above the screen are decoded and
+        // dropped. Rows below it are never decoded
+        Image_Begin(&_decoder, Asset_Data(bmp, sizeof(Asset_Bitmap)));
+        for (int16_t row = y; row <= y1; row++)
+        {
+            uint16_t *line = LCD_DMALine();
+
+            Image_Decode(&_decoder, line, bmp->width);
+            if (row >= y0)
+                LCD_DMAPush(&line[x0 - x], n);
+        }
+    }
+    else
+    {
+        const uint8_t *pixels = Asset_Data(bmp, sizeof(Asset_Bitmap));
+
+        for (int16_t row = y0; row <= y1; row++)
+        {
+            uint16_t *line = LCD_DMALine();
+
+            Pix_Expand16(line, &pixels[(row - y) * bmp->width + (x0 - x)], palette, n);
+            LCD_DMAPush(line, n);
+        }
+    }
+
+    LCD_DMAEnd();
+}
+
+// Use an indexed bitmap as a scanline sprite. The palette has to be set with Scan_SetPalette
+//  Param:
+//      sprite: sprite to set the size and pixels of, position is kept
+//      id: indexed bitmap asset ID
+void Asset_SetSprite(Scan_Sprite *sprite, uint16_t id)
+{
+    const Asset_Entry *entry = Asset_GetEntry(id, ASSET_BITMAP);
+    const Asset_Bitmap *bmp;
+
+    if (!entry || entry->format != ASSET_INDEXED8)
+    {
+        sprite->pixels = NULL;
+        return;
+    }
+
+    bmp = (const Asset_Bitmap *) ((const uint8_t *) Asset_Pack + entry->offset);
+    sprite->w = bmp->width;
+    sprite->h = bmp->height;
+    sprite->pixels = Asset_Data(bmp, sizeof(Asset_Bitmap));
+}
+
+// Use a bitmap as the source of the affine blitter. Indexed bitmaps leave out index 0,
+// compressed ones can not be used
+//  Param:
+//      src: source to set
+//      id: indexed or RGB565 bitmap asset ID
+void Asset_SetAffine(Affine_Source *src, uint16_t id)
+{
+    const Asset_Entry *entry = Asset_GetEntry(id, ASSET_BITMAP);
+    const Asset_Bitmap *bmp;
+
+    src->pixels = NULL;
+    if (!entry || entry->format == ASSET_COMPRESSED)
+        return;
+
+    bmp = (const Asset_Bitmap *) ((const uint8_t *) Asset_Pack + entry->offset);
+    src->palette = NULL;
+    src->flags = 0;
+    if (entry->format == ASSET_INDEXED8)
+    {
+        if (!(src->palette = Asset_GetPalette(bmp->palette)))
+            return;
+        src->flags = AFFINE_KEY;
+    }
+    src->width = bmp->width;
+    src->height = bmp->height;
+    src->pixels = Asset_Data(bmp, sizeof(Asset_Bitmap));
+}
+
+// Use a tilemap as the scanline tilemap layer, along with the palette of its tiles
+//  Param:
+//      id: tilemap asset ID
+void Asset_SetTilemap(uint16_t id)
+{
+    const Asset_Tilemap *map = Asset_Get(id, ASSET_TILEMAP);
+    const Asset_Tiles *tiles = map ? Asset_Get(map->tiles, ASSET_TILES) : NULL;
+
+    if (!tiles)
+    {
+        Scan_SetTilemap(NULL, NULL, 0, 0);
+        return;
+    }
+
+    Scan_SetPalette(Asset_GetPalette(tiles->palette));
+    Scan_SetTilemap(Asset_Data(tiles, sizeof(Asset_Tiles)), Asset_Data(map, sizeof(Asset_Tilemap)),
+                    map->width, map->height);
+}
+
+// Draw a string with a font asset
+// Characters the font does not have are left out
+//  Param:
+//      id: font asset ID
+//      x, y: top left corner
+//      str: string
+//      fg, bg: text and background colors
+//  Return:
+//      width drawn in pixels
+int16_t Asset_String(uint16_t id, int16_t x, int16_t y, const char *str, pixel fg, pixel bg)
+{
+    const Asset_Font *font = Asset_Get(id, ASSET_FONT);
+    const uint8_t *glyphs;
+    const char *c;
+    LCD_Color colors[2] = { LCD_Encode(bg), LCD_Encode(fg) };
+    uint8_t advance, count = 0;
+
+    if (!font || x < 0 || y < 0 || y + font->height > LCD_HEIGHT)
+        return 0;
+    glyphs = Asset_Data(font, sizeof(Asset_Font));
+    advance = font->width + 1;
+
+    // Characters that fit on the screen, each followed by a blank column
+    for (c = str; *c && x + (count + 1) * advance <= LCD_WIDTH; c++)
+        if ((uint8_t) *c >= font->first && (uint8_t) *c - font->first < font->count)
+            count++;
+    if (!count)
+        return 0;
+
+    // The whole string is one window, pixels of the same color in a row are sent as one run
+    LCD_SetArea(x, y, x + count * advance - 1, y + font->height - 1);
+    LCD_ActivateWrite();
+
+    for (uint8_t line = 0; line < font->height; line++)
+    {
+        uint8_t left = count, run = 0, n = 0;
+
+        for (c = str; left; c++)
+        {
+            const uint8_t *glyph;
+
+            if ((uint8_t) *c < font->first || (uint8_t) *c - font->first >= font->count)
+                continue;
+            glyph = &glyphs[((uint8_t) *c - font->first) * font->width];
+            left--;
+
+            for (uint8_t i = 0; i < advance; i++)
+            {
+                uint8_t on = i < font->width && (glyph[i] & (1 << line));
+
+                if (n && on != run)
+                {
+                    LCD_PushColor(colors[run], n);
+                    n = 0;
+                }
+                run = on;
+                n++;
+            }
+        }
+        LCD_PushColor(colors[run], n);
+    }
+
+    return count * advance;
+}
+
+// Play a note sequence asset on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      id: sound asset ID
+//      loop: 1 to start over at the end
+void Asset_Play(uint8_t voice, uint16_t id, uint8_t loop)
+{
+    const Asset_Sound *sound = Asset_Get(id, ASSET_SOUND);
+
+    if (sound)
+        Audio_Play(voice, Asset_Data(sound, sizeof(Asset_Sound)), sound->count, loop);
+}
@@ -0,0 +1,209 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+/*
+    Asset pack. Bitmaps, palettes, tiles, tilemaps, fonts, faces and note sequences are
+    compiled on the host from the files in assets/ (see tools/assetc.c) into one array in
+    flash, and used from there: nothing is unpacked into RAM. Games refer to assets by the
+    ASSET_* IDs in the generated asset_ids.h.
+
+    Layout, little endian, every offset from the start of the pack:
+        Asset_Header
+        Asset_Entry[count]      one per asset, in ID order
+        data                    each asset starts on a 4-byte boundary
+
+    Every asset starts with a small header of its type, followed by its data, which is also
+    4-byte aligned. RGB565 bitmaps are sent straight from flash by uDMA, compressed ones are
+    decoded row by row on the way to it (see image.h), indexed bitmaps and tiles are 8-bit
+    palette indices as used by the scanline compositor, and note sequences are Mixer_Note
+    arrays for Audio_Play.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+#include "scan.h"
+#include "affine.h"
+
+#define ASSET_MAGIC   0x50414754    // "TGAP"
+#define ASSET_VERSION 1
+
+// No asset, e.g. a bitmap without a palette
+#define ASSET_NONE 0xFFFF
+
+// Asset types
+#define ASSET_PALETTE 1
+#define ASSET_BITMAP  2
+#define ASSET_TILES   3
+#define ASSET_TILEMAP 4
+#define ASSET_FONT    5
+#define ASSET_SOUND   6
+#define ASSET_FACE    7             // proportional font at one size, see font.h
+
+// Bitmap formats
+#define ASSET_INDEXED8 0            // palette indices, index 0 is transparent for sprites
+#define ASSET_RGB565   1
+#define ASSET_COMPRESSED 2          // RGB565 compressed as in image.h, up to LCD_WIDTH wide
+
+typedef struct Asset_Header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;                 // number of assets
+} Asset_Header;
+
+typedef struct Asset_Entry
+{
+    uint8_t type;
+    uint8_t format;                 // bitmap format, 0 for other types
+    uint16_t reserved;
+    uint32_t offset;                // from the start of the pack
+    uint32_t size;                  // in bytes, header included
+} Asset_Entry;
+
+// Followed by count RGB565 colors
+typedef struct Asset_Palette
+{
+    uint16_t count;
+    uint16_t reserved;
+} Asset_Palette;
+
+// Followed by width * height pixels, row by row, in the format of its entry
+typedef struct Asset_Bitmap
+{
+    uint16_t width, height;
+    uint16_t palette;               // palette asset of indexed bitmaps, ASSET_NONE otherwise
+    uint16_t reserved;
+} Asset_Bitmap;
+
+// Followed by count 8x8 tiles, 64 palette indices each
+typedef struct Asset_Tiles
+{
+    uint16_t count;
+    uint16_t palette;               // palette asset
+} Asset_Tiles;
+
+// Followed by width * height tile numbers, row by row
+typedef struct Asset_Tilemap
+{
+    uint8_t width, height;
+    uint16_t tiles;                 // tiles asset
+} Asset_Tilemap;
+
+// Followed by count glyphs of width column bytes each, top row in bit 0, like LCD_Font
+typedef struct Asset_Font
+{
+    uint8_t first;                  // first character
+    uint8_t count;
+    uint8_t width, height;          // glyph size, height up to 8
+} Asset_Font;
+
+// Followed by count Asset_Glyph, kerning Asset_Kerning sorted by left then right character,
+// and the glyph rows coded as in font.h
+typedef struct Asset_Face
+{
+    uint8_t first;                  // first character
+    uint8_t count;
+    uint8_t height;                 // glyph height
+    uint8_t spacing;                // blank columns after each glyph
+    uint16_t kerning;               // number of kerning pairs
+    uint16_t reserved;
+} Asset_Face;
+
+typedef struct Asset_Glyph
+{
+    uint16_t offset;                // of the rows, from the end of the kerning pairs
+    uint8_t width;
+    uint8_t reserved;
+} Asset_Glyph;
+
+typedef struct Asset_Kerning
+{
+    uint8_t left, right;            // characters
+    int8_t adjust;                  // added to the spacing, which stays 0 or more
+    uint8_t reserved;
+} Asset_Kerning;
+
+// Followed by count Mixer_Note
+typedef struct Asset_Sound
+{
+    uint16_t count;
+    uint16_t reserved;
+} Asset_Sound;
+
+// The pack, generated from assets/ by the build. Without assets, an empty pack is used
+extern const uint32_t Asset_Pack[];
+
+// Get the number of assets in the pack
+//  Return:
+//      number of assets, 0 if the pack is missing or invalid
+uint16_t Asset_Count(void);
+
+// Get an asset
+//  Param:
+//      id: asset ID
+//      type: expected type, ASSET_*
+//  Return:
+//      header of the asset, NULL if there is no such asset of that type
+const void *Asset_Get(uint16_t id, uint8_t type);
+
+// Get the data following the header of an asset
+//  Param:
+//      header: asset header, from Asset_Get
+//      size: size of the header type, e.g. sizeof(Asset_Bitmap)
+//  Return:
+//      data of the asset
+#define Asset_Data(header, size) ((const void *) ((const uint8_t *) (header) + (size)))
+
+// Get the colors of a palette
+//  Param:
+//      id: palette asset ID
+//  Return:
+//      RGB565 colors, NULL if there is no such palette
+const uint16_t *Asset_GetPalette(uint16_t id);
+
+// Draw a bitmap, clipped to the screen
+// RGB565 bitmaps are sent from flash by uDMA, row by row. Compressed bitmaps are decoded and
+// indexed bitmaps go through their palette one row at a time, index 0 included. Everything is
+// sent in a single window
+//  Param:
+//      id: bitmap asset ID
+//      x, y: top left corner
+void Asset_Blit(uint16_t id, int16_t x, int16_t y);
+
+// Use an indexed bitmap as a scanline sprite. The palette has to be set with Scan_SetPalette
+//  Param:
+//      sprite: sprite to set the size and pixels of, position is kept
+//      id: indexed bitmap asset ID
+void Asset_SetSprite(Scan_Sprite *sprite, uint16_t id);
+
+// Use a bitmap as the source of the affine blitter. Indexed bitmaps leave out index 0,
+// compressed ones can not be used
+//  Param:
+//      src: source to set
+//      id: indexed or RGB565 bitmap asset ID
+void Asset_SetAffine(Affine_Source *src, uint16_t id);
+
+// Use a tilemap as the scanline tilemap layer, along with the palette of its tiles
+//  Param:
+//      id: tilemap asset ID
+void Asset_SetTilemap(uint16_t id);
+
+// Draw a string with a font asset
+// Characters the font does not have are left out
+//  Param:
+//      id: font asset ID
+//      x, y: top left corner
+//      str: string
+//      fg, bg: text and background colors
+//  Return:
+//      width drawn in pixels
+int16_t Asset_String(uint16_t id, int16_t x, int16_t y, const char *str, pixel fg, pixel bg);
+
+// Play a note sequence asset on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      id: sound asset ID
+//      loop: 1 to start over at the end
+void Asset_Play(uint8_t voice, uint16_t id, uint8_t loop);
+
+#endif // ASSET_H
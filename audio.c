@@ -0,0 +1,169 @@
+#include "audio.h"
+#include "systick.h"
+#include "tiva-gc-inc.h"
+#include "inc/tm4c123gh6pm.h"
+
+// PWM period in PWM clock cycles, the sample is the compare value
+#define AUDIO_PWM_LOAD 255
+
+static Mixer _mixer;
+// Sample for the next interrupt, written first thing so the output does not jitter with
+// the time the mixer takes
+static uint8_t _next = 128;
+static volatile uint32_t _cycles = 0, _cyclesMax = 0;
+
+// The audio interrupt is masked while a voice changes, no sample is lost as the timer keeps
+// running and the interrupt is only delayed
+#define AUDIO_LOCK()   (TIMER2_IMR_R = 0)
+#define AUDIO_UNLOCK() (TIMER2_IMR_R = 0x01)
+
+// Set up the PWM output and the sample timer. Must run after the LCD is initialized, as its
+// initialization clears the alternate functions of port F
+void Audio_Init(void)
+{
+    Mixer_Init(&_mixer, AUDIO_RATE);
+
+    // PF2 as M1PWM6
+    SYSCTL_RCGCGPIO_R |= 0x20;
+    while (!(SYSCTL_PRGPIO_R & 0x20));
+    SYSCTL_RCGCPWM_R |= 0x02;               // PWM module 1
+    while (!(SYSCTL_PRPWM_R & 0x02));
+
+    GPIO_PORTF_AFSEL_R |= (1 << 2);
+    GPIO_PORTF_PCTL_R = (GPIO_PORTF_PCTL_R & ~0x00000F00) | 0x00000500;
+    GPIO_PORTF_AMSEL_R &= ~(1 << 2);
+    GPIO_PORTF_DEN_R |= (1 << 2);
+
+    SYSCTL_RCC_R &= ~0x00100000;            // PWM clock is the system clock
+    PWM1_3_CTL_R = 0;                       // Count down, disabled during setup
+    PWM1_3_GENA_R = 0xC8;                   // Low on load, high on compare A going down
+    PWM1_3_LOAD_R = AUDIO_PWM_LOAD;
+    PWM1_3_CMPA_R = 128;
+    PWM1_3_CTL_R = 1;
+    PWM1_ENABLE_R |= (1 << 6);              // M1PWM6
+
+    // Timer 2A, periodic at AUDIO_RATE
+    SYSCTL_RCGCTIMER_R |= 0x04;
+    while (!(SYSCTL_PRTIMER_R & 0x04));
+    TIMER2_CTL_R = 0;
+    TIMER2_CFG_R = 0;                       // 32-bit mode
+    TIMER2_TAMR_R = 0x02;                   // Periodic, counting down
+    TIMER2_TAILR_R = CLOCKS_PER_SEC / AUDIO_RATE - 1;
+    TIMER2_ICR_R = 0x01;
+    TIMER2_IMR_R = 0x01;
+    NVIC_EN0_R = 1 << 23;                   // Timer 2A is interrupt 23
+    TIMER2_CTL_R |= 0x01;
+}
+
+// Set the waveform and volume of a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      wave: waveform
+//      volume: 0 - 255
+void Audio_SetVoice(uint8_t voice, Mixer_Wave wave, uint8_t volume)
+{
+    AUDIO_LOCK();
+    Mixer_SetVoice(&_mixer, voice, wave, volume);
+    AUDIO_UNLOCK();
+}
+
+// Set the envelope of a voice, see Mixer_SetEnvelope
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      attack, decay, release: times in ms
+//      sustain: level held while the note plays, 0 - 255
+void Audio_SetEnvelope(uint8_t voice, uint16_t attack, uint16_t decay, uint8_t sustain, uint16_t release)
+{
+    AUDIO_LOCK();
+    Mixer_SetEnvelope(&_mixer, voice, attack, decay, sustain, release);
+    AUDIO_UNLOCK();
+}
+
+// Set the length of a sequence tick
+//  Param:
+//      bpm: beats per minute
+//      ticksPerBeat: ticks in a beat
+void Audio_SetTempo(uint16_t bpm, uint8_t ticksPerBeat)
+{
+    AUDIO_LOCK();
+    Mixer_SetTempo(&_mixer, bpm, ticksPerBeat);
+    AUDIO_UNLOCK();
+}
+
+// Start a note on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      note: MIDI note number
+void Audio_NoteOn(uint8_t voice, uint8_t note)
+{
+    AUDIO_LOCK();
+    Mixer_NoteOn(&_mixer, voice, note);
+    AUDIO_UNLOCK();
+}
+
+// Release the note of a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+void Audio_NoteOff(uint8_t voice)
+{
+    AUDIO_LOCK();
+    Mixer_NoteOff(&_mixer, voice);
+    AUDIO_UNLOCK();
+}
+
+// Play a sequence of notes on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      seq: notes, must stay valid while they play. NULL stops the sequence
+//      len: number of notes
+//      loop: 1 to start over at the end
+void Audio_Play(uint8_t voice, const Mixer_Note *seq, uint16_t len, uint8_t loop)
+{
+    AUDIO_LOCK();
+    Mixer_Play(&_mixer, voice, seq, len, loop);
+    AUDIO_UNLOCK();
+}
+
+// Silence every voice
+void Audio_Stop(void)
+{
+    AUDIO_LOCK();
+    for (uint8_t i = 0; i < MIXER_VOICES; i++)
+        Mixer_Play(&_mixer, i, NULL, 0, 0);
+    AUDIO_UNLOCK();
+}
+
+// Get how long the last audio interrupt took
+//  Return:
+//      core clock cycles
+uint32_t Audio_Cycles(void)
+{
+    return _cycles;
+}
+
+// Get the longest an audio interrupt took since the last call
+//  Return:
+//      core clock cycles
+uint32_t Audio_CyclesMax(void)
+{
+    uint32_t max = _cyclesMax;
+    _cyclesMax = 0;
+    return max;
+}
+
+// Timer 2A interrupt handler, outputs a sample and makes the next one
+void Audio_TimerISR(void)
+{
+    uint32_t start = DWT_CYCCNT_R;
+
+    TIMER2_ICR_R = 0x01;
+    PWM1_3_CMPA_R = _next;
+
+    _next = Mixer_Next(&_mixer);
+    if (_next >= AUDIO_PWM_LOAD)
+        _next = AUDIO_PWM_LOAD - 1;     // compare A has to be below the load value
+
+    _cycles = DWT_CYCCNT_R - start;
+    if (_cycles > _cyclesMax)
+        _cyclesMax = _cycles;
+}
@@ -0,0 +1,79 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+/*
+    Sound output on the EduMKII buzzer, PF2 on the LaunchPad. The buzzer is driven by PWM
+    at 62.5 kHz, well above what it can play, and the duty cycle is the sample. Timer 2A
+    interrupts at AUDIO_RATE and writes the next sample from the mixer, so game code never
+    waits on sound. The time each interrupt takes is measured with the DWT cycle counter.
+
+    Sounds are started with the functions below, which only pause the audio interrupt for the
+    few instructions it takes to change a voice.
+*/
+
+#include <stdint.h>
+#include "mixer.h"
+
+// Sample rate, 16 MHz / 1024
+#define AUDIO_RATE 15625
+
+// Set up the PWM output and the sample timer. Must run after the LCD is initialized, as its
+// initialization clears the alternate functions of port F
+void Audio_Init(void);
+
+// Set the waveform and volume of a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      wave: waveform
+//      volume: 0 - 255
+void Audio_SetVoice(uint8_t voice, Mixer_Wave wave, uint8_t volume);
+
+// Set the envelope of a voice, see Mixer_SetEnvelope
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      attack, decay, release: times in ms
+//      sustain: level held while the note plays, 0 - 255
+void Audio_SetEnvelope(uint8_t voice, uint16_t attack, uint16_t decay, uint8_t sustain, uint16_t release);
+
+// Set the length of a sequence tick
+//  Param:
+//      bpm: beats per minute
+//      ticksPerBeat: ticks in a beat
+void Audio_SetTempo(uint16_t bpm, uint8_t ticksPerBeat);
+
+// Start a note on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      note: MIDI note number
+void Audio_NoteOn(uint8_t voice, uint8_t note);
+
+// Release the note of a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+void Audio_NoteOff(uint8_t voice);
+
+// Play a sequence of notes on a voice
+//  Param:
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      seq: notes, must stay valid while they play. NULL stops the sequence
+//      len: number of notes
+//      loop: 1 to start over at the end
+void Audio_Play(uint8_t voice, const Mixer_Note *seq, uint16_t len, uint8_t loop);
+
+// Silence every voice
+void Audio_Stop(void);
+
+// Get how long the last audio interrupt took
+//  Return:
+//      core clock cycles
+uint32_t Audio_Cycles(void);
+
+// Get the longest an audio interrupt took since the last call
+//  Return:
+//      core clock cycles
+uint32_t Audio_CyclesMax(void);
+
+// Timer 2A interrupt handler, set in startup_gcc.c
+void Audio_TimerISR(void);
+
+#endif // AUDIO_H
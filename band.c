@@ -0,0 +1,378 @@
+#include "band.h"
+#include "pix.h"
+
+#define BAND_RECT   0
+#define BAND_LINE   1
+#define BAND_CIRCLE 2
+#define BAND_STRING 3
+
+typedef struct Band_Cmd
+{
+    uint8_t type;
+    uint16_t color;
+    int16_t x, y, a, b;         // rectangle: w, h. Line: x2, y2. Circle: r
+    int16_t top, bottom;        // rows touched
+    const char *str;
+} Band_Cmd;
+
+static Band_Cmd _cmds[BAND_CMDS];
+static uint8_t _count = 0, _overflow = 0;
+static uint16_t _bg = 0;
+
+// Each band buffer is rasterized while the other one is being sent
+static uint16_t _bands[2][BAND_LINES * LCD_WIDTH] __attribute__((aligned(4)));
+
+// Hashes of the tiles last sent, and whether they are valid
+static uint32_t _hashes[BAND_COUNT][BAND_TILES];
+static uint8_t _skip = 0, _hashesValid = 0;
+
+static Band_Cmd *Band_Add(uint8_t type, int16_t top, int16_t bottom, pixel color);
+static int32_t Band_Sqrt(int32_t n);
+static void Band_Span(uint16_t *line, int16_t x0, int16_t x1, uint16_t color);
+static void Band_Raster(uint16_t *buf, int16_t top);
+static uint32_t Band_HashTile(const uint16_t *buf, uint8_t tile);
+static uint8_t Band_SendChanged(const uint16_t *buf, uint8_t band);
+
+// Append a command to the display list, NULL if it is full or the command is off screen
+static Band_Cmd *Band_Add(uint8_t type, int16_t top, int16_t bottom, pixel color)
+{
+    Band_Cmd *cmd;
+
+    if (bottom < 0 || top >= LCD_HEIGHT || bottom < top)
+        return NULL;
+    if (_count == BAND_CMDS)
+    {
+        _overflow = 1;
+        return NULL;
+    }
+
+    cmd = &_cmds[_count++];
+    cmd->type = type;
+    cmd->color = LCD_PixelTo565(color);
+    cmd->top = top;
+    cmd->bottom = bottom;
+    return cmd;
+}
+
+// Integer square root, rounded down
+static int32_t Band_Sqrt(int32_t n)
+{
+    int32_t root = 0, bit = 1 << 30;
+
+    if (n <= 0)
+        return 0;
+    while (bit > n)
+        bit >>= 2;
+    while (bit)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Fill columns x0 to x1 of a line, clipped to the screen
+static void Band_Span(uint16_t *line, int16_t x0, int16_t x1, uint16_t color)
+{
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 >= LCD_WIDTH)
+        x1 = LCD_WIDTH - 1;
+    if (x0 <= x1)
+        Pix_Fill16(&line[x0], color, x1 - x0 + 1);
+}
+
+// Draw the commands touching rows top to top + BAND_LINES - 1 into a band buffer
+static void Band_Raster(uint16_t *buf, int16_t top)
+{
+    int16_t bottom = top + BAND_LINES - 1;
+
+    Pix_Fill16(buf, _bg, BAND_LINES * LCD_WIDTH);
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const Band_Cmd *c = &_cmds[i];
+        int16_t y0 = max(top, c->top), y1 = min(bottom, c->bottom);
+
+        if (y0 > y1)
+            continue;
+
+        switch (c->type)
+        {
+        case BAND_RECT:
+            for (int16_t y = y0; y <= y1; y++)
+                Band_Span(&buf[(y - top) * LCD_WIDTH], c->x, c->x + c->a - 1, c->color);
+            break;
+
+        case BAND_LINE:
+        {
+            // Each row gets the span of x the line covers between the row's edges, in 16.16
+            // fixed point. The endpoints are ordered top to bottom when the command is added
+            int16_t xmin = min(c->x, c->a), xmax = max(c->x, c->a);
+            int32_t step, half;
+
+            if (c->y == c->b)
+            {
+                Band_Span(&buf[(c->y - top) * LCD_WIDTH], xmin, xmax, c->color);
+                break;
+            }
+            step = ((int32_t) (c->a - c->x) << 16) / (c->b - c->y);
+            half = abs(step) >> 1;
+
+            for (int16_t y = y0; y <= y1; y++)
+            {
+                int32_t xc = ((int32_t) c->x << 16) + (int32_t) ((int64_t) (y - c->y) * step) + 0x8000;
+                int16_t xa = (xc - half) >> 16, xb = (xc + half - 1) >> 16;
+
+                if (xb < xa)
+                    xa = xb = xc >> 16;
+                Band_Span(&buf[(y - top) * LCD_WIDTH], max(xa, xmin), min(xb, xmax), c->color);
+            }
+            break;
+        }
+
+        case BAND_CIRCLE:
+        {
+            int32_t r2 = (int32_t) c->a * c->a;
+
+            for (int16_t y = y0; y <= y1; y++)
+            {
+                int32_t dy = y - c->y;
+                int16_t half = Band_Sqrt(r2 - dy * dy);
+
+                Band_Span(&buf[(y - top) * LCD_WIDTH], c->x - half, c->x + half, c->color);
+            }
+            break;
+        }
+
+        case BAND_STRING:
+            for (int16_t y = y0; y <= y1; y++)
+            {
+                uint16_t *line = &buf[(y - top) * LCD_WIDTH];
+                uint8_t bit = 1 << (y - c->y);
+                int16_t x = c->x;
+
+                for (const char *s = c->str; *s && x < LCD_WIDTH; s++, x += 6)
+                {
+                    const uint8_t *glyph = &LCD_Font[(uint8_t) *s * 5];
+
+                    for (int16_t col = 0; col < 5; col++)
+                        if ((glyph[col] & bit) && x + col >= 0 && x + col < LCD_WIDTH)
+                            line[x + col] = c->color;
+                }
+            }
+            break;
+        }
+    }
+}
+
+// FNV-1a over the tile's pixels, two at a time
+static uint32_t Band_HashTile(const uint16_t *buf, uint8_t tile)
+{
+    uint32_t hash = 2166136261u;
+
+    for (uint8_t y = 0; y < BAND_LINES; y++)
+    {
+        const Pix_Word *p = (const Pix_Word *) &buf[y * LCD_WIDTH + tile * BAND_TILE_WIDTH];
+
+        for (uint8_t i = 0; i < BAND_TILE_WIDTH / 2; i++)
+            hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Send the tiles of a band that changed, neighbouring ones in a single area
+//  Return:
+//      1 if anything was sent
+static uint8_t Band_SendChanged(const uint16_t *buf, uint8_t band)
+{
+    uint8_t changed = 0, sent = 0;
+    int16_t top = band * BAND_LINES;
+
+    for (uint8_t tile = 0; tile < BAND_TILES; tile++)
+    {
+        uint32_t hash = Band_HashTile(buf, tile);
+
+        if (!_hashesValid || hash != _hashes[band][tile])
+            changed |= 1 << tile;
+        _hashes[band][tile] = hash;
+    }
+
+    for (uint8_t tile = 0; tile < BAND_TILES; )
+    {
+        uint8_t start = tile;
+        int16_t x0, w;
+
+        if (!(changed & (1 << tile)))
+        {
+            tile++;
+            continue;
+        }
+        while (tile < BAND_TILES && (changed & (1 << tile)))
+            tile++;
+
+        // Rows of the run are not next to each other in the buffer, each one is a push
+        x0 = start * BAND_TILE_WIDTH;
+        w = (tile - start) * BAND_TILE_WIDTH;
+        LCD_DMAArea(x0, top, x0 + w - 1, top + BAND_LINES - 1);
+        for (uint8_t y = 0; y < BAND_LINES; y++)
+            LCD_DMAPush(&buf[y * LCD_WIDTH + x0], w);
+        sent = 1;
+    }
+    return sent;
+}
+
+// Start a new display list
+//  Param:
+//      bg: color the screen is cleared to
+void Band_Begin(pixel bg)
+{
+    _count = 0;
+    _overflow = 0;
+    _bg = LCD_PixelTo565(bg);
+}
+
+// Filled rectangle
+//  Param:
+//      x, y: top left corner
+//      w, h: width and height
+//      color: fill color
+void Band_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, pixel color)
+{
+    Band_Cmd *cmd;
+
+    if (w <= 0 || x >= LCD_WIDTH || x + w <= 0)
+        return;
+    cmd = Band_Add(BAND_RECT, y, y + h - 1, color);
+    if (!cmd)
+        return;
+    cmd->x = x;
+    cmd->a = w;
+}
+
+// Rectangle outline, 1 pixel wide
+//  Param:
+//      x, y: top left corner
+//      w, h: width and height
+//      color: line color
+void Band_Rect(int16_t x, int16_t y, int16_t w, int16_t h, pixel color)
+{
+    Band_FillRect(x, y, w, 1, color);
+    Band_FillRect(x, y + h - 1, w, 1, color);
+    Band_FillRect(x, y + 1, 1, h - 2, color);
+    Band_FillRect(x + w - 1, y + 1, 1, h - 2, color);
+}
+
+// Line, 1 pixel wide
+//  Param:
+//      x1, y1: start point
+//      x2, y2: end point
+//      color: line color
+void Band_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, pixel color)
+{
+    Band_Cmd *cmd;
+
+    if (y2 < y1)
+    {
+        int16_t t = x1;
+        x1 = x2;
+        x2 = t;
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+
+    cmd = Band_Add(BAND_LINE, y1, y2, color);
+    if (!cmd)
+        return;
+    cmd->x = x1;
+    cmd->y = y1;
+    cmd->a = x2;
+    cmd->b = y2;
+}
+
+// Filled circle
+//  Param:
+//      x, y: center
+//      r: radius
+//      color: fill color
+void Band_FillCircle(int16_t x, int16_t y, int16_t r, pixel color)
+{
+    Band_Cmd *cmd;
+
+    if (r < 0)
+        return;
+    cmd = Band_Add(BAND_CIRCLE, y - r, y + r, color);
+    if (!cmd)
+        return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->a = r;
+}
+
+// String in the LCD_Font, with no background
+//  Param:
+//      x, y: top left corner of the first character
+//      str: string, must stay valid until Band_End
+//      color: text color
+void Band_String(int16_t x, int16_t y, const char *str, pixel color)
+{
+    Band_Cmd *cmd = Band_Add(BAND_STRING, y, y + 7, color);
+
+    if (!cmd)
+        return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->str = str;
+}
+
+// Turn skipping of unchanged tiles on or off
+//  Param:
+//      flag: 1 or 0, ON or OFF
+void Band_SkipUnchanged(uint8_t flag)
+{
+    _skip = flag;
+    _hashesValid = 0;
+}
+
+// Forget the hashes of the tiles sent, so the next Band_End sends the whole screen
+void Band_Invalidate(void)
+{
+    _hashesValid = 0;
+}
+
+// Rasterize the display list and send it to the whole screen
+//  Return:
+//      1 if every command fit in the display list, 0 if some were left out
+uint8_t Band_End(void)
+{
+    uint8_t sent = 1;
+
+    LCD_DMABegin(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+
+    for (uint8_t band = 0; band < BAND_COUNT; band++)
+    {
+        uint16_t *buf = _bands[band & 1];
+
+        // The last push of the band before this one waited for this buffer to be sent. If that
+        // band was skipped, nothing did
+        if (!sent)
+            LCD_DMAWait();
+        Band_Raster(buf, band * BAND_LINES);
+
+        if (_skip)
+            sent = Band_SendChanged(buf, band);
+        else
+            LCD_DMAPush(buf, BAND_LINES * LCD_WIDTH);
+    }
+
+    LCD_DMAEnd();
+    _hashesValid = _skip;
+    return !_overflow;
+}
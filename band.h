@@ -0,0 +1,88 @@
+#ifndef BAND_H
+#define BAND_H
+
+/*
+    Banded full screen renderer. Drawing functions only record commands in a display list.
+    Band_End then rasterizes the screen one band of lines at a time into RAM, in RGB565, and
+    sends each band with uDMA while the next one is rasterized into the other buffer. The CPU
+    and the SPI link are both busy for the whole frame, so full screen redraws get close to
+    the 8 MHz SPI limit, about 30 frames per second.
+
+    Two bands of 128x16 take 8 KB, a whole frame would not fit in the 32 KB of SRAM. Every
+    command is replayed for each band it touches, so drawing cost grows with the number of
+    commands as well as with the area they cover.
+
+    Strings are kept by pointer and must stay valid until Band_End.
+
+    With Band_SkipUnchanged on, each band is split in tiles of BAND_TILE_WIDTH columns, and a
+    hash of every tile is kept. A tile whose hash matches the one it had when last sent is not
+    sent again, so static parts of the screen cost rasterizing and hashing, but no SPI time.
+    Anything else drawing on the screen has to be followed by Band_Invalidate.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+#define BAND_LINES 16
+#define BAND_COUNT (LCD_HEIGHT / BAND_LINES)
+
+// Most commands in a display list
+#define BAND_CMDS 64
+
+#define BAND_TILE_WIDTH 16
+#define BAND_TILES      (LCD_WIDTH / BAND_TILE_WIDTH)
+
+// Start a new display list
+//  Param:
+//      bg: color the screen is cleared to
+void Band_Begin(pixel bg);
+
+// Filled rectangle
+//  Param:
+//      x, y: top left corner
+//      w, h: width and height
+//      color: fill color
+void Band_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, pixel color);
+
+// Rectangle outline, 1 pixel wide
+//  Param:
+//      x, y: top left corner
+//      w, h: width and height
+//      color: line color
+void Band_Rect(int16_t x, int16_t y, int16_t w, int16_t h, pixel color);
+
+// Line, 1 pixel wide
+//  Param:
+//      x1, y1: start point
+//      x2, y2: end point
+//      color: line color
+void Band_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, pixel color);
+
+// Filled circle
+//  Param:
+//      x, y: center
+//      r: radius
+//      color: fill color
+void Band_FillCircle(int16_t x, int16_t y, int16_t r, pixel color);
+
+// String in the LCD_Font, with no background
+//  Param:
+//      x, y: top left corner of the first character
+//      str: string, must stay valid until Band_End
+//      color: text color
+void Band_String(int16_t x, int16_t y, const char *str, pixel color);
+
+// Turn skipping of unchanged tiles on or off
+//  Param:
+//      flag: 1 or 0, ON or OFF
+void Band_SkipUnchanged(uint8_t flag);
+
+// Forget the hashes of the tiles sent, so the next Band_End sends the whole screen
+void Band_Invalidate(void);
+
+// Rasterize the display list and send it to the whole screen
+//  Return:
+//      1 if every command fit in the display list, 0 if some were left out
+uint8_t Band_End(void);
+
+#endif // BAND_H
@@ -0,0 +1,34 @@
+#include "clock.h"
+#include "inc/tm4c123gh6pm.h"
+
+// Starts Wide Timer 0 as a 64-bit up counter clocked by the core clock
+void Clock_Init(void)
+{
+    SYSCTL_RCGCWTIMER_R |= 0x01;             // Enable Wide Timer 0
+    while (!(SYSCTL_PRWTIMER_R & 0x01));     // Wait for enabled signal
+
+    WTIMER0_CTL_R = 0;                       // Disable timer during setup
+    WTIMER0_CFG_R = 0;                       // 64-bit mode, A and B concatenated
+    WTIMER0_TAMR_R = 0x12;                   // Periodic, counting up
+    WTIMER0_TAILR_R = 0xFFFFFFFF;            // Count up to the full 64 bits
+    WTIMER0_TBILR_R = 0xFFFFFFFF;
+    WTIMER0_IMR_R = 0;                       // No interrupts
+    WTIMER0_CTL_R = 0x01;                    // Start counting
+}
+
+// Reads the counter
+//  Return:
+//      Core clock cycles since Clock_Init
+uint64_t Clock_Get(void)
+{
+    uint32_t hi, lo;
+
+    // Read the high half again if the low half overflowed in between
+    do
+    {
+        hi = WTIMER0_TBV_R;
+        lo = WTIMER0_TAV_R;
+    } while (hi != WTIMER0_TBV_R);
+
+    return ((uint64_t) hi << 32) | lo;
+}
@@ -0,0 +1,19 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+/*
+    Free running 64-bit time base on Wide Timer 0. Counts core clock cycles from Clock_Init,
+    never reloads and is never reset, so any number of users can time things from it.
+*/
+
+#include <stdint.h>
+
+// Starts Wide Timer 0 as a 64-bit up counter clocked by the core clock
+void Clock_Init(void);
+
+// Reads the counter
+//  Return:
+//      Core clock cycles since Clock_Init
+uint64_t Clock_Get(void);
+
+#endif // CLOCK_H
@@ -1,6 +1,12 @@
 #include <stdint.h>
+#include <stdbool.h>
 #include "inc/tm4c123gh6pm.h"
 #include "tiva-gc.h"
+#include "driverlib/sysctl.h"
+#include "task.h"
+#include "asset.h"
+#include "font.h"
+#include "asset_ids.h"
 
 void GEdemoMenu(void)
 {
@@ -28,6 +34,12 @@ void GEdemoMenu(void)
         LCD_GOLD
     };
     static uint8_t color = 0;
+    static uint64_t time = 0;
+
+    // Next color every 250 ms, without holding up input
+    if (GE_ElapsedCycles(time) < CLOCKS_PER_SEC / 4)
+        return;
+    time = GE_NowCycles();
 
     LCD_SetBGColor(colors[color]);
     LCD_gString(0, 0, "Inside menu loop", 0, LCD_GREEN);
@@ -35,7 +47,6 @@ void GEdemoMenu(void)
 
     color++;
     if (color == 21) color = 0;
-    delay(250);
 }
 
 int GEdemo(void)
@@ -147,8 +158,8 @@ int graphicsdemo(void)
     js = Input_ReadJoystick();    // don't need that much precision
     js.x = js.x;
     js.y = js.y;
-    pos.x = (int32_t)(js.x / 4095.0f * LCD_WIDTH);
-    pos.y = LCD_HEIGHT - (int32_t)(js.y / 4095.0f * LCD_HEIGHT);
+    pos.x = js.x * LCD_WIDTH / 4095;
+    pos.y = LCD_HEIGHT - js.y * LCD_HEIGHT / 4095;
     if (pos.x < 2)
         pos.x = 2;
     else if (pos.x >= LCD_WIDTH)
@@ -194,8 +205,8 @@ int graphicsdemo(void)
         js = Input_ReadJoystick();
         js.x = js.x;
         js.y = js.y;
-        pos.x = (int32_t)(js.x / 4095.0f * LCD_WIDTH);
-        pos.y = LCD_HEIGHT - (int32_t)(js.y / 4095.0f * LCD_HEIGHT);
+        pos.x = js.x * LCD_WIDTH / 4095;
+        pos.y = LCD_HEIGHT - js.y * LCD_HEIGHT / 4095;
         if (pos.x < 2)
             pos.x = 2;
         else if (pos.x >= LCD_WIDTH)
@@ -242,3 +253,476 @@ int graphicsdemo(void)
         }
     }
 }
+
+// Write an unsigned number as decimal text, right aligned in width characters
+static void demo_utoa(uint32_t n, char *buf, uint8_t width)
+{
+    buf[width] = '\0';
+    while (width--)
+    {
+        buf[width] = (n || width == 0) ? '0' + n % 10 : ' ';
+        n /= 10;
+    }
+}
+
+// Flash copies of the SRAM kernels LCD_PushColor and LCD_PushPixel, with the same code, kept
+// out of line like RAMFUNC functions so both sides are called the same way
+__attribute__((noinline)) static void bench_write_flash(uint8_t data)
+{
+    SSI2_DR_R = data;
+    while (!(SSI2_SR_R & 0x1));
+}
+
+__attribute__((noinline)) static void bench_pixel_flash(uint8_t red, uint8_t green, uint8_t blue)
+{
+    GPIO_PORTF_DATA_R |= (1 << 4);
+    bench_write_flash(red << 2);
+    GPIO_PORTF_DATA_R |= (1 << 4);
+    bench_write_flash(green << 2);
+    GPIO_PORTF_DATA_R |= (1 << 4);
+    bench_write_flash(blue << 2);
+}
+
+__attribute__((noinline)) static void bench_color_flash(LCD_Color color, uint32_t count)
+{
+    uint8_t r = color, g = color >> 8, b = color >> 16;
+
+    GPIO_PORTF_DATA_R |= (1 << 4);
+    while (count--)
+    {
+        while (!(SSI2_SR_R & 0x2));
+        SSI2_DR_R = r;
+        while (!(SSI2_SR_R & 0x2));
+        SSI2_DR_R = g;
+        while (!(SSI2_SR_R & 0x2));
+        SSI2_DR_R = b;
+    }
+    while (SSI2_SR_R & 0x10);
+}
+
+// Compares LCD_PushColor and LCD_PushPixel running from SRAM with flash copies of them at each
+// clock profile. Results are core clock cycles per pixel over 16 rows, so the difference is
+// the cost of flash wait states and prefetch stalls. The panel is deselected meanwhile, as the
+// SSI clock follows the core clock past what it accepts
+int ramfuncdemo(void)
+{
+    const struct { uint32_t mhz, sysdiv; } profiles[4] = {
+        { 16, SYSCTL_SYSDIV_12_5 },
+        { 40, SYSCTL_SYSDIV_5 },
+        { 50, SYSCTL_SYSDIV_4 },
+        { 80, SYSCTL_SYSDIV_2_5 }
+    };
+    const uint32_t pixels = LCD_WIDTH * 16;
+    LCD_Color red = LCD_Encode(LCD_RED);
+    uint32_t colorCycles[2][4], pixelCycles[2][4];      // [flash, SRAM][profile]
+    uint64_t t;
+    char num[8];
+
+    GE_Setup();
+    LCD_CS(HIGH);
+
+    for (int p = 0; p < 4; p++)
+    {
+        SysCtlClockSet(profiles[p].sysdiv | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
+
+        t = GE_NowCycles();
+        bench_color_flash(red, pixels);
+        colorCycles[0][p] = GE_ElapsedCycles(t) / pixels;
+
+        t = GE_NowCycles();
+        LCD_PushColor(red, pixels);
+        colorCycles[1][p] = GE_ElapsedCycles(t) / pixels;
+
+        t = GE_NowCycles();
+        for (uint32_t i = 0; i < pixels; i++)
+            bench_pixel_flash(0x3F, 0, 0);
+        pixelCycles[0][p] = GE_ElapsedCycles(t) / pixels;
+
+        t = GE_NowCycles();
+        for (uint32_t i = 0; i < pixels; i++)
+            LCD_PushPixel(0x3F, 0, 0);
+        pixelCycles[1][p] = GE_ElapsedCycles(t) / pixels;
+    }
+
+    // Back to the clock everything else assumes before using the LCD again
+    SysCtlClockSet(SYSCTL_SYSDIV_12_5 | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
+    LCD_CS(LOW);
+
+    LCD_gString(0, 0, "Cycles per pixel", 0, LCD_WHITE);
+    LCD_gString(0, 2, "MHz  PushColor", 0, LCD_WHITE);
+    LCD_gString(0, 8, "MHz  PushPixel", 0, LCD_WHITE);
+    LCD_gString(5, 3, "flash SRAM", 0, LCD_WHITE);
+    LCD_gString(5, 9, "flash SRAM", 0, LCD_WHITE);
+    for (int p = 0; p < 4; p++)
+    {
+        demo_utoa(profiles[p].mhz, num, 3);
+        LCD_gString(0, 4 + p, num, 0, LCD_WHITE);
+        LCD_gString(0, 10 + p, num, 0, LCD_WHITE);
+        demo_utoa(colorCycles[0][p], num, 5);
+        LCD_gString(5, 4 + p, num, 0, LCD_YELLOW);
+        demo_utoa(colorCycles[1][p], num, 5);
+        LCD_gString(11, 4 + p, num, 0, LCD_GREEN);
+        demo_utoa(pixelCycles[0][p], num, 5);
+        LCD_gString(5, 10 + p, num, 0, LCD_YELLOW);
+        demo_utoa(pixelCycles[1][p], num, 5);
+        LCD_gString(11, 10 + p, num, 0, LCD_GREEN);
+    }
+
+    while (1);
+}
+
+// Kernel demo: input is sampled by the highest priority task no matter how long drawing takes.
+// Input events go through a queue to the logic task, which wakes the render task with a
+// semaphore. The render task redraws the whole screen every time, which takes far longer
+// than the input period, and still no presses are lost
+static Task demo_input_task, demo_logic_task, demo_render_task;
+static uint32_t demo_input_stack[128] __attribute__((aligned(8)));
+static uint32_t demo_logic_stack[128] __attribute__((aligned(8)));
+static uint32_t demo_render_stack[256] __attribute__((aligned(8)));
+static Task_Queue demo_events;
+static uint8_t demo_events_buf[16];
+static Task_Sem demo_redraw;
+static volatile uint32_t demo_presses = 0;
+static volatile uint8_t demo_color = 0;
+
+// Samples the buttons every 5 ms and sends one event per press
+static void demo_input(void)
+{
+    uint8_t old[3] = {0}, now[3];
+    uint32_t last = Task_Ticks();
+
+    while (1)
+    {
+        now[0] = Input_ReadButtonRaw(BUTTON_EDUMKII_SW1);
+        now[1] = Input_ReadButtonRaw(BUTTON_EDUMKII_SW2);
+        now[2] = Input_ReadButtonRaw(BUTTON_EDUMKII_SEL);
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (now[i] && !old[i])
+                Task_QueueSend(&demo_events, &i, TASK_NO_WAIT);
+            old[i] = now[i];
+        }
+
+        Task_SleepUntil(&last, TASK_TICK_HZ / 200);
+    }
+}
+
+// Counts presses and picks the color, then asks for a redraw
+static void demo_logic(void)
+{
+    uint8_t button;
+
+    while (1)
+    {
+        Task_QueueReceive(&demo_events, &button, TASK_FOREVER);
+        demo_presses++;
+        demo_color = button;
+        Task_SemGive(&demo_redraw);
+    }
+}
+
+// Redraws the screen whenever the logic task asks for it
+static void demo_render(void)
+{
+    const pixel colors[3] = { LCD_RED, LCD_GREEN, LCD_BLUE };
+    char num[8];
+
+    while (1)
+    {
+        Task_SemTake(&demo_redraw, TASK_FOREVER);
+
+        LCD_gFillRect(0, 0, LCD_WIDTH, LCD_HEIGHT, colors[demo_color]);
+        LCD_SetBGColor(colors[demo_color]);
+        demo_utoa(demo_presses, num, 7);
+        LCD_gString(0, 0, "Presses:", 0, LCD_WHITE);
+        LCD_gString(9, 0, num, 0, LCD_WHITE);
+    }
+}
+
+int taskdemo(void)
+{
+    GE_Setup();
+
+    Task_QueueInit(&demo_events, demo_events_buf, 1, sizeof(demo_events_buf));
+    Task_SemInit(&demo_redraw, 1);
+
+    Task_Create(&demo_input_task, demo_input, demo_input_stack, 128, 3);
+    Task_Create(&demo_logic_task, demo_logic, demo_logic_stack, 128, 2);
+    Task_Create(&demo_render_task, demo_render, demo_render_stack, 256, 1);
+
+    Task_Start();
+}
+
+// Band renderer demo: bouncing balls redrawn over the whole screen every frame, with the
+// frame time in ms
+int banddemo(void)
+{
+    const pixel colors[4] = { LCD_RED, LCD_GREEN, LCD_YELLOW, LCD_CYAN };
+    point pos[4] = { {20, 30}, {90, 40}, {50, 90}, {100, 100} };
+    point vel[4] = { {2, 1}, {-1, 2}, {3, -2}, {-2, -3} };
+    char num[8];
+    uint64_t t = 0;
+
+    GE_Setup();
+
+    // Only the tiles the balls and the frame time cross are sent
+    Band_SkipUnchanged(ON);
+
+    while (1)
+    {
+        uint32_t ms = GE_ElapsedCycles(t) / (CLOCKS_PER_SEC / 1000);
+        t = GE_NowCycles();
+
+        for (int i = 0; i < 4; i++)
+        {
+            pos[i].x += vel[i].x;
+            pos[i].y += vel[i].y;
+            if (pos[i].x < 10 || pos[i].x > LCD_WIDTH - 10)
+                vel[i].x = -vel[i].x;
+            if (pos[i].y < 20 || pos[i].y > LCD_HEIGHT - 10)
+                vel[i].y = -vel[i].y;
+        }
+
+        Band_Begin(LCD_DARK_BLUE);
+        for (int x = 0; x < LCD_WIDTH; x += 16)
+            Band_Line(x, 10, LCD_WIDTH - 1 - x, LCD_HEIGHT - 1, LCD_TEAL);
+        for (int i = 0; i < 4; i++)
+            Band_FillCircle(pos[i].x, pos[i].y, 9, colors[i]);
+        Band_FillRect(0, 0, LCD_WIDTH, 9, LCD_BLACK);
+        demo_utoa(ms, num, 3);
+        Band_String(1, 1, "Frame ms:", LCD_WHITE);
+        Band_String(61, 1, num, LCD_YELLOW);
+        Band_End();
+    }
+}
+
+#ifdef GE_LOWRES
+// Low resolution demo: fire effect written straight into the logical buffer, with a custom
+// palette, and a title drawn over it with the usual LCD functions. Needs GE_LOWRES
+int lowresdemo(void)
+{
+    GE_Setup();
+    LowRes_Enable(ON);
+
+    // Black to red to yellow to white, indices 0 - 63 are the fire's heat
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        if (i < 22)
+            LowRes_SetPalette(i, (pixel) { .r = i * 3 });
+        else if (i < 43)
+            LowRes_SetPalette(i, (pixel) { .r = 63, .g = (i - 21) * 3 });
+        else
+            LowRes_SetPalette(i, (pixel) { .r = 63, .g = 63, .b = (i - 42) * 3 });
+    }
+
+    while (1)
+    {
+        // Hot random bottom row, every cell above averages the ones below it and cools down
+        for (uint8_t x = 0; x < LOWRES_WIDTH; x++)
+            LowRes_Buffer[LOWRES_HEIGHT - 1][x] = (GE_Rand() & 1) ? 63 : 20;
+
+        for (uint8_t y = 0; y < LOWRES_HEIGHT - 1; y++)
+            for (uint8_t x = 0; x < LOWRES_WIDTH; x++)
+            {
+                uint8_t l = x ? x - 1 : x, r = (x < LOWRES_WIDTH - 1) ? x + 1 : x;
+                uint16_t sum = LowRes_Buffer[y + 1][l] + LowRes_Buffer[y + 1][x] + LowRes_Buffer[y + 1][r]
+                             + LowRes_Buffer[min(y + 2, LOWRES_HEIGHT - 1)][x];
+
+                // The title's pixels are not heat, hence the limit
+                LowRes_Buffer[y][x] = (sum > 4) ? min((sum - 4) >> 2, 63) : 0;
+            }
+
+        // White is outside the fire's part of the palette, so it keeps its default color
+        LCD_gString(2, 0, "FIRE", 0, LCD_WHITE);
+        LowRes_Present();
+    }
+}
+#endif
+
+// Scanline compositor demo: a scrolling tilemap with bouncing balls and a HUD over it, all
+// made line by line with no framebuffer
+int scandemo(void)
+{
+    // Dark blue, teal, grey, white, red, yellow
+    static const uint16_t palette[6] = { 0x0008, 0x0210, 0x4208, 0xFFFF, 0xF800, 0xFFE0 };
+    static uint8_t tiles[2 * 64], map[16 * 16], ball[8 * 8];
+    static Scan_Sprite balls[24];
+    static point vel[24];
+    static Text_Layer hud;
+    uint64_t t = 0;
+    int16_t scroll = 0;
+
+    GE_Setup();
+
+    // Plain tile and a tile with a grey border, the map is a checkerboard of them
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        uint8_t x = i % 8, y = i / 8;
+        tiles[i] = 1;
+        tiles[64 + i] = (x == 0 || y == 0 || x == 7 || y == 7) ? 2 : 0;
+        ball[i] = ((2 * x - 7) * (2 * x - 7) + (2 * y - 7) * (2 * y - 7) < 56) ? ((x + y < 5) ? 5 : 4) : 0;
+    }
+    for (uint16_t i = 0; i < 16 * 16; i++)
+        map[i] = ((i / 16) + i) & 1;
+
+    for (uint8_t i = 0; i < 24; i++)
+    {
+        balls[i] = (Scan_Sprite) { .x = GE_RandRange(LCD_WIDTH - 8), .y = 10 + GE_RandRange(LCD_HEIGHT - 18),
+                                   .w = 8, .h = 8, .pixels = ball };
+        vel[i] = (point) { .x = (int32_t) GE_RandRange(5) - 2, .y = (int32_t) GE_RandRange(5) - 2 };
+        if (!vel[i].x)
+            vel[i].x = 1;
+    }
+
+    Text_Init(&hud, LCD_WHITE, LCD_BLACK);
+    Scan_SetPalette(palette);
+    Scan_SetTilemap(tiles, map, 16, 16);
+    Scan_SetSprites(balls, 24);
+    Scan_SetHUD(&hud, 1);
+
+    while (1)
+    {
+        uint32_t ms = GE_ElapsedCycles(t) / (CLOCKS_PER_SEC / 1000);
+        t = GE_NowCycles();
+
+        for (uint8_t i = 0; i < 24; i++)
+        {
+            balls[i].x += vel[i].x;
+            balls[i].y += vel[i].y;
+            if (balls[i].x < 0 || balls[i].x > LCD_WIDTH - 8)
+                vel[i].x = -vel[i].x;
+            if (balls[i].y < 0 || balls[i].y > LCD_HEIGHT - 8)
+                vel[i].y = -vel[i].y;
+        }
+
+        Text_Goto(&hud, 0, 0);
+        Text_Print(&hud, "Frame ms: %3u", ms);
+        Scan_Scroll(scroll, scroll >> 1);
+        scroll++;
+        Scan_Draw();
+    }
+}
+
+// Asset pack demo: a logo and a font drawn straight from flash, then a tilemap and sprites
+// from the pack scrolling under the scanline compositor, with a sound from it on bounces
+int assetdemo(void)
+{
+    static Scan_Sprite balls[8];
+    static point vel[8];
+    uint64_t t;
+    int16_t scroll = 0;
+
+    GE_Setup();
+
+    Asset_Blit(ASSET_SPLASH, 0, 0);
+    t = GE_NowCycles();
+    while (GE_ElapsedCycles(t) < 2 * (uint64_t) CLOCKS_PER_SEC);
+
+    LCD_gClear();
+    Asset_Blit(ASSET_LOGO, 32, 48);
+    Asset_String(ASSET_DIGITS, 45, 70, "0123456789", LCD_WHITE, LCD_BLACK);
+    t = GE_NowCycles();
+    while (GE_ElapsedCycles(t) < 2 * (uint64_t) CLOCKS_PER_SEC);
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        Asset_SetSprite(&balls[i], ASSET_BALL);
+        balls[i].x = GE_RandRange(LCD_WIDTH - 8);
+        balls[i].y = GE_RandRange(LCD_HEIGHT - 8);
+        vel[i] = (point) { .x = (GE_Rand() & 1) ? 1 : -1, .y = (GE_Rand() & 1) ? 2 : -2 };
+    }
+
+    // The tilemap brings the palette of its tiles, which the ball uses too
+    Asset_SetTilemap(ASSET_LEVEL);
+    Scan_SetSprites(balls, 8);
+
+    while (1)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            balls[i].x += vel[i].x;
+            balls[i].y += vel[i].y;
+            if (balls[i].x < 0 || balls[i].x > LCD_WIDTH - 8)
+                vel[i].x = -vel[i].x;
+            if (balls[i].y < 0 || balls[i].y > LCD_HEIGHT - 8)
+            {
+                vel[i].y = -vel[i].y;
+                Asset_Play(0, ASSET_BOUNCE, 0);
+            }
+        }
+
+        Scan_Scroll(scroll, 0);
+        scroll++;
+        Scan_Draw();
+    }
+}
+
+// Face demo: a centered title, a big score counting up and how long drawing it takes, all
+// drawn as single windows of color runs
+int fontdemo(void)
+{
+    static const char *title = "Tiva GC";
+    char score[6] = "00000", num[8];
+    uint32_t n = 0;
+    uint64_t t;
+
+    GE_Setup();
+
+    Font_String(ASSET_TITLE, (LCD_WIDTH - Font_Measure(ASSET_TITLE, title)) / 2, 4, title,
+                LCD_YELLOW, LCD_BLACK);
+    Font_String(ASSET_TEXT, 2, 24, "Score", LCD_WHITE, LCD_BLACK);
+
+    while (1)
+    {
+        for (uint32_t i = 0, v = n; i < 5; i++, v /= 10)
+            score[4 - i] = '0' + v % 10;
+
+        t = GE_NowCycles();
+        Font_String(ASSET_SCORE, (LCD_WIDTH - Font_Measure(ASSET_SCORE, score)) / 2, 40, score,
+                    LCD_WHITE, LCD_DARK_BLUE);
+        demo_utoa(GE_ElapsedCycles(t), num, 7);
+
+        Font_String(ASSET_TEXT, 2, 100, "Cycles to draw it:", LCD_WHITE, LCD_BLACK);
+        Font_String(ASSET_TEXT, 2, 110, num, LCD_GREEN, LCD_BLACK);
+        n++;
+    }
+}
+
+// Affine blitter demo: a rotozoomer on the top half and a mode 7 floor on the bottom half,
+// both from the logo tiled over the plane
+int affinedemo(void)
+{
+    static Affine_Line plane[LCD_HEIGHT / 2];
+    Affine_Source logo;
+    Affine_Matrix m;
+    uint16_t angle = 0;
+    qpoint cam = { 0, 0 };
+
+    GE_Setup();
+    Asset_SetAffine(&logo, ASSET_LOGO);
+    logo.flags = AFFINE_WRAP;
+
+    while (1)
+    {
+        // Zoom goes from 1/4 to 7/4 and back
+        Affine_RotoZoom(&m, angle, FIX_ONE + Fix_Sin(angle * 2) * 3 / 4, LCD_WIDTH / 2, LCD_HEIGHT / 4, 0, 0);
+        Affine_Blit(&logo, &m, 0, 0, LCD_WIDTH - 1, LCD_HEIGHT / 2 - 1);
+
+        // Floor rows further away cover more of the plane, the camera turns with the angle
+        for (int16_t row = 0; row < LCD_HEIGHT / 2; row++)
+        {
+            q16 z = FIX_INT(16) / (row + 1);            // distance over focal length
+            qpoint ahead = Fix_VecScale((qpoint) { Fix_Cos(angle), Fix_Sin(angle) }, z * (LCD_WIDTH / 2));
+            qpoint step = Fix_VecScale((qpoint) { -Fix_Sin(angle), Fix_Cos(angle) }, z);
+
+            plane[row] = (Affine_Line) {
+                cam.x + ahead.x - step.x * (LCD_WIDTH / 2), cam.y + ahead.y - step.y * (LCD_WIDTH / 2),
+                step.x, step.y
+            };
+        }
+        Affine_BlitLines(&logo, plane, 0, LCD_HEIGHT / 2, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+
+        cam = Fix_VecAdd(cam, (qpoint) { Fix_Cos(angle), Fix_Sin(angle) });
+        angle += FIX_TURN / 256;
+    }
+}
@@ -4,5 +4,15 @@
 int GEdemo(void);
 int textdemo(void);
 int graphicsdemo(void);
+int ramfuncdemo(void);
+int taskdemo(void);
+int banddemo(void);
+#ifdef GE_LOWRES
+int lowresdemo(void);
+#endif
+int scandemo(void);
+int assetdemo(void);
+int fontdemo(void);
+int affinedemo(void);
 
 #endif // DEMO_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "dma.h"
+#include "inc/tm4c123gh6pm.h"
+
+// Primary control structures of the 32 channels: source end, destination end, control,
+// unused. The table base must be aligned to 1024 bytes
+static volatile uint32_t _table[32 * 4] __attribute__((aligned(1024)));
+
+static void DMA_Start(uint8_t channel, uint32_t srcEnd, volatile uint32_t *dst, uint32_t control);
+
+// Fill in the primary control structure of a channel and enable it
+//  Param:
+//      srcEnd: address of the last source item
+//      control: item sizes and increments, the arbitration size and mode are added here
+static void DMA_Start(uint8_t channel, uint32_t srcEnd, volatile uint32_t *dst, uint32_t control)
+{
+    volatile uint32_t *entry = &_table[channel * 4];
+    uint32_t bit = 1u << channel;
+
+    UDMA_ALTCLR_R = bit;                    // Primary control structure
+    UDMA_USEBURSTCLR_R = bit;               // Single and burst requests
+    UDMA_REQMASKCLR_R = bit;
+
+    entry[0] = srcEnd;
+    entry[1] = (uint32_t) dst;
+    entry[2] = control
+             | (2u << 14)                   // Arbitrate every 4 items
+             | 0x01;                        // Basic mode
+
+    UDMA_ENASET_R = bit;
+}
+
+// Enable the uDMA controller and set up its control table. Can be called more than once
+void DMA_Init(void)
+{
+    if (SYSCTL_RCGCDMA_R & 0x01)
+        return;
+
+    SYSCTL_RCGCDMA_R |= 0x01;
+    while (!(SYSCTL_PRDMA_R & 0x01));
+
+    UDMA_CFG_R = 0x01;                      // Master enable
+    UDMA_CTLBASE_R = (uint32_t) _table;
+}
+
+// Assign a channel to one of its peripherals
+//  Param:
+//      channel: uDMA channel
+//      encoding: peripheral encoding of the channel (0 - 4)
+void DMA_Assign(uint8_t channel, uint8_t encoding)
+{
+    volatile uint32_t *map = &UDMA_CHMAP0_R + channel / 8;
+    uint8_t shift = (channel % 8) * 4;
+
+    *map = (*map & ~(0x0Fu << shift)) | ((uint32_t) encoding << shift);
+}
+
+// Send bytes to a peripheral data register
+// The transfer is paced by the peripheral's requests, and its completion interrupt is
+// raised on the peripheral's vector
+//  Param:
+//      channel: uDMA channel, must be assigned to the peripheral
+//      src: bytes to send, must stay valid until the transfer ends
+//      dst: peripheral data register
+//      count: number of bytes (1 - DMA_MAX_ITEMS)
+void DMA_SendBytes(uint8_t channel, const uint8_t *src, volatile uint32_t *dst, uint16_t count)
+{
+    DMA_Start(channel, (uint32_t) (src + count - 1), dst,
+              (3u << 30)                    // Destination does not increment
+            | (0u << 28) | (0u << 24)       // Byte items
+            | (0u << 26)                    // Source increments by a byte
+            | ((uint32_t) (count - 1) << 4));
+}
+
+// Send 16-bit items to a peripheral data register, see DMA_SendBytes
+//  Param:
+//      channel: uDMA channel, must be assigned to the peripheral
+//      src: items to send, must stay valid until the transfer ends
+//      dst: peripheral data register
+//      count: number of items (1 - DMA_MAX_ITEMS)
+void DMA_SendHalfwords(uint8_t channel, const uint16_t *src, volatile uint32_t *dst, uint16_t count)
+{
+    DMA_Start(channel, (uint32_t) (src + count - 1), dst,
+              (3u << 30)                    // Destination does not increment
+            | (1u << 28) | (1u << 24)       // Halfword items
+            | (1u << 26)                    // Source increments by a halfword
+            | ((uint32_t) (count - 1) << 4));
+}
+
+// Check if a channel is still transferring
+//  Param:
+//      channel: uDMA channel
+//  Return:
+//      1 if busy, 0 if done
+uint8_t DMA_Busy(uint8_t channel)
+{
+    return (UDMA_ENASET_R >> channel) & 1;
+}
@@ -0,0 +1,52 @@
+#ifndef DMA_H
+#define DMA_H
+
+/*
+    Minimal uDMA driver, shared by the modules that stream bytes to a peripheral. Only basic
+    mode transfers on the primary control structures are used.
+*/
+
+#include <stdint.h>
+
+// Channels used in the project
+#define DMA_CH_UART0_TX 9       // encoding 0, the default
+#define DMA_CH_SSI2_TX  13      // encoding 2
+
+// Most items a single transfer can move
+#define DMA_MAX_ITEMS 1024
+
+// Enable the uDMA controller and set up its control table. Can be called more than once
+void DMA_Init(void);
+
+// Assign a channel to one of its peripherals
+//  Param:
+//      channel: uDMA channel
+//      encoding: peripheral encoding of the channel (0 - 4)
+void DMA_Assign(uint8_t channel, uint8_t encoding);
+
+// Send bytes to a peripheral data register
+// The transfer is paced by the peripheral's requests, and its completion interrupt is
+// raised on the peripheral's vector
+//  Param:
+//      channel: uDMA channel, must be assigned to the peripheral
+//      src: bytes to send, must stay valid until the transfer ends
+//      dst: peripheral data register
+//      count: number of bytes (1 - DMA_MAX_ITEMS)
+void DMA_SendBytes(uint8_t channel, const uint8_t *src, volatile uint32_t *dst, uint16_t count);
+
+// Send 16-bit items to a peripheral data register, see DMA_SendBytes
+//  Param:
+//      channel: uDMA channel, must be assigned to the peripheral
+//      src: items to send, must stay valid until the transfer ends
+//      dst: peripheral data register
+//      count: number of items (1 - DMA_MAX_ITEMS)
+void DMA_SendHalfwords(uint8_t channel, const uint16_t *src, volatile uint32_t *dst, uint16_t count);
+
+// Check if a channel is still transferring
+//  Param:
+//      channel: uDMA channel
+//  Return:
+//      1 if busy, 0 if done
+uint8_t DMA_Busy(uint8_t channel);
+
+#endif // DMA_H
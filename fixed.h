@@ -0,0 +1,255 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+/*
+    Fixed point math, for graphics code that has to give the same pixels on the board and on
+    the host, and for interrupt handlers that should not make the FPU stack its registers.
+
+    q16 numbers have 16 bits of integer and 16 of fraction, q8 numbers 8 and 8. Rounding is
+    the same everywhere:
+        Fix_Mul, Fix_Div and the q8 versions round to the nearest value, halves away from zero,
+        so negating an operand negates the result
+        Fix_Round rounds to the nearest integer, halves up, the pixel center convention
+        Fix_Sqrt and Fix_ISqrt round down
+
+    Angles are 16 bits, FIX_TURN a full turn, so they wrap around on their own. They go from
+    the x axis towards the y axis, clockwise on the screen. Sines and arctangents come from
+    tables in flash, with linear interpolation between entries.
+*/
+
+#include <stdint.h>
+#include "tiva-gc-inc.h"
+
+#define FIX_ONE  65536
+#define FIX_HALF 32768
+#define FIX8_ONE 256
+
+// Angle of a full turn, angles are uint16_t so this is 0 once stored
+#define FIX_TURN 65536L
+
+// Integer to q16 and q8
+#define FIX_INT(i)  ((q16) (i) * FIX_ONE)
+#define FIX8_INT(i) ((q8) ((i) * FIX8_ONE))
+
+// Ratio of two integers as q16, e.g. FIX_RATIO(1, 3), for constants
+#define FIX_RATIO(a, b) ((q16) (((int64_t) (a) * FIX_ONE + (b) / 2) / (b)))
+
+// Round to the nearest integer, halves up
+//  Param:
+//      x: value
+//  Return:
+//      integer
+static inline int32_t Fix_Round(q16 x)
+{
+    return (x + FIX_HALF) >> 16;
+}
+
+// Round down to an integer
+//  Param:
+//      x: value
+//  Return:
+//      integer
+static inline int32_t Fix_Floor(q16 x)
+{
+    return x >> 16;
+}
+
+// Round up to an integer
+//  Param:
+//      x: value
+//  Return:
+//      integer
+static inline int32_t Fix_Ceil(q16 x)
+{
+    return (x + FIX_ONE - 1) >> 16;
+}
+
+// Multiply
+//  Param:
+//      a, b: factors
+//  Return:
+//      product, rounded
+static inline q16 Fix_Mul(q16 a, q16 b)
+{
+    int64_t p = (int64_t) a * b;
+
+    return (p < 0) ? -((-p + FIX_HALF) >> 16) : (p + FIX_HALF) >> 16;
+}
+
+// Divide
+//  Param:
+//      a: dividend
+//      b: divisor, not 0
+//  Return:
+//      quotient, rounded
+static inline q16 Fix_Div(q16 a, q16 b)
+{
+    int64_t n = (int64_t) a * FIX_ONE, half = ((b < 0) ? -(int64_t) b : b) / 2;
+
+    return ((n < 0) ? n - half : n + half) / b;
+}
+
+// Get the reciprocal
+//  Param:
+//      x: value, not 0
+//  Return:
+//      1 / x, rounded
+static inline q16 Fix_Recip(q16 x)
+{
+    return Fix_Div(FIX_ONE, x);
+}
+
+// Interpolate between two values
+//  Param:
+//      a, b: values at t = 0 and t = FIX_ONE
+//      t: position, can be outside 0 - FIX_ONE to extrapolate
+//  Return:
+//      a + (b - a) * t
+static inline q16 Fix_Lerp(q16 a, q16 b, q16 t)
+{
+    return a + Fix_Mul(b - a, t);
+}
+
+// Multiply q8 numbers
+//  Param:
+//      a, b: factors
+//  Return:
+//      product, rounded
+static inline q8 Fix_Mul8(q8 a, q8 b)
+{
+    int32_t p = (int32_t) a * b;
+
+    return (p < 0) ? -((-p + FIX8_ONE / 2) >> 8) : (p + FIX8_ONE / 2) >> 8;
+}
+
+// Divide q8 numbers
+//  Param:
+//      a: dividend
+//      b: divisor, not 0
+//  Return:
+//      quotient, rounded
+static inline q8 Fix_Div8(q8 a, q8 b)
+{
+    int32_t n = (int32_t) a * FIX8_ONE, half = ((b < 0) ? -b : b) / 2;
+
+    return ((n < 0) ? n - half : n + half) / b;
+}
+
+// Convert q8 to q16, exactly
+//  Param:
+//      x: q8 value
+//  Return:
+//      q16 value
+static inline q16 Fix_From8(q8 x)
+{
+    return (q16) x * FIX8_ONE;
+}
+
+// Convert q16 to q8, rounded halves up like Fix_Round. The integer part has to fit in 8 bits
+//  Param:
+//      x: q16 value
+//  Return:
+//      q8 value
+static inline q8 Fix_To8(q16 x)
+{
+    return (x + FIX8_ONE / 2) >> 8;
+}
+
+// Get the sine of an angle
+//  Param:
+//      angle: FIX_TURN is a full turn
+//  Return:
+//      sine
+q16 Fix_Sin(uint16_t angle);
+
+// Get the cosine of an angle
+//  Param:
+//      angle: FIX_TURN is a full turn
+//  Return:
+//      cosine
+q16 Fix_Cos(uint16_t angle);
+
+// Get the angle of a direction
+//  Param:
+//      y, x: direction, in any unit as long as both are the same
+//  Return:
+//      angle, FIX_TURN is a full turn. 0 for 0, 0
+uint16_t Fix_Atan2(int32_t y, int32_t x);
+
+// Square root of an integer
+//  Param:
+//      n: value
+//  Return:
+//      square root, rounded down
+uint16_t Fix_ISqrt(uint32_t n);
+
+// Square root
+//  Param:
+//      x: value, 0 or more
+//  Return:
+//      square root, rounded down
+q16 Fix_Sqrt(q16 x);
+
+// Vectors
+static inline qpoint Fix_VecAdd(qpoint a, qpoint b)
+{
+    return (qpoint) { a.x + b.x, a.y + b.y };
+}
+
+static inline qpoint Fix_VecSub(qpoint a, qpoint b)
+{
+    return (qpoint) { a.x - b.x, a.y - b.y };
+}
+
+static inline qpoint Fix_VecScale(qpoint v, q16 s)
+{
+    return (qpoint) { Fix_Mul(v.x, s), Fix_Mul(v.y, s) };
+}
+
+static inline qpoint Fix_VecLerp(qpoint a, qpoint b, q16 t)
+{
+    return (qpoint) { Fix_Lerp(a.x, b.x, t), Fix_Lerp(a.y, b.y, t) };
+}
+
+// Dot product, rounded once
+static inline q16 Fix_VecDot(qpoint a, qpoint b)
+{
+    int64_t p = (int64_t) a.x * b.x + (int64_t) a.y * b.y;
+
+    return (p < 0) ? -((-p + FIX_HALF) >> 16) : (p + FIX_HALF) >> 16;
+}
+
+// Nearest pixel of a position
+static inline point Fix_VecRound(qpoint v)
+{
+    return (point) { Fix_Round(v.x), Fix_Round(v.y) };
+}
+
+static inline qpoint Fix_VecFromPoint(point p)
+{
+    return (qpoint) { FIX_INT(p.x), FIX_INT(p.y) };
+}
+
+// Get the length of a vector
+//  Param:
+//      v: vector
+//  Return:
+//      length, rounded down
+q16 Fix_VecLength(qpoint v);
+
+// Make a vector one unit long
+//  Param:
+//      v: vector
+//  Return:
+//      vector of length FIX_ONE in the same direction, 0, 0 for 0, 0
+qpoint Fix_VecNormalize(qpoint v);
+
+// Rotate a vector
+//  Param:
+//      v: vector
+//      angle: FIX_TURN is a full turn
+//  Return:
+//      rotated vector
+qpoint Fix_VecRotate(qpoint v, uint16_t angle);
+
+#endif // FIXED_H
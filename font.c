@@ -0,0 +1,232 @@
+#include "font.h"
+#include "asset.h"
+
+// Rows of a character being drawn
+typedef struct Font_Cursor
+{
+    const uint8_t *row;         // current row
+    const uint8_t *next;        // next row, or the repeat marker of the current one
+    uint8_t width;
+    uint8_t gap;                // blank columns before the character
+} Font_Cursor;
+
+static Font_Cursor _cursors[FONT_MAX_CHARS];
+
+// Run of one color waiting to be sent
+static LCD_Color _runColor;
+static uint32_t _run;
+
+static const Asset_Glyph *Font_Glyph(const Asset_Face *face, char c);
+static int8_t Font_Kern(const Asset_Face *face, char left, char right);
+static void Font_Emit(LCD_Color color, uint32_t n);
+
+// Glyph of a character, NULL if the face does not have it
+static const Asset_Glyph *Font_Glyph(const Asset_Face *face, char c)
+{
+    const Asset_Glyph *glyphs = Asset_Data(face, sizeof(Asset_Face));
+
+    if ((uint8_t) c < face->first || (uint8_t) c - face->first >= face->count)
+        return NULL;
+    return &glyphs[(uint8_t) c - face->first];
+}
+
+// Kerning of a pair of characters, by binary search of the sorted pairs
+static int8_t Font_Kern(const Asset_Face *face, char left, char right)
+{
+    const Asset_Kerning *pairs = Asset_Data(face, sizeof(Asset_Face) + face->count * sizeof(Asset_Glyph));
+    uint16_t key = ((uint8_t) left << 8) | (uint8_t) right;
+    int16_t lo = 0, hi = face->kerning - 1;
+
+    while (lo <= hi)
+    {
+        int16_t mid = (lo + hi) / 2;
+        uint16_t k = (pairs[mid].left << 8) | pairs[mid].right;
+
+        if (k == key)
+            return pairs[mid].adjust;
+        if (k < key)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return 0;
+}
+
+// Add pixels to the run, sending it first if they are of another color. Runs go on from one
+// character and one row to the next, as the whole string is one window
+static void Font_Emit(LCD_Color color, uint32_t n)
+{
+    if (!n)
+        return;
+    if (color != _runColor && _run)
+    {
+        LCD_PushColor(_runColor, _run);
+        _run = 0;
+    }
+    _runColor = color;
+    _run += n;
+}
+
+// Get the height of a face
+//  Param:
+//      id: face asset ID
+//  Return:
+//      height in pixels, 0 if there is no such face
+uint8_t Font_Height(uint16_t id)
+{
+    const Asset_Face *face = Asset_Get(id, ASSET_FACE);
+
+    return face ? face->height : 0;
+}
+
+// Get the change to the space between two characters
+//  Param:
+//      id: face asset ID
+//      left, right: characters, in that order
+//  Return:
+//      columns added to the spacing of the face, negative to bring the characters closer
+int8_t Font_Kerning(uint16_t id, char left, char right)
+{
+    const Asset_Face *face = Asset_Get(id, ASSET_FACE);
+
+    return face ? Font_Kern(face, left, right) : 0;
+}
+
+// Get the width of a string, as Font_String would draw it without the edge of the screen
+// Characters the face does not have are left out
+//  Param:
+//      id: face asset ID
+//      str: string
+//  Return:
+//      width in pixels
+int16_t Font_Measure(uint16_t id, const char *str)
+{
+    const Asset_Face *face = Asset_Get(id, ASSET_FACE);
+    const Asset_Glyph *glyph;
+    int16_t width = 0;
+    char prev = 0;
+
+    if (!face)
+        return 0;
+
+    for (; *str; str++)
+    {
+        if (!(glyph = Font_Glyph(face, *str)))
+            continue;
+        if (prev)
+            width += face->spacing + Font_Kern(face, prev, *str);
+        width += glyph->width;
+        prev = *str;
+    }
+    return width;
+}
+
+// Get how many characters of a string fit in a width, e.g. to break lines
+//  Param:
+//      id: face asset ID
+//      str: string
+//      width: width in pixels
+//  Return:
+//      number of characters of str, those the face does not have included
+uint16_t Font_Fit(uint16_t id, const char *str, int16_t width)
+{
+    const Asset_Face *face = Asset_Get(id, ASSET_FACE);
+    const Asset_Glyph *glyph;
+    const char *c;
+    int16_t used = 0;
+    char prev = 0;
+
+    if (!face)
+        return 0;
+
+    for (c = str; *c; c++)
+    {
+        int16_t w;
+
+        if (!(glyph = Font_Glyph(face, *c)))
+            continue;
+        w = glyph->width + (prev ? face->spacing + Font_Kern(face, prev, *c) : 0);
+        if (used + w > width)
+            break;
+        used += w;
+        prev = *c;
+    }
+    return c - str;
+}
+
+// Draw a string
+// Characters the face does not have are left out, and so are those past the right edge of
+// the screen or past FONT_MAX_CHARS
+//  Param:
+//      id: face asset ID
+//      x, y: top left corner
+//      str: string
+//      fg, bg: text and background colors
+//  Return:
+//      width drawn in pixels
+int16_t Font_String(uint16_t id, int16_t x, int16_t y, const char *str, pixel fg, pixel bg)
+{
+    const Asset_Face *face = Asset_Get(id, ASSET_FACE);
+    const uint8_t *rows;
+    LCD_Color colors[2] = { LCD_Encode(bg), LCD_Encode(fg) };
+    int16_t width = 0;
+    uint8_t count = 0;
+    char prev = 0;
+
+    if (!face || x < 0 || y < 0 || y + face->height > LCD_HEIGHT)
+        return 0;
+    rows = Asset_Data(face, sizeof(Asset_Face) + face->count * sizeof(Asset_Glyph) +
+                            face->kerning * sizeof(Asset_Kerning));
+
+    // Characters that fit on the screen
+    for (; *str && count < FONT_MAX_CHARS; str++)
+    {
+        const Asset_Glyph *glyph = Font_Glyph(face, *str);
+        Font_Cursor *cur = &_cursors[count];
+
+        if (!glyph)
+            continue;
+        cur->gap = prev ? face->spacing + Font_Kern(face, prev, *str) : 0;
+        if (x + width + cur->gap + glyph->width > LCD_WIDTH)
+            break;
+        cur->width = glyph->width;
+        cur->row = cur->next = &rows[glyph->offset];
+        width += cur->gap + glyph->width;
+        prev = *str;
+        count++;
+    }
+    if (!count)
+        return 0;
+
+    LCD_SetArea(x, y, x + width - 1, y + face->height - 1);
+    LCD_ActivateWrite();
+    _run = 0;
+
+    for (uint8_t line = 0; line < face->height; line++)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            Font_Cursor *cur = &_cursors[i];
+            const uint8_t *p;
+            uint8_t left = cur->width;
+
+            if (*cur->next)
+                cur->row = cur->next;
+            else
+                cur->next++;    // the row above repeats
+
+            Font_Emit(colors[0], cur->gap);
+            for (p = cur->row; left; p++)
+            {
+                Font_Emit(colors[0], *p >> 4);
+                Font_Emit(colors[1], *p & 0x0F);
+                left -= (*p >> 4) + (*p & 0x0F);
+            }
+            if (cur->row == cur->next)
+                cur->next = p;
+        }
+    }
+    LCD_PushColor(_runColor, _run);
+
+    return width;
+}
@@ -0,0 +1,72 @@
+#ifndef FONT_H
+#define FONT_H
+
+/*
+    Proportional text with face assets. A face is one size of a font: its glyphs are
+    rasterized at that size by the asset compiler, so large text is stored large and costs
+    no more per pixel than small text. Sizes are separate assets, e.g. the same glyph strip
+    compiled at scale 1, 2 and 4.
+
+    Every glyph is as wide as its pixels, and is followed by the blank columns of the face
+    spacing, changed by kerning for some pairs of characters. Glyph rows are coded as pairs
+    of background and text runs, one byte each:
+
+        bbbbffff            bbbb background pixels, then ffff text pixels
+        00000000            at the start of a row, the row above repeats
+
+    Font_String decodes the rows of every character side by side and sends them as runs of
+    one color in a single window covering the whole string.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+// Longest string Font_String draws, further characters are left out
+#define FONT_MAX_CHARS 32
+
+// Get the height of a face
+//  Param:
+//      id: face asset ID
+//  Return:
+//      height in pixels, 0 if there is no such face
+uint8_t Font_Height(uint16_t id);
+
+// Get the change to the space between two characters
+//  Param:
+//      id: face asset ID
+//      left, right: characters, in that order
+//  Return:
+//      columns added to the spacing of the face, negative to bring the characters closer
+int8_t Font_Kerning(uint16_t id, char left, char right);
+
+// Get the width of a string, as Font_String would draw it without the edge of the screen
+// Characters the face does not have are left out
+//  Param:
+//      id: face asset ID
+//      str: string
+//  Return:
+//      width in pixels
+int16_t Font_Measure(uint16_t id, const char *str);
+
+// Get how many characters of a string fit in a width, e.g. to break lines
+//  Param:
+//      id: face asset ID
+//      str: string
+//      width: width in pixels
+//  Return:
+//      number of characters of str, those the face does not have included
+uint16_t Font_Fit(uint16_t id, const char *str, int16_t width);
+
+// Draw a string
+// Characters the face does not have are left out, and so are those past the right edge of
+// the screen or past FONT_MAX_CHARS
+//  Param:
+//      id: face asset ID
+//      x, y: top left corner
+//      str: string
+//      fg, bg: text and background colors
+//  Return:
+//      width drawn in pixels
+int16_t Font_String(uint16_t id, int16_t x, int16_t y, const char *str, pixel fg, pixel bg);
+
+#endif // FONT_H
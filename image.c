@@ -0,0 +1,90 @@
+#include "image.h"
+#include "pix.h"
+
+// Start decoding an image
+//  Param:
+//      dec: decoder
+//      data: compressed image
+void Image_Begin(Image_Decoder *dec, const uint8_t *data)
+{
+    dec->src = data;
+    dec->prev = 0;
+    dec->run = 0;
+    for (uint8_t i = 0; i < 64; i++)
+        dec->table[i] = 0;
+}
+
+// Decode the next pixels of an image
+// Runs can go on from one call to the next, so any number of pixels can be asked for
+//  Param:
+//      dec: decoder
+//      out: RGB565 pixels
+//      n: number of pixels
+void Image_Decode(Image_Decoder *dec, uint16_t *out, uint32_t n)
+{
+    const uint8_t *src = dec->src;
+    uint32_t c = dec->prev;
+
+    while (n)
+    {
+        uint8_t op;
+
+        if (dec->run)
+        {
+            uint16_t m = (dec->run < n) ? dec->run : n;
+
+            Pix_Fill16(out, c, m);
+            out += m;
+            n -= m;
+            dec->run -= m;
+            continue;
+        }
+
+        op = *src++;
+        if (op < IMAGE_OP_DIFF)
+        {
+            // Already in the table
+            *out++ = c = dec->table[op];
+            n--;
+            continue;
+        }
+        else if (op < IMAGE_OP_RUN)
+        {
+            uint32_t r = ((c >> 11) + ((op >> 4) & 3) - 2) & 0x1F;
+            uint32_t g = (((c >> 5) & 0x3F) + ((op >> 2) & 3) - 2) & 0x3F;
+            uint32_t b = ((c & 0x1F) + (op & 3) - 2) & 0x1F;
+            c = (r << 11) | (g << 5) | b;
+        }
+        else if (op < IMAGE_OP_LUMA)
+        {
+            dec->run = (op & 0x3F) + 1;
+            continue;
+        }
+        else if (op < IMAGE_OP_LONGRUN)
+        {
+            int32_t dg = (op & 0x1F) - 16, base = (dg + 16) / 2 - 8;
+            uint32_t r = ((c >> 11) + base + (*src >> 4) - 8) & 0x1F;
+            uint32_t g = (((c >> 5) & 0x3F) + dg) & 0x3F;
+            uint32_t b = ((c & 0x1F) + base + (*src & 0x0F) - 8) & 0x1F;
+            src++;
+            c = (r << 11) | (g << 5) | b;
+        }
+        else if (op < IMAGE_OP_COLOR)
+        {
+            dec->run = (((op & 0x0F) << 8) | *src++) + 65;
+            continue;
+        }
+        else
+        {
+            c = (src[0] << 8) | src[1];
+            src += 2;
+        }
+
+        dec->table[IMAGE_HASH(c)] = c;
+        *out++ = c;
+        n--;
+    }
+
+    dec->src = src;
+    dec->prev = c;
+}
@@ -0,0 +1,67 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+/*
+    Compressed RGB565 images, decoded as a stream straight into the buffers uDMA sends to the
+    panel, so a full screen image is painted with a single window at the speed of the SPI link.
+    The encoder is in tools/assetc.c, images are stored as ASSET_COMPRESSED bitmaps.
+
+    The format is a byte stream of operations, each giving the next pixels from the previous
+    pixel and a table of 64 recently seen colors, indexed by a hash of the color:
+
+        00iiiiii            color iiiiii of the table
+        01rrggbb            previous color plus (rr - 2, gg - 2, bb - 2)
+        10nnnnnn            previous color, nnnnnn + 1 times
+        110ggggg rrrrbbbb   previous color plus dg = ggggg - 16, and dr, db = rrrr, bbbb - 8
+                            plus (dg + 16) / 2 - 8
+        1110nnnn nnnnnnnn   previous color, nnnnnnnnnnnn + 65 times
+        11110000 hhhhhhhh llllllll
+                            color hhhhhhhhllllllll
+
+    Differences are in RGB565 units and wrap around within each channel. Every color given by
+    a difference or in full goes into the table. Decoding starts from black with an empty
+    table, and rows follow each other with nothing between them.
+
+    Does not touch any hardware, so the encoder checks its output with this decoder.
+*/
+
+#include <stdint.h>
+
+// Position of a color in the table
+#define IMAGE_HASH(c) ((((c) >> 11) * 3 + (((c) >> 5) & 0x3F) * 5 + ((c) & 0x1F) * 7) & 63)
+
+// Operations
+#define IMAGE_OP_INDEX   0x00
+#define IMAGE_OP_DIFF    0x40
+#define IMAGE_OP_RUN     0x80
+#define IMAGE_OP_LUMA    0xC0
+#define IMAGE_OP_LONGRUN 0xE0
+#define IMAGE_OP_COLOR   0xF0
+
+// Longest runs of each run operation
+#define IMAGE_RUN_MAX     64
+#define IMAGE_LONGRUN_MAX (4095 + 65)
+
+typedef struct Image_Decoder
+{
+    const uint8_t *src;         // next operation
+    uint16_t prev;              // last color
+    uint16_t run;               // pixels of the last color still to give
+    uint16_t table[64];
+} Image_Decoder;
+
+// Start decoding an image
+//  Param:
+//      dec: decoder
+//      data: compressed image
+void Image_Begin(Image_Decoder *dec, const uint8_t *data);
+
+// Decode the next pixels of an image
+// Runs can go on from one call to the next, so any number of pixels can be asked for
+//  Param:
+//      dec: decoder
+//      out: RGB565 pixels
+//      n: number of pixels
+void Image_Decode(Image_Decoder *dec, uint16_t *out, uint32_t n);
+
+#endif // IMAGE_H
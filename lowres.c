@@ -0,0 +1,103 @@
+#include "lowres.h"
+#include "pix.h"
+
+#define LOWRES_SCALE_X (LCD_WIDTH / LOWRES_WIDTH)
+#define LOWRES_SCALE_Y (LCD_HEIGHT / LOWRES_HEIGHT)
+
+#if LOWRES_SCALE_X != 2
+#error LowRes_Present scales rows with Pix_Expand16x2
+#endif
+
+uint8_t LowRes_Enabled = 0;
+uint8_t LowRes_Buffer[LOWRES_HEIGHT][LOWRES_WIDTH];
+
+static uint16_t _palette[256];          // RGB565
+
+// Window set with LCD_SetArea and the position of the next pixel in it, not clipped
+static int16_t _x0, _y0, _x1, _y1, _cx, _cy;
+
+// Turn low resolution mode on or off. The palette is reset to the default when turned on,
+// the buffer is kept
+//  Param:
+//      flag: 1 or 0, ON or OFF
+void LowRes_Enable(uint8_t flag)
+{
+    if (flag)
+    {
+        // RRRGGGBB, each channel spread over the 6-bit range
+        for (uint16_t i = 0; i < 256; i++)
+            LowRes_SetPalette(i, (pixel) { .r = (i >> 5) * 63 / 7, .g = ((i >> 2) & 7) * 63 / 7, .b = (i & 3) * 63 / 3 });
+        LowRes_Area(0, 0, LOWRES_WIDTH - 1, LOWRES_HEIGHT - 1);
+    }
+    LowRes_Enabled = flag;
+}
+
+// Change a palette entry, used from the next LowRes_Present
+//  Param:
+//      index: palette index
+//      color: new color
+void LowRes_SetPalette(uint8_t index, pixel color)
+{
+    _palette[index] = LCD_PixelTo565(color);
+}
+
+// Palette index of the default palette closest to a color
+//  Param:
+//      color: color
+//  Return:
+//      index, RRRGGGBB
+uint8_t LowRes_Index(pixel color)
+{
+    return ((color.r & 0x38) << 2) | ((color.g & 0x38) >> 1) | ((color.b & 0x30) >> 4);
+}
+
+// Send the buffer to the whole screen, scaled up through the palette
+void LowRes_Present(void)
+{
+    LCD_DMABegin(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+
+    for (uint8_t y = 0; y < LOWRES_HEIGHT; y++)
+    {
+        uint16_t *line = LCD_DMALine();
+
+        // The scaled up row is sent once for each physical row
+        Pix_Expand16x2(line, LowRes_Buffer[y], _palette, LOWRES_WIDTH);
+        for (uint8_t i = 0; i < LOWRES_SCALE_Y; i++)
+            LCD_DMAPush(line, LCD_WIDTH);
+    }
+
+    LCD_DMAEnd();
+}
+
+// Record a window set with LCD_SetArea, called by LCD_SetArea
+// The window can reach past the logical screen, LowRes_Pixel leaves those pixels out
+//  Param:
+//      x0, y0, x1, y1: window corners, inclusive, in any order
+void LowRes_Area(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    _x0 = min(x0, x1);
+    _y0 = min(y0, y1);
+    _x1 = max(x0, x1);
+    _y1 = max(y0, y1);
+    _cx = _x0;
+    _cy = _y0;
+}
+
+// Write a pixel at the window cursor, called by LCD_PushPixel
+// Moves along the window like the panel does, wrapping to the top after the last row. Pixels
+// outside the logical screen are left out
+//  Param:
+//      red, green, blue: color value. Bits [5:0] are used
+RAMFUNC void LowRes_Pixel(uint8_t red, uint8_t green, uint8_t blue)
+{
+    // Same mapping as LowRes_Index
+    if ((uint16_t) _cx < LOWRES_WIDTH && (uint16_t) _cy < LOWRES_HEIGHT)
+        LowRes_Buffer[_cy][_cx] = ((red & 0x38) << 2) | ((green & 0x38) >> 1) | ((blue & 0x30) >> 4);
+
+    if (_cx++ == _x1)
+    {
+        _cx = _x0;
+        if (_cy++ == _y1)
+            _cy = _y0;
+    }
+}
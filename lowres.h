@@ -0,0 +1,68 @@
+#ifndef LOWRES_H
+#define LOWRES_H
+
+/*
+    Low resolution mode. While it is on, LCD_SetArea and LCD_PushPixel write into a 64x64
+    buffer of 8-bit palette indices in RAM instead of the panel, so every LCD_g* primitive
+    draws in logical coordinates (0 - 63). LowRes_Present sends the whole buffer to the panel,
+    each logical pixel as 2x2 physical pixels looked up in the palette, so a frame only
+    appears once it is finished. The LCD_DMA* functions are not redirected, they always write
+    to the panel.
+
+    The buffer takes 4 KB, a full resolution frame would take 32 KB, all of the SRAM.
+
+    Colors given to the LCD_g* primitives are turned into indices with LowRes_Index, which
+    matches the default palette: 3 bits of red, 3 of green and 2 of blue. Games can also write
+    indices into the buffer directly, and change the palette for effects like color cycling.
+    Text is drawn at twice its size like everything else.
+
+    The LCD functions only check for this mode in builds with GE_LOWRES defined, so other
+    builds do not keep the buffer or pay for the check on every pixel.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+#define LOWRES_WIDTH  64
+#define LOWRES_HEIGHT 64
+
+// Nonzero while low resolution mode is on, checked by the LCD functions
+extern uint8_t LowRes_Enabled;
+
+// Logical screen, [y][x] palette indices
+extern uint8_t LowRes_Buffer[LOWRES_HEIGHT][LOWRES_WIDTH];
+
+// Turn low resolution mode on or off. The palette is reset to the default when turned on,
+// the buffer is kept
+//  Param:
+//      flag: 1 or 0, ON or OFF
+void LowRes_Enable(uint8_t flag);
+
+// Change a palette entry, used from the next LowRes_Present
+//  Param:
+//      index: palette index
+//      color: new color
+void LowRes_SetPalette(uint8_t index, pixel color);
+
+// Palette index of the default palette closest to a color
+//  Param:
+//      color: color
+//  Return:
+//      index, RRRGGGBB
+uint8_t LowRes_Index(pixel color);
+
+// Send the buffer to the whole screen, scaled up through the palette
+void LowRes_Present(void);
+
+// Record a window set with LCD_SetArea, called by LCD_SetArea
+// The window can reach past the logical screen, LowRes_Pixel leaves those pixels out
+//  Param:
+//      x0, y0, x1, y1: window corners, inclusive, in any order
+void LowRes_Area(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+// Write a pixel at the window cursor, called by LCD_PushPixel
+//  Param:
+//      red, green, blue: color value. Bits [5:0] are used
+RAMFUNC void LowRes_Pixel(uint8_t red, uint8_t green, uint8_t blue);
+
+#endif // LOWRES_H
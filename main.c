@@ -5,152 +5,94 @@
 #include "tiva-gc.h"
 #include "inc/tm4c123gh6pm.h"
 
-// Indicates a reset is needed for the currently selected update function or the menu
-static uint8_t fReset = 0;
 static LCD_Settings settings;
-// Can be used to perform some update at a regular interval using GE_STGet or GE_STPop
+// Can be used to perform some update at a regular interval using GE_NowCycles and GE_ElapsedCycles
 static uint32_t UPS = 5;
 
+const char *menu_item(uint8_t index);
+void menu_init(void);
 void menu(void);
+void snake_init(void);
 int snake(void);
-//int resetter(void);
 //int random(void);
+void pong_init(void);
 int pong(void);
 
-void menu()
+// Game registry, shown in the main menu in this order
+static const GE_Game games[] = {
+    { "Snake    ", snake_init, snake, NULL },
+    { "Pong     ", pong_init, pong, NULL }
+    //{ "Random   ", NULL, random, NULL }
+};
+#define N_GAMES (sizeof(games) / sizeof(games[0]))
+
+// Name of each game, for the menu list
+const char *menu_item(uint8_t index)
 {
-    // Persistent and read-only vars
-    static uint8_t drawn = 0;
-    const uint8_t nOptions = 2;
-    const char *options[] = {
-        "Snake    ",
-        "Pong     "
-        //"Resetter ",
-        //"Random   "
-    };
-    int (*games[])(void) = {
-        snake,
-        pong
-        //resetter,
-        //random
-    };
-    static int choice = 0, chosen = -1, held = 0;
-    static GE_Joystick JS_old = {0};
-
-    // Per loop vars
-    uint8_t changed = 0;
+    return games[index].name;
+}
 
-    // Controls
-    static GE_Button *menuSelect = &SW1;
+// Menu screen, kept between games
+static UI_Panel menu_top, menu_bottom;
+static UI_Label menu_title;
+static UI_List menu_list;
+static UI_Widget *const menu_screen[] = { &menu_top.w, &menu_bottom.w, &menu_title.w, &menu_list.w };
+static GE_Joystick JS_old = {0};
 
-    // Reset to the main menu
-    if (fReset)
-    {
-        drawn = 0;
-        choice = 0;
-        chosen = -1;
-        held = 0;
-        fReset = 0;
-        LCD_gClear();
-        return;
-    }
+// Reset to the main menu, called by the engine every time the menu is entered
+void menu_init(void)
+{
+    LCD_gClear();
+    settings = LCD_GetSettings();
 
-    // One time drawing
-    if (!drawn)
-    {
-        drawn = 1;
-        LCD_gClear();
-        LCD_gFillRect(0, 0, LCD_WIDTH - 1, 9, LCD_DARK_GREY);
-        LCD_SetBGColor(LCD_RED);
-        LCD_gString(0, 0, "Tiva GC", 0, LCD_RED);
-
-        LCD_gFillRect(0, LCD_HEIGHT - 8, LCD_WIDTH - 1, 8, LCD_DARK_GREY);
-        // LCD_gString(14, 15, "Menu V1", 0, LCD_RED);
-        LCD_SetBGColor(LCD_BLACK);
-        settings = LCD_GetSettings();
-        changed = 1;
-    }
+    UI_PanelInit(&menu_top, 0, 0, LCD_WIDTH - 1, 9, LCD_DARK_GREY);
+    UI_PanelInit(&menu_bottom, 0, LCD_HEIGHT - 8, LCD_WIDTH - 1, 8, LCD_DARK_GREY);
+    UI_LabelInit(&menu_title, 0, 0, 7, "Tiva GC", LCD_RED, LCD_RED);
+    UI_ListInit(&menu_list, 1, 2, 9, menu_item, N_GAMES, LCD_LIGHT_GREY, LCD_BLACK);
+
+    JS_old = JS;
+}
+
+void menu()
+{
+    // Controls
+    static GE_Button *menuSelect = &SW1;
 
     // Check inputs
     if (JS.up && !JS_old.up)
-    {
-        choice--;
-        if (choice < 0)
-            choice = nOptions - 1;
-        changed = 1;
-    }
+        UI_ListMove(&menu_list, -1);
     if (JS.down && !JS_old.down)
-    {
-        choice++;
-        choice %= nOptions;
-        changed = 1;
-    }
+        UI_ListMove(&menu_list, 1);
     JS_old = JS;
 
-    if (menuSelect->pressed)
-    {
-        chosen = choice;
-        changed = 1;
-    }
-    if (menuSelect->held != held)
-    {
-        held = menuSelect->held;
-        changed = 1;
-    }
+    UI_ListSetHeld(&menu_list, menuSelect->held);
 
     // Draw
-    if (changed)
-    {
-        // Draw menu elements
-        for (int i = 0; i < nOptions; i++)
-        {
-            if (choice == i)
-            {
-                if (held)
-                    LCD_SetBGColor(LCD_WHITE);
-                else
-                    LCD_SetBGColor(LCD_LIGHT_GREY);
-                LCD_gString(1, 2 + i, options[i], 9, LCD_BLACK);
-                LCD_SetBGColor(LCD_BLACK);
-            }
-            else
-            {
-                LCD_gString(1, 2 + i, options[i], 9, LCD_LIGHT_GREY);
-            }
-        }
-    }
+    UI_Draw(menu_screen, sizeof(menu_screen) / sizeof(menu_screen[0]));
 
     // If a choice was made, start the game
-    if (chosen > -1)
+    if (menuSelect->pressed)
     {
-        GE_SetUpdate(games[chosen]);
+        GE_SetGame(&games[menu_list.selected]);
         LCD_gClear();
-        fReset = 1;
     }
 }
 
 /*
-int resetter()
-{
-    return 0;
-}
-
 int random()
 {
     uint32_t n;
     if (SEL.pressed)
     {
-        fReset = 1;
         return 0;
     } else
     {
-        fReset = 0;
         LCD_SetArea(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
         LCD_ActivateWrite();
         for (int i = 0; i < LCD_HEIGHT; i++)
             for (int j = 0; j < LCD_WIDTH; j++)
             {
-                n = GE_Rand();
+                n = Rand_Next(&GE_RandFX);
                 LCD_PushPixel(n & 0x3F, (n >> 6) & 0x3F, (n >> 12) & 0x3F);
             }
     }
@@ -160,268 +102,312 @@ int random()
 
 enum snake_direction { UP = 0, RIGHT = 1, DOWN = 2, LEFT = 3 };
 
-void snake_spawn_food(int8_t cells[][2], uint16_t tail_idx);
+// 31x31 grid of 4x4 pixel cells, 31*31 = 961
+// A cell is identified by its index y * SNAKE_GRID + x
+#define SNAKE_GRID  31
+#define SNAKE_CELLS (SNAKE_GRID * SNAKE_GRID)
+
+// Snake game state
+// The body is a ring buffer of cells, going from the tail to the head. Which cells the body
+// takes up is also kept in a bitmap, one word per row, so collisions are a single bit test.
+// Every cell not taken by the body or the food is kept in the free list, in no particular
+// order, and free_idx holds the position of each free cell in the list so cells can be
+// taken out and put back by swapping with the last one.
+// Moving, checking for collisions and spawning food are all O(1) this way.
+// The game is won when there are no free cells left.
+typedef struct snake_state
+{
+    uint16_t body[SNAKE_CELLS];
+    uint16_t head, length;
+    uint32_t occupied[SNAKE_GRID];
+    uint16_t free[SNAKE_CELLS];
+    uint16_t free_idx[SNAKE_CELLS];
+    uint16_t n_free;
+    uint16_t food;
+
+    uint64_t time;
+    enum snake_direction facing, input, old_facing;
+
+    // speed selection screen
+    UI_Label title;
+    UI_List speeds;
+    GE_Joystick JS_old;
+} snake_state;
+
+// The arena is empty when snake_init runs, so GE_Alloc only fails if the state cannot fit at all
+__extension__ _Static_assert(sizeof(snake_state) <= GE_ARENA_SIZE, "snake_state does not fit in the game arena");
+
+// Allocated from the game arena in snake_init
+static snake_state *sn;
+
+static const char *const snake_options[4] = {
+    "Slow  ",
+    "Medium",
+    "Fast  ",
+    "Sanic "
+};
+static const uint32_t snake_speeds[4] = { 5, 7, 10, 15 };
+
+// Jingles, played on voice 1
+static const Mixer_Note snake_lose[] = { {67, 2}, {63, 2}, {60, 2}, {55, 6} };
+static const Mixer_Note snake_win[] = { {72, 1}, {76, 1}, {79, 1}, {84, 6} };
+
+const char *snake_option(uint8_t index);
+void snake_free_take(uint16_t cell);
+void snake_free_put(uint16_t cell);
+void snake_spawn_food(void);
 int snake_config(void);
+void snake_start(void);
+int snake_step(void);
 
-int snake_config(void)
+// Name of each speed, for the speed list
+const char *snake_option(uint8_t index)
 {
-    static int option = 1;
-    static GE_Joystick JS_old = {0};
-    char *options[4] = {
-        "Slow  ",
-        "Medium",
-        "Fast  ",
-        "Sanic "
-    };
-    uint32_t speeds[4] = { 5, 7, 10, 15};
-
-    if (fReset == 1)
-    {
-        LCD_gString(1, 2, "Snake speed:", 0, LCD_WHITE);
-        LCD_gString(14, 2, options[0], 0, LCD_WHITE);
-        LCD_SetBGColor(LCD_LIGHT_GREY);
-        LCD_gString(14, 3, options[1], 0, LCD_BLACK);
-        LCD_SetBGColor(settings.BGColor);
-        LCD_gString(14, 4, options[2], 0, LCD_WHITE);
-        LCD_gString(14, 5, options[3], 0, LCD_WHITE);
+    return snake_options[index];
+}
 
-        option = 1;
-        fReset = 2;
-    }
+// Take a cell out of the free list
+void snake_free_take(uint16_t cell)
+{
+    uint16_t last = sn->free[--sn->n_free];
+    uint16_t idx = sn->free_idx[cell];
 
-    if (JS.down && !JS_old.down)
-    {
-        LCD_gString(14, 2 + option, options[option], 0, LCD_WHITE);
+    sn->free[idx] = last;
+    sn->free_idx[last] = idx;
+}
 
-        option = (option + 1) & 0x03;
+// Put a cell back into the free list
+void snake_free_put(uint16_t cell)
+{
+    sn->free[sn->n_free] = cell;
+    sn->free_idx[cell] = sn->n_free++;
+}
 
-        LCD_SetBGColor(LCD_LIGHT_GREY);
-        LCD_gString(14, 2 + option, options[option], 0, LCD_BLACK);
-        LCD_SetBGColor(settings.BGColor);
-    } else if (JS.up && !JS_old.up)
-    {
-        LCD_gString(14, 2 + option, options[option], 0, LCD_WHITE);
+// Speed selection screen, shown before the game starts
+//  Return:
+//      1 once a speed was chosen, 0 otherwise
+int snake_config(void)
+{
+    UI_Widget *const screen[] = { &sn->title.w, &sn->speeds.w };
 
-        option = (option + 3) & 0x03;
+    if (JS.down && !sn->JS_old.down)
+        UI_ListMove(&sn->speeds, 1);
+    else if (JS.up && !sn->JS_old.up)
+        UI_ListMove(&sn->speeds, -1);
+    sn->JS_old = JS;
 
-        LCD_SetBGColor(LCD_LIGHT_GREY);
-        LCD_gString(14, 2 + option, options[option], 0, LCD_BLACK);
-        LCD_SetBGColor(settings.BGColor);
-    }
-    JS_old = JS;
+    UI_Draw(screen, 2);
 
     if (SW1.pressed)
     {
-        UPS = speeds[option];
+        UPS = snake_speeds[sn->speeds.selected];
         return 1;
     }
 
     return 0;
 }
 
-void snake_spawn_food(int8_t cells[][2], uint16_t tail_idx)
+// Allocates the game state and sets up the speed selection screen
+void snake_init(void)
+{
+    sn = GE_Alloc(sizeof(snake_state));
+
+    UI_LabelInit(&sn->title, 1, 2, 12, "Snake speed:", LCD_WHITE, settings.BGColor);
+    UI_ListInit(&sn->speeds, 14, 2, 6, snake_option, 4, LCD_WHITE, settings.BGColor);
+    UI_ListSelect(&sn->speeds, 1);
+    sn->JS_old = JS;
+
+    Audio_SetVoice(0, MIXER_SQUARE, 160);       // food blip
+    Audio_SetEnvelope(0, 1, 60, 0, 10);
+    Audio_SetVoice(1, MIXER_TRIANGLE, 255);     // jingles
+    Audio_SetEnvelope(1, 5, 40, 180, 40);
+    Audio_SetTempo(150, 4);
+}
+
+// Place the food pellet on a random free cell
+void snake_spawn_food(void)
 {
-    int8_t x = -1, y = -1, i, c = 31;
-    // Se elige primero una x con espacio libre, luego una y libre en esa linea
+    sn->food = sn->free[GE_RandRange(sn->n_free)];
+    snake_free_take(sn->food);
+}
 
-    while (c == 31)
-    {
-        x = GE_Rand() % 31;
-        for (i = 0, c = 0; i <= tail_idx; i++)
-        {
-            if (cells[i][0] == x)
-                c++;
-        }
-    }
-    while (y == -1)
+// Starts the game once the speed was chosen
+void snake_start(void)
+{
+    uint16_t cell;
+
+    // Draw borders
+    // Playing field area: 124x124 pixels, 31x31 4x4 pixel squares
+    LCD_gClear();
+    LCD_gHLine(0, LCD_WIDTH - 1, 0, 1, LCD_WHITE);
+    LCD_gHLine(0, LCD_WIDTH - 1, LCD_HEIGHT - 1, 1, LCD_WHITE);
+    LCD_gVLine(0, 0, LCD_HEIGHT - 1, 1, LCD_WHITE);
+    LCD_gVLine(LCD_WIDTH - 1, 0, LCD_HEIGHT - 1, 1, LCD_WHITE);
+
+    // Empty grid
+    sn->n_free = 0;
+    for (cell = 0; cell < SNAKE_CELLS; cell++)
+        snake_free_put(cell);
+    for (int i = 0; i < SNAKE_GRID; i++)
+        sn->occupied[i] = 0;
+
+    // Starter snake, 2 cells long, going up
+    sn->body[0] = 17 * SNAKE_GRID + 16;
+    sn->body[1] = 16 * SNAKE_GRID + 16;
+    sn->head = 1;
+    sn->length = 2;
+    for (int i = 0; i < 2; i++)
     {
-        y = GE_Rand() % 31;
-        for (i = 0; i <= tail_idx; i++)
-        {
-            if (cells[i][0] == x && cells[i][1] == y)
-            {
-                y = -1;
-                break;
-            }
-        }
+        snake_free_take(sn->body[i]);
+        sn->occupied[sn->body[i] / SNAKE_GRID] |= 1 << (sn->body[i] % SNAKE_GRID);
     }
-
-    cells[tail_idx + 1][0] = x;
-    cells[tail_idx + 1][1] = y;
+    sn->facing = UP;
+    sn->input = UP;
+    sn->old_facing = UP;
+    sn->time = GE_NowCycles() - CLOCKS_PER_SEC;   // move right away
+
+    // Started food pellet
+    sn->food = 10 * SNAKE_GRID + 16;
+    snake_free_take(sn->food);
+
+    // Initial drawing
+        // snake
+    LCD_gFillRect(2 + (16 << 2), 2 + (16 << 2), 4, 4, LCD_DARK_GREEN);
+    LCD_gFillRect(3 + (16 << 2), 2 + (16 << 2), 2, 4, LCD_GREEN);
+    LCD_gFillRect(2 + (16 << 2), 2 + (17 << 2), 4, 4, LCD_DARK_GREEN);
+    LCD_gFillRect(3 + (16 << 2), 2 + (17 << 2), 2, 4, LCD_GREEN);
+
+        // food
+    LCD_gFillRect(2 + (16 << 2), 3 + (10 << 2), 4, 2, LCD_RED);
+    LCD_gFillRect(3 + (16 << 2), 5 + (10 << 2), 2, 1, LCD_RED);
+    LCD_gFillRect(3 + (16 << 2), 2 + (10 << 2), 2, 1, LCD_GREEN);
 }
 
-int snake()
+int snake(void)
 {
-    static uint32_t time = 0;
-    static uint8_t game_over = 0;
-    uint8_t food_hit = 0;
+    GE_Begin();
 
-    // 31x31 grid of 4x4 pixel cells, 31*31 = 961
-    // Each cell holds 2 values: x, y
-    // Cells are stored in order: 0 is head, and the tail is indicated by the tail_idx variable.
-    // The cell immediately after the tail is the food pellet.
-    // The game is won if the 961st cell is the tail cell, i.e. the cell takes up all of the grid.
-    static int8_t cells[961][2] = {0};
-    static uint16_t tail_idx = 1;
-    int8_t old_tailx, old_taily, new_headx, new_heady;
-    static enum snake_direction facing, input, old_facing;
-
-    // First time drawing and setup
-    if (fReset)
-    {
-        if (!snake_config())
-            return 1;
+    GE_AwaitUntil(snake_config());
+    snake_start();
 
-        // Draw borders
-        // Playing field area: 124x124 pixels, 31x31 4x4 pixel squares
-        LCD_gClear();
-        LCD_gHLine(0, LCD_WIDTH - 1, 0, 1, LCD_WHITE);
-        LCD_gHLine(0, LCD_WIDTH - 1, LCD_HEIGHT - 1, 1, LCD_WHITE);
-        LCD_gVLine(0, 0, LCD_HEIGHT - 1, 1, LCD_WHITE);
-        LCD_gVLine(LCD_WIDTH - 1, 0, LCD_HEIGHT - 1, 1, LCD_WHITE);
-
-        // Starter snake, 2 cells long
-        cells[0][0] = 16;
-        cells[0][1] = 16;
-        cells[1][0] = 16;
-        cells[1][1] = 17;
-        tail_idx = 1;
-        old_tailx = 16;
-        old_taily = 17;
-        facing = UP;
-        input = UP;
-        old_facing = UP;
-        time = CLOCKS_PER_SEC;
-        GE_STPop();
-
-        // Started food pellet
-        cells[2][0] = 16;
-        cells[2][1] = 10;
-
-        // Initial drawing
-            // snake
-        LCD_gFillRect(2 + (cells[0][0] << 2), 2 + (cells[0][1] << 2), 4, 4, LCD_DARK_GREEN);
-        LCD_gFillRect(3 + (cells[0][0] << 2), 2 + (cells[0][1] << 2), 2, 4, LCD_GREEN);
-        LCD_gFillRect(2 + (cells[1][0] << 2), 2 + (cells[1][1] << 2), 4, 4, LCD_DARK_GREEN);
-        LCD_gFillRect(3 + (cells[1][0] << 2), 2 + (cells[1][1] << 2), 2, 4, LCD_GREEN);
-
-            // food
-        LCD_gFillRect(2 + (cells[2][0] << 2), 3 + (cells[2][1] << 2), 4, 2, LCD_RED);
-        LCD_gFillRect(3 + (cells[2][0] << 2), 5 + (cells[2][1] << 2), 2, 1, LCD_RED);
-        LCD_gFillRect(3 + (cells[2][0] << 2), 2 + (cells[2][1] << 2), 2, 1, LCD_GREEN);
-
-        fReset = 0;
-        game_over = 0;
+    GE_AwaitUntil(!snake_step());
 
-        return 1;
-    }
+    // Game over or victory message stays until any button is pressed
+    GE_AwaitUntil(SEL.pressed || SW1.pressed || SW2.pressed);
+
+    GE_End();
+}
+
+// Runs one loop of the game
+//  Return:
+//      1 while playing, 0 once the game is over
+int snake_step(void)
+{
+    uint8_t food_hit = 0;
+
+    uint16_t old_tail, neck, cell;
+    int8_t new_headx, new_heady;
 
     /* Input */
-    if (game_over)
-    {
-        if (SEL.pressed || SW1.pressed || SW2.pressed)
-        {
-            fReset = 1;
-            return 0;
-        }
-        return 1;
-    } else
-    {
-        if (JS.down && facing != UP)
-            input = DOWN;
-        else if (JS.up && facing != DOWN)
-            input = UP;
-        else if (JS.right && facing != LEFT)
-            input = RIGHT;
-        else if (JS.left && facing != RIGHT)
-            input = LEFT;
-    }
+    if (JS.down && sn->facing != UP)
+        sn->input = DOWN;
+    else if (JS.up && sn->facing != DOWN)
+        sn->input = UP;
+    else if (JS.right && sn->facing != LEFT)
+        sn->input = RIGHT;
+    else if (JS.left && sn->facing != RIGHT)
+        sn->input = LEFT;
 
     /* Logic */
 
     // The game is very fast, a delay before the logic and drawing code but after checking inputs allows for 
     // better reaction to inputs
-    time += GE_STPop();
-    if (time >= (CLOCKS_PER_SEC / UPS)) // delay
-        time = 0;
+    if (GE_ElapsedCycles(sn->time) >= (CLOCKS_PER_SEC / UPS)) // delay
+        sn->time = GE_NowCycles();
     else
         return 1;
 
-    old_facing = facing;    // for drawing purposes
-    facing = input;         // accept last input
+    sn->old_facing = sn->facing;    // for drawing purposes
+    sn->facing = sn->input;         // accept last sn->input
 
     // Move
         // head
-    switch (facing)
+    neck = sn->body[sn->head];
+    new_headx = neck % SNAKE_GRID;
+    new_heady = neck / SNAKE_GRID;
+    switch (sn->facing)
     {
     case UP:
-        new_headx = cells[0][0];
-        new_heady = cells[0][1] - 1;
+        new_heady--;
         break;
     case DOWN:
-        new_headx = cells[0][0];
-        new_heady = cells[0][1] + 1;
+        new_heady++;
         break;
     case RIGHT:
-        new_headx = cells[0][0] + 1;
-        new_heady = cells[0][1];
+        new_headx++;
         break;
     case LEFT:
-        new_headx = cells[0][0] - 1;
-        new_heady = cells[0][1];
+        new_headx--;
         break;
     }
-        // body
-    old_tailx = cells[tail_idx][0];
-    old_taily = cells[tail_idx][1];
-    for (int i = tail_idx; i > 0; i--)
+
+        // check if head collides with a wall
+    if (new_headx < 0 || new_heady < 0 || new_headx >= SNAKE_GRID || new_heady >= SNAKE_GRID)
     {
-        // check if head collides with body
-        if (new_headx == cells[i - 1][0] && new_heady == cells[i - 1][1])
-        {
-            // game over
-            LCD_SetBGColor(LCD_LIGHT_GREY);
-            LCD_gHLine(42, 96, 48, 1, LCD_LIGHT_GREY);
-            LCD_gString(7, 6, "GAME OVER", 0, LCD_RED);
-            LCD_SetBGColor(settings.BGColor);
-            game_over = 1;
-            return 1;
-        }
-        cells[i][0] = cells[i - 1][0];
-        cells[i][1] = cells[i - 1][1];
+        // game over
+        LCD_SetBGColor(LCD_LIGHT_GREY);
+        LCD_gHLine(42, 96, 48, 1, LCD_LIGHT_GREY);
+        LCD_gString(7, 6, "GAME OVER", 0, LCD_RED);
+        LCD_SetBGColor(settings.BGColor);
+        Audio_Play(1, snake_lose, 4, 0);
+        return 0;
     }
-    cells[0][0] = new_headx;
-    cells[0][1] = new_heady;
+    cell = new_heady * SNAKE_GRID + new_headx;
+    food_hit = (cell == sn->food);
 
-        // check if head collides with a wall
-    if (cells[0][0] < 0 || cells[0][1] < 0 || cells[0][0] >= 31 || cells[0][1] >= 31)
+        // tail, moves out of the way unless the snake grows
+    old_tail = sn->body[(sn->head + SNAKE_CELLS + 1 - sn->length) % SNAKE_CELLS];
+    if (!food_hit)
+    {
+        sn->occupied[old_tail / SNAKE_GRID] &= ~(1 << (old_tail % SNAKE_GRID));
+        snake_free_put(old_tail);
+        sn->length--;
+    }
+
+        // check if head collides with body
+    if (sn->occupied[new_heady] & (1 << new_headx))
     {
         // game over
         LCD_SetBGColor(LCD_LIGHT_GREY);
         LCD_gHLine(42, 96, 48, 1, LCD_LIGHT_GREY);
         LCD_gString(7, 6, "GAME OVER", 0, LCD_RED);
         LCD_SetBGColor(settings.BGColor);
-        game_over = 1;
-        return 1;
+        Audio_Play(1, snake_lose, 4, 0);
+        return 0;
     }
-        // check if head collides with food
-    if (cells[0][0] == cells[tail_idx + 1][0] && cells[0][1] == cells[tail_idx + 1][1])
+
+    sn->head = (sn->head + 1) % SNAKE_CELLS;
+    sn->body[sn->head] = cell;
+    sn->length++;
+    sn->occupied[new_heady] |= 1 << new_headx;
+    if (!food_hit)
+        snake_free_take(cell);      // the food cell was already out of the free list
+
+        // eat food
+    if (food_hit)
     {
-        food_hit = 1;
-        tail_idx++;
-        if (tail_idx == 961)    // victory
+        if (sn->n_free == 0)    // victory
         {
             LCD_SetBGColor(LCD_LIGHT_GREY);
             LCD_gHLine(42, 96, 48, 1, LCD_LIGHT_GREY);
             LCD_gString(8, 6, "VICTORY", 0, LCD_BLUE);
             LCD_SetBGColor(settings.BGColor);
-            game_over = 1;
-            return 1;
+            Audio_Play(1, snake_win, 4, 0);
+            return 0;
         }
 
-        cells[tail_idx][0] = old_tailx;
-        cells[tail_idx][1] = old_taily;
-        snake_spawn_food(cells, tail_idx);
+        Audio_NoteOn(0, 84);
+        snake_spawn_food();
     }
 
     /* Drawing */
@@ -429,213 +415,238 @@ int snake()
     // Draw food
     if (food_hit)
     {
-        LCD_gFillRect(2 + (cells[tail_idx + 1][0] << 2), 3 + (cells[tail_idx + 1][1] << 2), 4, 2, LCD_RED);
-        LCD_gFillRect(3 + (cells[tail_idx + 1][0] << 2), 5 + (cells[tail_idx + 1][1] << 2), 2, 1, LCD_RED);
-        LCD_gFillRect(3 + (cells[tail_idx + 1][0] << 2), 2 + (cells[tail_idx + 1][1] << 2), 2, 1, LCD_GREEN);
+        LCD_gFillRect(2 + ((sn->food % SNAKE_GRID) << 2), 3 + ((sn->food / SNAKE_GRID) << 2), 4, 2, LCD_RED);
+        LCD_gFillRect(3 + ((sn->food % SNAKE_GRID) << 2), 5 + ((sn->food / SNAKE_GRID) << 2), 2, 1, LCD_RED);
+        LCD_gFillRect(3 + ((sn->food % SNAKE_GRID) << 2), 2 + ((sn->food / SNAKE_GRID) << 2), 2, 1, LCD_GREEN);
     }
 
     // Erase old tail if food was not eaten
     else
-        LCD_gFillRect(2 + (old_tailx << 2), 2 + (old_taily << 2), 4, 4, settings.BGColor);
+        LCD_gFillRect(2 + ((old_tail % SNAKE_GRID) << 2), 2 + ((old_tail / SNAKE_GRID) << 2), 4, 4, settings.BGColor);
 
     // Draw new head segment
-    LCD_gFillRect(2 + (cells[0][0] << 2), 2 + (cells[0][1] << 2), 4, 4, LCD_DARK_GREEN);
+    LCD_gFillRect(2 + (new_headx << 2), 2 + (new_heady << 2), 4, 4, LCD_DARK_GREEN);
 
     // new head segment will just be straight
-    if (facing == UP || facing == DOWN)
+    if (sn->facing == UP || sn->facing == DOWN)
     {
-        LCD_gFillRect(3 + (cells[0][0] << 2), 2 + (cells[0][1] << 2), 2, 4, LCD_GREEN);
+        LCD_gFillRect(3 + (new_headx << 2), 2 + (new_heady << 2), 2, 4, LCD_GREEN);
     } else
     {
-        LCD_gFillRect(2 + (cells[0][0] << 2), 3 + (cells[0][1] << 2), 4, 2, LCD_GREEN);
+        LCD_gFillRect(2 + (new_headx << 2), 3 + (new_heady << 2), 4, 2, LCD_GREEN);
     }
 
     // neck has different coloring if the snake is turning
-    if (old_facing != facing)
+    if (sn->old_facing != sn->facing)
     {
-        LCD_gFillRect(2 + (cells[1][0] << 2), 2 + (cells[1][1] << 2), 4, 4, LCD_DARK_GREEN);
+        new_headx = neck % SNAKE_GRID;
+        new_heady = neck / SNAKE_GRID;
+
+        LCD_gFillRect(2 + (new_headx << 2), 2 + (new_heady << 2), 4, 4, LCD_DARK_GREEN);
 
-        if (old_facing == UP || facing == DOWN)
-            LCD_gFillRect(3 + (cells[1][0] << 2), 3 + (cells[1][1] << 2), 2, 3, LCD_GREEN);
-        else if (old_facing == DOWN || facing == UP)
-            LCD_gFillRect(3 + (cells[1][0] << 2), 2 + (cells[1][1] << 2), 2, 3, LCD_GREEN);
+        if (sn->old_facing == UP || sn->facing == DOWN)
+            LCD_gFillRect(3 + (new_headx << 2), 3 + (new_heady << 2), 2, 3, LCD_GREEN);
+        else if (sn->old_facing == DOWN || sn->facing == UP)
+            LCD_gFillRect(3 + (new_headx << 2), 2 + (new_heady << 2), 2, 3, LCD_GREEN);
 
-        if (old_facing == RIGHT || facing == LEFT)
-            LCD_gFillRect(2 + (cells[1][0] << 2), 3 + (cells[1][1] << 2), 1, 2, LCD_GREEN);
-        else if (old_facing == LEFT || facing == RIGHT)
-            LCD_gFillRect(5 + (cells[1][0] << 2), 3 + (cells[1][1] << 2), 1, 2, LCD_GREEN);
+        if (sn->old_facing == RIGHT || sn->facing == LEFT)
+            LCD_gFillRect(2 + (new_headx << 2), 3 + (new_heady << 2), 1, 2, LCD_GREEN);
+        else if (sn->old_facing == LEFT || sn->facing == RIGHT)
+            LCD_gFillRect(5 + (new_headx << 2), 3 + (new_heady << 2), 1, 2, LCD_GREEN);
     }
 
     return 1;
 }
 
-int pong(void)
+// Pong game state
+typedef struct pong_state
 {
-    static uint16_t p1Score, p2Score, scored;
-    static uint16_t p1Pos, p2Pos, movSpeed;
-    static uint16_t paddleThickness, paddleWidth;
-    static point ballSize;
-    static point ballPos, ballSpeed;
-    static uint32_t time;
-    const int32_t topBorder = 9, bottomBorder = LCD_HEIGHT - 1, paddleX = 2, scoredTimeout = UPS;
-    static char scoreBoard[2][4];
-
-    if (fReset)
-    {
-        UPS = 25;
-        p1Score = 0;
-        p2Score = 0;
-        scored = 0;
-        p1Pos = p2Pos = (LCD_HEIGHT + 8) / 2;
-        movSpeed = 5;
-        paddleThickness = 3;
-        paddleWidth = 16;
-        ballPos = (point) {.x = LCD_WIDTH / 2, .y = (LCD_HEIGHT + 8) / 2};
-        ballSpeed = (point) {.x = -4, .y = 0};
-        ballSize = (point) {.x = 4, .y = 4};
-
-        time = 0;
-        GE_STPop();
-        fReset = 0;
-
-        // Borders
-        LCD_gFillRect(0, 0, LCD_WIDTH, topBorder, LCD_WHITE);
-        LCD_gHLine(0, LCD_WIDTH, bottomBorder, 1, LCD_WHITE);
-
-        scoreBoard[0][2] = '0';
-        scoreBoard[0][1] = ' ';
-        scoreBoard[0][0] = ' ';
-        scoreBoard[0][3] = '\0';
-        scoreBoard[1][2] = '0';
-        scoreBoard[1][1] = ' ';
-        scoreBoard[1][0] = ' ';
-        scoreBoard[1][3] = '\0';
-        LCD_SetBGColor(LCD_WHITE);
-        LCD_gString(1, 0, scoreBoard[0], 0, LCD_BLACK);
-        LCD_gString(17, 0, scoreBoard[1], 0, LCD_BLACK);
-        LCD_SetBGColor(settings.BGColor);
+    uint16_t p1Score, p2Score, scored;
+    uint16_t p1Pos, p2Pos, movSpeed;
+    uint16_t paddleThickness, paddleWidth;
+    point ballSize;
+    point ballPos, ballSpeed;
+    uint64_t time;
+    Text_Layer hud;
+} pong_state;
 
-        // Paddles
-        LCD_gFillRect(paddleX, p1Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, LCD_LIGHT_GREY);
-        LCD_gFillRect(LCD_WIDTH - paddleX - paddleThickness, p2Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, LCD_LIGHT_GREY);
+// The arena is empty when pong_init runs, so GE_Alloc only fails if the state cannot fit at all
+__extension__ _Static_assert(sizeof(pong_state) <= GE_ARENA_SIZE, "pong_state does not fit in the game arena");
 
-        // Ball
-        LCD_gFillRect(ballPos.x - (ballSize.x >> 1), ballPos.y - (ballSize.y >> 1), ballSize.x, ballSize.y, LCD_LIGHT_GREY);
+// Allocated from the game arena in pong_init
+static pong_state *pg;
 
-        return 1;
-    }
+static const int32_t topBorder = 9, bottomBorder = LCD_HEIGHT - 1, paddleX = 2;
+static const Mixer_Note pong_goal[] = { {60, 1}, {64, 1}, {67, 3} };
 
-    time += GE_STPop();
-    if (time < (CLOCKS_PER_SEC / UPS))
+void pong_score(void);
+
+// Write both scores to the top border, they are only drawn if they changed
+void pong_score(void)
+{
+    Text_Goto(&pg->hud, 1, 0);
+    Text_Print(&pg->hud, "%3u", pg->p1Score);
+    Text_Goto(&pg->hud, 17, 0);
+    Text_Print(&pg->hud, "%3u", pg->p2Score);
+}
+
+// Allocates the game state and draws the field
+void pong_init(void)
+{
+    pg = GE_Alloc(sizeof(pong_state));
+
+    UPS = 25;
+    pg->p1Score = 0;
+    pg->p2Score = 0;
+    pg->scored = 0;
+    pg->p1Pos = pg->p2Pos = (LCD_HEIGHT + 8) / 2;
+    pg->movSpeed = 5;
+    pg->paddleThickness = 3;
+    pg->paddleWidth = 16;
+    pg->ballPos = (point) {.x = LCD_WIDTH / 2, .y = (LCD_HEIGHT + 8) / 2};
+    pg->ballSpeed = (point) {.x = -4, .y = 0};
+    pg->ballSize = (point) {.x = 4, .y = 4};
+
+    Audio_SetVoice(0, MIXER_SQUARE, 160);       // bounces
+    Audio_SetEnvelope(0, 1, 40, 0, 10);
+    Audio_SetVoice(1, MIXER_SAW, 200);          // goals
+    Audio_SetEnvelope(1, 2, 30, 160, 30);
+    Audio_SetTempo(150, 4);
+
+    pg->time = GE_NowCycles();
+
+    // Borders
+    LCD_gFillRect(0, 0, LCD_WIDTH, topBorder, LCD_WHITE);
+    LCD_gHLine(0, LCD_WIDTH, bottomBorder, 1, LCD_WHITE);
+
+    // Scoreboard, on the top border
+    Text_Init(&pg->hud, LCD_WHITE, settings.BGColor);
+    Text_SetColor(&pg->hud, LCD_BLACK, LCD_WHITE);
+    Text_Goto(&pg->hud, 0, 0);
+    Text_Print(&pg->hud, "%21s", "");
+    pong_score();
+    Text_Flush(&pg->hud);
+
+    // Paddles
+    LCD_gFillRect(paddleX, pg->p1Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, LCD_LIGHT_GREY);
+    LCD_gFillRect(LCD_WIDTH - paddleX - pg->paddleThickness, pg->p2Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, LCD_LIGHT_GREY);
+
+    // Ball
+    LCD_gFillRect(pg->ballPos.x - (pg->ballSize.x >> 1), pg->ballPos.y - (pg->ballSize.y >> 1), pg->ballSize.x, pg->ballSize.y, LCD_LIGHT_GREY);
+}
+
+int pong(void)
+{
+    const int32_t scoredTimeout = UPS;
+
+    if (GE_ElapsedCycles(pg->time) < (CLOCKS_PER_SEC / UPS))
         return 1;
-    time = 0;
+    pg->time = GE_NowCycles();
 
     // Scored and reset precedure
-    if (scored)
+    if (pg->scored)
     {
-        if (scored == scoredTimeout)
+        if (pg->scored == scoredTimeout)
         {
-            LCD_gFillRect(ballPos.x - (ballSize.x >> 1), ballPos.y - (ballSize.y >> 1), ballSize.x, ballSize.y, settings.BGColor);
-
-            ballPos = (point) {.x = LCD_WIDTH / 2, .y = (LCD_HEIGHT + 8) / 2};
-
-            ballSpeed.y = GE_Rand() % (5) - 2;
-
-            // Scoreboard update
-            scoreBoard[0][2] = '0' + p1Score % 10;
-            scoreBoard[0][1] = (p1Score >= 10) ? '0' + (p1Score % 100 - p1Score % 10) / 10 : ' ';
-            scoreBoard[0][0] = (p1Score >= 100) ? '0' + (p1Score % 1000 - p1Score % 100) / 100 : ' ';
-            scoreBoard[0][3] = '\0';
-            scoreBoard[1][2] = '0' + p2Score % 10;
-            scoreBoard[1][1] = (p2Score >= 10) ? '0' + (p2Score % 100 - p2Score % 10) / 10 : ' ';
-            scoreBoard[1][0] = (p2Score >= 100) ? '0' + (p2Score % 1000 - p2Score % 100) / 100 : ' ';
-            scoreBoard[1][3] = '\0';
-            LCD_SetBGColor(LCD_WHITE);
-            LCD_gString(1, 0, scoreBoard[0], 0, LCD_BLACK);
-            LCD_gString(17, 0, scoreBoard[1], 0, LCD_BLACK);
-            LCD_SetBGColor(settings.BGColor);
+            LCD_gFillRect(pg->ballPos.x - (pg->ballSize.x >> 1), pg->ballPos.y - (pg->ballSize.y >> 1), pg->ballSize.x, pg->ballSize.y, settings.BGColor);
+
+            pg->ballPos = (point) {.x = LCD_WIDTH / 2, .y = (LCD_HEIGHT + 8) / 2};
+
+            pg->ballSpeed.y = (int32_t) GE_RandRange(5) - 2;
+
+            pong_score();
         }
-        scored--;
+        pg->scored--;
     }
 
     // Erase if moved
         // Paddles
-    if (JS.down || JS.up) LCD_gFillRect(paddleX, p1Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, settings.BGColor);
-    if (SW1.held ^ SW2.held) LCD_gFillRect(LCD_WIDTH - paddleX - paddleThickness, p2Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, settings.BGColor);
+    if (JS.down || JS.up) LCD_gFillRect(paddleX, pg->p1Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, settings.BGColor);
+    if (SW1.held ^ SW2.held) LCD_gFillRect(LCD_WIDTH - paddleX - pg->paddleThickness, pg->p2Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, settings.BGColor);
 
         // Ball
-    if (!scored) LCD_gFillRect(ballPos.x - (ballSize.x >> 1), ballPos.y - (ballSize.y >> 1), ballSize.x, ballSize.y, settings.BGColor);
-    if (ballPos.y > LCD_HEIGHT - ballSize.y) LCD_gHLine(0, LCD_WIDTH, bottomBorder, 1, LCD_WHITE);
-    if (ballPos.y <= topBorder + ballSize.y)
+    if (!pg->scored)
     {
-        LCD_SetBGColor(LCD_WHITE);
-        LCD_gString(1, 0, scoreBoard[0], 0, LCD_BLACK);
-        LCD_SetBGColor(settings.BGColor);
+        LCD_gFillRect(pg->ballPos.x - (pg->ballSize.x >> 1), pg->ballPos.y - (pg->ballSize.y >> 1), pg->ballSize.x, pg->ballSize.y, settings.BGColor);
+        // Scoreboard cells the ball was erased from, if any
+        Text_Touch(&pg->hud, pg->ballPos.x - (pg->ballSize.x >> 1), pg->ballPos.y - (pg->ballSize.y >> 1),
+                   pg->ballSize.x, topBorder - (pg->ballPos.y - (pg->ballSize.y >> 1)));
     }
+    if (pg->ballPos.y > LCD_HEIGHT - pg->ballSize.y) LCD_gHLine(0, LCD_WIDTH, bottomBorder, 1, LCD_WHITE);
 
     // Move
         // Paddle player 1
     if (JS.down)
-        p1Pos = min(p1Pos + movSpeed, bottomBorder - (paddleWidth >> 1));
+        pg->p1Pos = min(pg->p1Pos + pg->movSpeed, bottomBorder - (pg->paddleWidth >> 1));
     else if (JS.up)
-        p1Pos = max(p1Pos - movSpeed, topBorder + (paddleWidth >> 1));
+        pg->p1Pos = max(pg->p1Pos - pg->movSpeed, topBorder + (pg->paddleWidth >> 1));
 
         // Paddle player 2
     if (SW1.held && !SW2.held)
-        p2Pos = max(p2Pos - movSpeed, topBorder + (paddleWidth >> 1));
+        pg->p2Pos = max(pg->p2Pos - pg->movSpeed, topBorder + (pg->paddleWidth >> 1));
     else if (!SW1.held && SW2.held)
-        p2Pos = min(p2Pos + movSpeed, bottomBorder - (paddleWidth >> 1));
+        pg->p2Pos = min(pg->p2Pos + pg->movSpeed, bottomBorder - (pg->paddleWidth >> 1));
 
         // Ball
     // Collisions
         // Goals
-    if (!scored)
+    if (!pg->scored)
     {
-        if (ballPos.x + ballSpeed.x - (ballSize.x >> 1) <= 0)
+        if (pg->ballPos.x + pg->ballSpeed.x - (pg->ballSize.x >> 1) <= 0)
         {
-            scored = scoredTimeout;
-            p2Score++;
-            ballSpeed.x = -ballSpeed.x;
+            pg->scored = scoredTimeout;
+            pg->p2Score++;
+            pg->ballSpeed.x = -pg->ballSpeed.x;
+            Audio_Play(1, pong_goal, 3, 0);
         }
-        else if (ballPos.x + ballSpeed.x + (ballSize.x >> 1) > LCD_WIDTH)
+        else if (pg->ballPos.x + pg->ballSpeed.x + (pg->ballSize.x >> 1) > LCD_WIDTH)
         {
-            scored = scoredTimeout;
-            p1Score++;
-            ballSpeed.x = -ballSpeed.x;
+            pg->scored = scoredTimeout;
+            pg->p1Score++;
+            pg->ballSpeed.x = -pg->ballSpeed.x;
+            Audio_Play(1, pong_goal, 3, 0);
         }
             // Top and bottom borders
-        if (ballPos.y + ballSpeed.y - (ballSize.y >> 1) <= topBorder ||
-            ballPos.y + ballSpeed.y + (ballSize.y >> 1) > bottomBorder)
-            ballSpeed.y = -ballSpeed.y;
+        if (pg->ballPos.y + pg->ballSpeed.y - (pg->ballSize.y >> 1) <= topBorder ||
+            pg->ballPos.y + pg->ballSpeed.y + (pg->ballSize.y >> 1) > bottomBorder)
+        {
+            pg->ballSpeed.y = -pg->ballSpeed.y;
+            Audio_NoteOn(0, 69);
+        }
 
             // P1 paddle
-        if (ballPos.x + ballSpeed.x - (ballSize.x >> 1) <= paddleX + paddleThickness &&
-            (ballPos.y + ballSpeed.y - (ballSize.y >> 1) <= p1Pos + (paddleWidth >> 1) &&
-            ballPos.y + ballSpeed.y + (ballSize.y >> 1) >= p1Pos - (paddleWidth >> 1)))
+        if (pg->ballPos.x + pg->ballSpeed.x - (pg->ballSize.x >> 1) <= paddleX + pg->paddleThickness &&
+            (pg->ballPos.y + pg->ballSpeed.y - (pg->ballSize.y >> 1) <= pg->p1Pos + (pg->paddleWidth >> 1) &&
+            pg->ballPos.y + pg->ballSpeed.y + (pg->ballSize.y >> 1) >= pg->p1Pos - (pg->paddleWidth >> 1)))
         {
-            ballSpeed.x = -ballSpeed.x;
-            ballSpeed.y = (ballPos.y - p1Pos) >> 1;
+            pg->ballSpeed.x = -pg->ballSpeed.x;
+            pg->ballSpeed.y = (pg->ballPos.y - pg->p1Pos) >> 1;
+            Audio_NoteOn(0, 81);
         }
             // P2 paddle
-        if (ballPos.x + ballSpeed.x + (ballSize.x >> 1) > LCD_WIDTH - paddleX - paddleThickness &&
-            (ballPos.y + ballSpeed.y - (ballSize.y >> 1) <= p2Pos + (paddleWidth >> 1) &&
-            ballPos.y + ballSpeed.y + (ballSize.y >> 1) >= p2Pos - (paddleWidth >> 1)))
+        if (pg->ballPos.x + pg->ballSpeed.x + (pg->ballSize.x >> 1) > LCD_WIDTH - paddleX - pg->paddleThickness &&
+            (pg->ballPos.y + pg->ballSpeed.y - (pg->ballSize.y >> 1) <= pg->p2Pos + (pg->paddleWidth >> 1) &&
+            pg->ballPos.y + pg->ballSpeed.y + (pg->ballSize.y >> 1) >= pg->p2Pos - (pg->paddleWidth >> 1)))
         {
-            ballSpeed.x = -ballSpeed.x;
-            ballSpeed.y = (ballPos.y - p2Pos) >> 1;
+            pg->ballSpeed.x = -pg->ballSpeed.x;
+            pg->ballSpeed.y = (pg->ballPos.y - pg->p2Pos) >> 1;
+            Audio_NoteOn(0, 81);
         }
 
-        ballPos.x += ballSpeed.x;
-        ballPos.y += ballSpeed.y;
+        pg->ballPos.x += pg->ballSpeed.x;
+        pg->ballPos.y += pg->ballSpeed.y;
     }
 
     // Draw  if moved
         // Paddles
-    if (JS.down || JS.up) LCD_gFillRect(paddleX, p1Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, LCD_LIGHT_GREY);
-    if (SW1.held ^ SW2.held) LCD_gFillRect(LCD_WIDTH - paddleX - paddleThickness, p2Pos - (paddleWidth >> 1), paddleThickness, paddleWidth, LCD_LIGHT_GREY);
+    if (JS.down || JS.up) LCD_gFillRect(paddleX, pg->p1Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, LCD_LIGHT_GREY);
+    if (SW1.held ^ SW2.held) LCD_gFillRect(LCD_WIDTH - paddleX - pg->paddleThickness, pg->p2Pos - (pg->paddleWidth >> 1), pg->paddleThickness, pg->paddleWidth, LCD_LIGHT_GREY);
 
         // Ball
-    if (scored != scoredTimeout) LCD_gFillRect(ballPos.x - (ballSize.x >> 1), ballPos.y - (ballSize.y >> 1), ballSize.x, ballSize.y, LCD_LIGHT_GREY);
+    if (pg->scored != scoredTimeout) LCD_gFillRect(pg->ballPos.x - (pg->ballSize.x >> 1), pg->ballPos.y - (pg->ballSize.y >> 1), pg->ballSize.x, pg->ballSize.y, LCD_LIGHT_GREY);
+
+        // Scoreboard, nothing is sent unless a score changed or the ball went over it
+    Text_Flush(&pg->hud);
 
     return 1;
 }
@@ -648,6 +659,7 @@ int main()
     GE_Setup();
 
     GE_SetMainMenu(menu);
+    GE_SetMainMenuInit(menu_init);
 
     GE_Loop();
 }
@@ -0,0 +1,269 @@
+#include "mirror.h"
+#include "dma.h"
+#include "tiva-gc-inc.h"
+#include "inc/tm4c123gh6pm.h"
+
+// Longest run a single packet can hold
+#define MIRROR_RUN_MAX 64
+
+// The UART interrupt is masked while a transfer is started from the game side
+#define MIRROR_LOCK()   (NVIC_DIS0_R = 1 << 5)
+#define MIRROR_UNLOCK() (NVIC_EN0_R = 1 << 5)
+
+uint8_t Mirror_Enabled = 0;
+
+static uint8_t _buffer[MIRROR_BUFFER];
+static uint16_t _head = 0;                      // written by the game
+static volatile uint16_t _tail = 0;             // written by the interrupt
+static volatile uint16_t _sending = 0;          // bytes in the running transfer
+static uint32_t _dropped = 0;
+
+// Encoder state, colors are packed as r << 12 | g << 6 | b
+static uint32_t _run = 0, _colorA = 0, _colorB = 0;
+static uint8_t _runLength = 0;
+static uint8_t _frame = 0;
+
+// Current window, and the area lost since the last frame. _dropping is set once a write of
+// the current window is lost, as the host cannot place any later pixel of it
+static uint8_t _window[4];
+static uint8_t _lost[4];
+static uint8_t _hasLost = 0, _dropping = 0;
+
+static void Mirror_Kick(void);
+static uint8_t Mirror_Put(const uint8_t *data, uint8_t n);
+static void Mirror_Lose(void);
+static void Mirror_FlushRun(void);
+
+// Start sending the oldest buffered bytes, if no transfer is running
+static void Mirror_Kick(void)
+{
+    uint16_t head = _head, tail = _tail, len;
+
+    if (_sending || head == tail)
+        return;
+
+    // Up to the end of the buffer, the rest goes in the next transfer
+    len = (head > tail) ? head - tail : MIRROR_BUFFER - tail;
+    if (len > DMA_MAX_ITEMS)
+        len = DMA_MAX_ITEMS;
+
+    _sending = len;
+    DMA_SendBytes(DMA_CH_UART0_TX, &_buffer[tail], &UART0_DR_R, len);
+}
+
+// Add a packet to the buffer, whole or not at all
+//  Return:
+//      1 if added, 0 if there was no room
+static uint8_t Mirror_Put(const uint8_t *data, uint8_t n)
+{
+    uint16_t head = _head;
+    uint16_t room = (_tail - head - 1) & (MIRROR_BUFFER - 1);
+
+    if (n > room)
+    {
+        _dropped += n;
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        _buffer[head] = data[i];
+        head = (head + 1) & (MIRROR_BUFFER - 1);
+    }
+    _head = head;
+
+    if (!_sending)
+    {
+        MIRROR_LOCK();
+        Mirror_Kick();
+        MIRROR_UNLOCK();
+    }
+    return 1;
+}
+
+// Drop the rest of the current window and add it to the lost area
+static void Mirror_Lose(void)
+{
+    _dropping = 1;
+    _runLength = 0;
+
+    if (!_hasLost)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+            _lost[i] = _window[i];
+        _hasLost = 1;
+        return;
+    }
+    _lost[0] = min(_lost[0], _window[0]);
+    _lost[1] = min(_lost[1], _window[1]);
+    _lost[2] = max(_lost[2], _window[2]);
+    _lost[3] = max(_lost[3], _window[3]);
+}
+
+// Encode the pending run of pixels
+// A and B only change once the packet is in the buffer, so they always match the host's
+static void Mirror_FlushRun(void)
+{
+    uint8_t packet[4];
+    uint8_t n = _runLength - 1;
+
+    if (!_runLength)
+        return;
+    _runLength = 0;
+
+    if (_run == _colorA)
+    {
+        packet[0] = MIRROR_RUN_A | n;
+        if (!Mirror_Put(packet, 1))
+            Mirror_Lose();
+    }
+    else if (_run == _colorB)
+    {
+        packet[0] = MIRROR_RUN_B | n;
+        if (Mirror_Put(packet, 1))
+        {
+            _colorB = _colorA;
+            _colorA = _run;
+        }
+        else
+            Mirror_Lose();
+    }
+    else
+    {
+        packet[0] = MIRROR_RUN_NEW | n;
+        packet[1] = (_run >> 12) & 0x3F;
+        packet[2] = (_run >> 6) & 0x3F;
+        packet[3] = _run & 0x3F;
+        if (Mirror_Put(packet, 4))
+        {
+            _colorB = _colorA;
+            _colorA = _run;
+        }
+        else
+            Mirror_Lose();
+    }
+}
+
+// Set up UART0 and uDMA and start mirroring. The LCD should be cleared afterwards, so the
+// host starts from a known screen
+void Mirror_Init(void)
+{
+    // 64 * clock / (16 * baud), rounded. Integer part in bits [21:6], fraction in [5:0]
+    uint32_t div = (CLOCKS_PER_SEC * 4 + MIRROR_BAUD / 2) / MIRROR_BAUD;
+
+    SYSCTL_RCGCUART_R |= 0x01;
+    SYSCTL_RCGCGPIO_R |= 0x01;
+    while (!(SYSCTL_PRUART_R & 0x01));
+    while (!(SYSCTL_PRGPIO_R & 0x01));
+
+    // PA0 and PA1 as U0Rx and U0Tx
+    GPIO_PORTA_AFSEL_R |= 0x03;
+    GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R & ~0x000000FF) | 0x00000011;
+    GPIO_PORTA_AMSEL_R &= ~0x03;
+    GPIO_PORTA_DEN_R |= 0x03;
+
+    UART0_CTL_R = 0;
+    UART0_IBRD_R = div >> 6;
+    UART0_FBRD_R = div & 0x3F;
+    UART0_LCRH_R = 0x70;                    // 8 bits, no parity, 1 stop bit, FIFOs on
+    UART0_CC_R = 0;                         // System clock
+    UART0_DMACTL_R = 0x02;                  // uDMA requests for transmit
+    UART0_CTL_R = 0x301;                    // UART, transmit and receive enabled
+
+    DMA_Init();
+    NVIC_EN0_R = 1 << 5;                    // UART0 is interrupt 5
+
+    Mirror_Enabled = 1;
+    Mirror_Frame();                         // lets the host sync from the first byte
+}
+
+// Record a window set on the LCD, called by LCD_SetArea
+//  Param:
+//      x0, y0, x1, y1: window corners, inclusive and already clipped to the screen
+void Mirror_Area(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    uint8_t packet[5] = { MIRROR_WINDOW, x0, y0, x1, y1 };
+
+    Mirror_FlushRun();
+
+    _window[0] = x0;
+    _window[1] = y0;
+    _window[2] = x1;
+    _window[3] = y1;
+    _dropping = 0;
+    if (!Mirror_Put(packet, 5))
+        Mirror_Lose();
+}
+
+// Record a pixel sent to the LCD, called by LCD_PushPixel
+//  Param:
+//      red, green, blue: color value. Bits [5:0] are used
+void Mirror_Pixel(uint8_t red, uint8_t green, uint8_t blue)
+{
+    uint32_t color = ((uint32_t) (red & 0x3F) << 12) | ((green & 0x3F) << 6) | (blue & 0x3F);
+
+    if (_dropping)
+        return;
+
+    if (_runLength && color == _run && _runLength < MIRROR_RUN_MAX)
+    {
+        _runLength++;
+        return;
+    }
+
+    Mirror_FlushRun();
+    if (_dropping)
+        return;
+    _run = color;
+    _runLength = 1;
+}
+
+// Mark the end of a frame and start sending what is buffered, called by GE_Loop
+void Mirror_Frame(void)
+{
+    uint8_t packet[5];
+
+    if (!Mirror_Enabled)
+        return;
+
+    Mirror_FlushRun();
+
+    if (_hasLost)
+    {
+        packet[0] = MIRROR_LOST;
+        for (uint8_t i = 0; i < 4; i++)
+            packet[i + 1] = _lost[i];
+        if (Mirror_Put(packet, 5))
+            _hasLost = 0;
+    }
+
+    packet[0] = MIRROR_FRAME;
+    packet[1] = 0x5A;
+    packet[2] = 0xA5;
+    packet[3] = _frame;
+    if (Mirror_Put(packet, 4))
+    {
+        _frame++;
+        _colorA = _colorB = 0;
+    }
+}
+
+// Get how many bytes were dropped because the buffer was full
+//  Return:
+//      bytes dropped since Mirror_Init
+uint32_t Mirror_Dropped(void)
+{
+    return _dropped;
+}
+
+// UART0 interrupt handler, set in startup_gcc.c. Runs when a uDMA transfer ends
+void Mirror_UARTISR(void)
+{
+    UDMA_CHIS_R = 1u << DMA_CH_UART0_TX;
+    if (DMA_Busy(DMA_CH_UART0_TX))
+        return;
+
+    _tail = (_tail + _sending) & (MIRROR_BUFFER - 1);
+    _sending = 0;
+    Mirror_Kick();
+}
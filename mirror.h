@@ -0,0 +1,71 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+/*
+    Screen mirroring over UART0, the LaunchPad's virtual COM port. Everything sent to the LCD
+    through LCD_SetArea and LCD_PushPixel is also encoded into a buffer, which uDMA sends out
+    in the background. There is no copy of the screen on the board, only the writes are sent,
+    so a frame costs as many bytes as the engine redraws, not the whole screen. Pixels are run
+    length encoded, and runs of the last two colors used take a single byte, which suits text
+    and flat fills.
+
+    tools/mirrorview.c rebuilds the screen on the host and saves frames as PPM images.
+
+    The LCD functions, the engine and the vector table only call into this module in builds
+    with GE_MIRROR defined, so other builds leave out its buffer and interrupt handler.
+
+    When the buffer is full the writes of the current window are dropped, so the game never
+    waits on the UART. The area that was lost is reported in the next frame marker and stays
+    stale on the host until the game redraws it.
+
+    Stream format, every packet starts with one byte:
+        00nnnnnn            n + 1 pixels of color A, the last color used
+        01nnnnnn            n + 1 pixels of color B, the color used before A. A and B swap
+        10nnnnnn r g b      n + 1 pixels of a new color, 6 bits per channel. B = A, A = new
+        0xC0 x0 y0 x1 y1    window, the next pixels fill it row by row from x0, y0
+        0xC1 x0 y0 x1 y1    writes inside the area were lost
+        0xC2 0x5A 0xA5 n    end of frame n (0 - 255). A and B are reset to black, so a viewer
+                            can start decoding after any frame marker
+*/
+
+#include <stdint.h>
+
+#define MIRROR_BAUD   115200
+#define MIRROR_BUFFER 2048     // power of two
+
+#define MIRROR_RUN_A   0x00
+#define MIRROR_RUN_B   0x40
+#define MIRROR_RUN_NEW 0x80
+#define MIRROR_WINDOW  0xC0
+#define MIRROR_LOST    0xC1
+#define MIRROR_FRAME   0xC2
+
+// Nonzero once Mirror_Init has run, checked by the LCD functions before encoding a write
+extern uint8_t Mirror_Enabled;
+
+// Set up UART0 and uDMA and start mirroring. The LCD should be cleared afterwards, so the
+// host starts from a known screen
+void Mirror_Init(void);
+
+// Record a window set on the LCD, called by LCD_SetArea
+//  Param:
+//      x0, y0, x1, y1: window corners, inclusive and already clipped to the screen
+void Mirror_Area(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+
+// Record a pixel sent to the LCD, called by LCD_PushPixel
+//  Param:
+//      red, green, blue: color value. Bits [5:0] are used
+void Mirror_Pixel(uint8_t red, uint8_t green, uint8_t blue);
+
+// Mark the end of a frame and start sending what is buffered, called by GE_Loop
+void Mirror_Frame(void);
+
+// Get how many bytes were dropped because the buffer was full
+//  Return:
+//      bytes dropped since Mirror_Init
+uint32_t Mirror_Dropped(void);
+
+// UART0 interrupt handler, set in startup_gcc.c. Runs when a uDMA transfer ends
+void Mirror_UARTISR(void);
+
+#endif // MIRROR_H
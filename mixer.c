@@ -0,0 +1,273 @@
+#include "mixer.h"
+
+#define MIXER_OFF     0
+#define MIXER_ATTACK  1
+#define MIXER_DECAY   2
+#define MIXER_SUSTAIN 3
+#define MIXER_RELEASE 4
+
+// Frequencies of the notes in MIDI octave 9 (C9 - B9), in mHz
+static const uint32_t mixer_octave[12] = {
+    8372018, 8869844, 9397273, 9956063, 10548082, 11175303,
+    11839822, 12543854, 13289750, 14080000, 14917240, 15804266
+};
+
+static uint32_t Mixer_EnvelopeStep(Mixer *mixer, uint32_t range, uint16_t ms);
+static int32_t Mixer_VoiceNext(Mixer_Voice *v);
+static void Mixer_SeqNext(Mixer *mixer, uint8_t voice);
+
+// Envelope step per sample to cover range in ms
+static uint32_t Mixer_EnvelopeStep(Mixer *mixer, uint32_t range, uint16_t ms)
+{
+    uint32_t samples = (uint32_t) ((uint64_t) mixer->rate * ms / 1000);
+
+    if (!samples)
+        return range ? range : 1;
+    return range / samples + 1;
+}
+
+// Set up a mixer, with every voice silent
+//  Param:
+//      mixer: mixer
+//      rate: sample rate in Hz
+void Mixer_Init(Mixer *mixer, uint32_t rate)
+{
+    mixer->rate = rate;
+    for (uint8_t i = 0; i < 12; i++)
+        mixer->octaveSteps[i] = (uint32_t) (((uint64_t) mixer_octave[i] << 32) / ((uint64_t) rate * 1000));
+
+    for (uint8_t i = 0; i < MIXER_VOICES; i++)
+    {
+        Mixer_Voice *v = &mixer->voices[i];
+        v->phase = 0;
+        v->step = 0;
+        v->noise = 0xACE1u + i;
+        v->stage = MIXER_OFF;
+        v->level = 0;
+        v->seq = 0;
+        v->seqLen = 0;
+        v->seqPos = 0;
+        v->loop = 0;
+        v->samplesLeft = 0;
+        Mixer_SetVoice(mixer, i, MIXER_SQUARE, 128);
+        Mixer_SetEnvelope(mixer, i, 5, 50, 160, 80);
+    }
+    Mixer_SetTempo(mixer, 120, 4);
+}
+
+// Set the waveform and volume of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      wave: waveform
+//      volume: 0 - 255
+void Mixer_SetVoice(Mixer *mixer, uint8_t voice, Mixer_Wave wave, uint8_t volume)
+{
+    mixer->voices[voice].wave = wave;
+    mixer->voices[voice].volume = volume;
+}
+
+// Set the envelope of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      attack: time to reach full level after a note starts, in ms
+//      decay: time to go down from full level to the sustain level, in ms
+//      sustain: level held while the note plays, 0 - 255. 0 makes every note a one-shot
+//      release: time to go silent after the note ends, in ms
+void Mixer_SetEnvelope(Mixer *mixer, uint8_t voice, uint16_t attack, uint16_t decay,
+                       uint8_t sustain, uint16_t release)
+{
+    Mixer_Voice *v = &mixer->voices[voice];
+
+    v->sustainLevel = (uint32_t) sustain << 16;
+    v->attackStep = Mixer_EnvelopeStep(mixer, MIXER_LEVEL_MAX, attack);
+    v->decayStep = Mixer_EnvelopeStep(mixer, MIXER_LEVEL_MAX - v->sustainLevel, decay);
+    v->releaseStep = Mixer_EnvelopeStep(mixer, MIXER_LEVEL_MAX, release);
+}
+
+// Set the length of a sequence tick
+//  Param:
+//      mixer: mixer
+//      bpm: beats per minute
+//      ticksPerBeat: ticks in a beat
+void Mixer_SetTempo(Mixer *mixer, uint16_t bpm, uint8_t ticksPerBeat)
+{
+    mixer->tickSamples = mixer->rate * 60 / ((uint32_t) bpm * ticksPerBeat);
+}
+
+// Start a note on a voice
+// The envelope starts again from the level the voice is at, so there is no click
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      note: MIDI note number, up to 131
+void Mixer_NoteOn(Mixer *mixer, uint8_t voice, uint8_t note)
+{
+    Mixer_Voice *v = &mixer->voices[voice];
+
+    if (note > 131)
+        note = 131;
+    v->step = mixer->octaveSteps[note % 12] >> (10 - note / 12);
+    v->stage = MIXER_ATTACK;
+}
+
+// Release the note of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+void Mixer_NoteOff(Mixer *mixer, uint8_t voice)
+{
+    if (mixer->voices[voice].stage != MIXER_OFF)
+        mixer->voices[voice].stage = MIXER_RELEASE;
+}
+
+// Play a sequence of notes on a voice, replacing the one it was playing
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      seq: notes, must stay valid while they play. NULL stops the sequence
+//      len: number of notes
+//      loop: 1 to start over at the end
+void Mixer_Play(Mixer *mixer, uint8_t voice, const Mixer_Note *seq, uint16_t len, uint8_t loop)
+{
+    Mixer_Voice *v = &mixer->voices[voice];
+
+    v->seq = seq;
+    v->seqLen = len;
+    v->seqPos = 0;
+    v->loop = loop;
+    v->samplesLeft = 0;     // first note starts on the next sample
+    if (!seq)
+        Mixer_NoteOff(mixer, voice);
+}
+
+// Move a voice to the next note of its sequence
+static void Mixer_SeqNext(Mixer *mixer, uint8_t voice)
+{
+    Mixer_Voice *v = &mixer->voices[voice];
+    const Mixer_Note *n;
+
+    if (v->seqPos == v->seqLen)
+    {
+        if (!v->loop || !v->seqLen)
+        {
+            v->seq = 0;
+            Mixer_NoteOff(mixer, voice);
+            return;
+        }
+        v->seqPos = 0;
+    }
+
+    n = &v->seq[v->seqPos++];
+    v->samplesLeft = n->length * mixer->tickSamples;
+    if (n->note)
+        Mixer_NoteOn(mixer, voice, n->note);
+    else
+        Mixer_NoteOff(mixer, voice);
+}
+
+// Next sample of a voice, -127 - 127 scaled by envelope and volume
+static int32_t Mixer_VoiceNext(Mixer_Voice *v)
+{
+    int32_t s;
+    uint32_t old = v->phase;
+
+    // Envelope
+    switch (v->stage)
+    {
+    case MIXER_OFF:
+        return 0;
+    case MIXER_ATTACK:
+        v->level += v->attackStep;
+        if (v->level >= MIXER_LEVEL_MAX)
+        {
+            v->level = MIXER_LEVEL_MAX;
+            v->stage = MIXER_DECAY;
+        }
+        break;
+    case MIXER_DECAY:
+        if (v->level <= v->sustainLevel + v->decayStep)
+        {
+            v->level = v->sustainLevel;
+            v->stage = MIXER_SUSTAIN;
+        }
+        else
+            v->level -= v->decayStep;
+        break;
+    case MIXER_SUSTAIN:
+        break;
+    case MIXER_RELEASE:
+        if (v->level <= v->releaseStep)
+        {
+            v->level = 0;
+            v->stage = MIXER_OFF;
+        }
+        else
+            v->level -= v->releaseStep;
+        break;
+    }
+
+    // Oscillator
+    v->phase += v->step;
+    switch (v->wave)
+    {
+    case MIXER_SQUARE:
+        s = (v->phase & 0x80000000) ? 127 : -127;
+        break;
+    case MIXER_TRIANGLE:
+        s = v->phase >> 23;                         // 0 - 511
+        s = (s < 256) ? s - 128 : 383 - s;
+        break;
+    case MIXER_SAW:
+        s = (int32_t) (v->phase >> 24) - 128;
+        break;
+    default:
+        // New random value every period, 16-bit Galois LFSR
+        if (v->phase < old)
+            v->noise = (v->noise >> 1) ^ (-(v->noise & 1) & 0xB400u);
+        s = (v->noise & 1) ? 127 : -127;
+        break;
+    }
+
+    return (s * (int32_t) (v->level >> 16) * v->volume) >> 16;
+}
+
+// Generate the next sample
+//  Param:
+//      mixer: mixer
+//  Return:
+//      sample, 0 - 255 with silence at 128
+uint8_t Mixer_Next(Mixer *mixer)
+{
+    int32_t mix = 0;
+
+    for (uint8_t i = 0; i < MIXER_VOICES; i++)
+    {
+        Mixer_Voice *v = &mixer->voices[i];
+
+        if (v->seq && !v->samplesLeft--)
+            Mixer_SeqNext(mixer, i);
+        mix += Mixer_VoiceNext(v);
+    }
+
+    // Two voices at full volume fill the range, more than that clips
+    mix >>= 1;
+    if (mix > 127)
+        mix = 127;
+    else if (mix < -128)
+        mix = -128;
+
+    return mix + 128;
+}
+
+// Generate a block of samples
+//  Param:
+//      mixer: mixer
+//      out: where to write the samples
+//      n: number of samples
+void Mixer_Render(Mixer *mixer, uint8_t *out, uint32_t n)
+{
+    while (n--)
+        *out++ = Mixer_Next(mixer);
+}
@@ -0,0 +1,130 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+/*
+    Sound mixer. Generates 8-bit unsigned samples from a few voices, each one an oscillator
+    with an envelope, optionally driven by a note sequence. Everything done per sample is
+    integer math with no divisions, so the time to make a sample is small and bounded;
+    divisions only happen when voices are set up.
+
+    Does not touch any hardware, so it can be built for the host as well, see tools/mixwav.c.
+*/
+
+#include <stdint.h>
+
+#define MIXER_VOICES 4
+
+// Envelope level of a voice at full volume
+#define MIXER_LEVEL_MAX (1 << 24)
+
+typedef enum Mixer_Wave
+{
+    MIXER_SQUARE,
+    MIXER_TRIANGLE,
+    MIXER_SAW,
+    MIXER_NOISE
+} Mixer_Wave;
+
+// Note of a sequence
+typedef struct Mixer_Note
+{
+    uint8_t note;       // MIDI note number, 69 is A4 (440 Hz). 0 is a rest
+    uint8_t length;     // length in ticks, see Mixer_SetTempo
+} Mixer_Note;
+
+typedef struct Mixer_Voice
+{
+    // Oscillator
+    uint32_t phase, step;
+    uint8_t wave, volume;
+    uint32_t noise;
+
+    // Envelope, levels go from 0 to MIXER_LEVEL_MAX
+    uint8_t stage;
+    uint32_t level;
+    uint32_t attackStep, decayStep, releaseStep, sustainLevel;
+
+    // Sequence
+    const Mixer_Note *seq;
+    uint16_t seqLen, seqPos;
+    uint8_t loop;
+    uint32_t samplesLeft;
+} Mixer_Voice;
+
+typedef struct Mixer
+{
+    Mixer_Voice voices[MIXER_VOICES];
+    uint32_t rate;
+    uint32_t tickSamples;
+    uint32_t octaveSteps[12];   // oscillator steps of the notes in MIDI octave 9
+} Mixer;
+
+// Set up a mixer, with every voice silent
+//  Param:
+//      mixer: mixer
+//      rate: sample rate in Hz
+void Mixer_Init(Mixer *mixer, uint32_t rate);
+
+// Set the waveform and volume of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      wave: waveform
+//      volume: 0 - 255
+void Mixer_SetVoice(Mixer *mixer, uint8_t voice, Mixer_Wave wave, uint8_t volume);
+
+// Set the envelope of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      attack: time to reach full level after a note starts, in ms
+//      decay: time to go down from full level to the sustain level, in ms
+//      sustain: level held while the note plays, 0 - 255. 0 makes every note a one-shot
+//      release: time to go silent after the note ends, in ms
+void Mixer_SetEnvelope(Mixer *mixer, uint8_t voice, uint16_t attack, uint16_t decay,
+                       uint8_t sustain, uint16_t release);
+
+// Set the length of a sequence tick
+//  Param:
+//      mixer: mixer
+//      bpm: beats per minute
+//      ticksPerBeat: ticks in a beat
+void Mixer_SetTempo(Mixer *mixer, uint16_t bpm, uint8_t ticksPerBeat);
+
+// Start a note on a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      note: MIDI note number, up to 131
+void Mixer_NoteOn(Mixer *mixer, uint8_t voice, uint8_t note);
+
+// Release the note of a voice
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+void Mixer_NoteOff(Mixer *mixer, uint8_t voice);
+
+// Play a sequence of notes on a voice, replacing the one it was playing
+//  Param:
+//      mixer: mixer
+//      voice: voice (0 - MIXER_VOICES - 1)
+//      seq: notes, must stay valid while they play. NULL stops the sequence
+//      len: number of notes
+//      loop: 1 to start over at the end
+void Mixer_Play(Mixer *mixer, uint8_t voice, const Mixer_Note *seq, uint16_t len, uint8_t loop);
+
+// Generate the next sample
+//  Param:
+//      mixer: mixer
+//  Return:
+//      sample, 0 - 255 with silence at 128
+uint8_t Mixer_Next(Mixer *mixer);
+
+// Generate a block of samples
+//  Param:
+//      mixer: mixer
+//      out: where to write the samples
+//      n: number of samples
+void Mixer_Render(Mixer *mixer, uint8_t *out, uint32_t n);
+
+#endif // MIXER_H
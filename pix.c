@@ -0,0 +1,413 @@
+#include "pix.h"
+
+/* SIMD instructions
+ * On the M4 each one is a single instruction. The C versions give the same results, so the
+ * kernels can be checked on the host
+ */
+
+#if defined(__ARM_FEATURE_SIMD32)
+
+// Average of each byte, rounded down
+static inline uint32_t Pix_Uhadd8(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+    __asm ("uhadd8 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+// Sum of each byte, saturating at 255
+static inline uint32_t Pix_Uqadd8(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+    __asm ("uqadd8 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+// acc + products of the signed halfwords of a and b
+static inline int32_t Pix_Smlad(uint32_t a, uint32_t b, int32_t acc)
+{
+    int32_t r;
+    __asm ("smlad %0, %1, %2, %3" : "=r" (r) : "r" (a), "r" (b), "r" (acc));
+    return r;
+}
+
+// Bottom halfword of lo, bottom halfword of hi on top
+static inline uint32_t Pix_Pkhbt(uint32_t lo, uint32_t hi)
+{
+    uint32_t r;
+    __asm ("pkhbt %0, %1, %2, lsl #16" : "=r" (r) : "r" (lo), "r" (hi));
+    return r;
+}
+
+// Top halfword of hi, top halfword of lo at the bottom
+static inline uint32_t Pix_Pkhtb(uint32_t hi, uint32_t lo)
+{
+    uint32_t r;
+    __asm ("pkhtb %0, %1, %2, asr #16" : "=r" (r) : "r" (hi), "r" (lo));
+    return r;
+}
+
+// Bytes of src that are not 0, bytes of dst elsewhere. UADD8 with 0xFF carries out of every
+// byte that is not 0, setting its GE flag, and SEL picks bytes by those flags
+static inline uint32_t Pix_Select8(uint32_t src, uint32_t dst)
+{
+    uint32_t r;
+    __asm ("uadd8 %0, %1, %3\n\t"
+           "sel %0, %1, %2" : "=&r" (r) : "r" (src), "r" (dst), "r" (0xFFFFFFFF));
+    return r;
+}
+
+#else
+
+static inline uint32_t Pix_Uhadd8(uint32_t a, uint32_t b)
+{
+    uint32_t r = 0;
+    for (uint8_t i = 0; i < 32; i += 8)
+        r |= ((((a >> i) & 0xFF) + ((b >> i) & 0xFF)) >> 1) << i;
+    return r;
+}
+
+static inline uint32_t Pix_Uqadd8(uint32_t a, uint32_t b)
+{
+    uint32_t r = 0;
+    for (uint8_t i = 0; i < 32; i += 8)
+    {
+        uint32_t s = ((a >> i) & 0xFF) + ((b >> i) & 0xFF);
+        r |= (s > 0xFF ? 0xFF : s) << i;
+    }
+    return r;
+}
+
+static inline int32_t Pix_Smlad(uint32_t a, uint32_t b, int32_t acc)
+{
+    return acc + (int16_t) a * (int16_t) b + (int16_t) (a >> 16) * (int16_t) (b >> 16);
+}
+
+static inline uint32_t Pix_Pkhbt(uint32_t lo, uint32_t hi)
+{
+    return (lo & 0xFFFF) | (hi << 16);
+}
+
+static inline uint32_t Pix_Pkhtb(uint32_t hi, uint32_t lo)
+{
+    return (hi & 0xFFFF0000) | (lo >> 16);
+}
+
+static inline uint32_t Pix_Select8(uint32_t src, uint32_t dst)
+{
+    uint32_t r = 0;
+    for (uint8_t i = 0; i < 32; i += 8)
+        r |= (((src >> i) & 0xFF) ? (src >> i) & 0xFF : (dst >> i) & 0xFF) << i;
+    return r;
+}
+
+#endif
+
+/* Kernels
+ */
+
+// Fill 16-bit pixels with a color
+//  Param:
+//      dst: pixels
+//      color: RGB565 color
+//      n: number of pixels
+void Pix_Fill16(uint16_t *dst, uint16_t color, uint32_t n)
+{
+    uint32_t pair = Pix_Pkhbt(color, color);
+    Pix_Word *d;
+
+    if (((uintptr_t) dst & 2) && n)
+    {
+        *dst++ = color;
+        n--;
+    }
+
+    d = (Pix_Word *) dst;
+    for (; n >= 8; n -= 8)
+    {
+        d[0] = pair;
+        d[1] = pair;
+        d[2] = pair;
+        d[3] = pair;
+        d += 4;
+    }
+    for (; n >= 2; n -= 2)
+        *d++ = pair;
+
+    if (n)
+        *(uint16_t *) d = color;
+}
+
+// Fill 24-bit pixels with a color
+//  Param:
+//      dst: pixels, 3 bytes each
+//      color: encoded color
+//      n: number of pixels
+void Pix_Fill24(uint8_t *dst, LCD_Color color, uint32_t n)
+{
+    uint32_t r = color & 0xFF, g = (color >> 8) & 0xFF, b = (color >> 16) & 0xFF;
+    // 4 pixels are 3 words: RGBR GBRG BRGB
+    uint32_t w0 = r | (g << 8) | (b << 16) | (r << 24);
+    uint32_t w1 = g | (b << 8) | (r << 16) | (g << 24);
+    uint32_t w2 = b | (r << 8) | (g << 16) | (b << 24);
+    Pix_Word *d = (Pix_Word *) dst;
+
+    for (; n >= 4; n -= 4)
+    {
+        d[0] = w0;
+        d[1] = w1;
+        d[2] = w2;
+        d += 3;
+    }
+
+    dst = (uint8_t *) d;
+    while (n--)
+    {
+        *dst++ = r;
+        *dst++ = g;
+        *dst++ = b;
+    }
+}
+
+// Convert 16-bit pixels to 24-bit pixels
+// 5-bit channels are widened to 6 bits by repeating their top bit
+//  Param:
+//      dst: 24-bit pixels
+//      src: 16-bit pixels
+//      n: number of pixels
+void Pix_16To24(uint8_t *dst, const uint16_t *src, uint32_t n)
+{
+    while (n--)
+    {
+        uint32_t c = *src++;
+        uint32_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+
+        *dst++ = ((r << 1) | (r >> 4)) << 2;
+        *dst++ = g << 2;
+        *dst++ = ((b << 1) | (b >> 4)) << 2;
+    }
+}
+
+// Convert 24-bit pixels to 16-bit pixels, dropping the low bit of red and blue
+//  Param:
+//      dst: 16-bit pixels
+//      src: 24-bit pixels
+//      n: number of pixels
+void Pix_24To16(uint16_t *dst, const uint8_t *src, uint32_t n)
+{
+    Pix_Word *d;
+
+    if (((uintptr_t) dst & 2) && n)
+    {
+        *dst++ = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+        src += 3;
+        n--;
+    }
+
+    // Two pixels per word written
+    d = (Pix_Word *) dst;
+    for (; n >= 2; n -= 2)
+    {
+        uint32_t p0 = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+        uint32_t p1 = ((src[3] & 0xF8) << 8) | ((src[4] & 0xFC) << 3) | (src[5] >> 3);
+
+        *d++ = Pix_Pkhbt(p0, p1);
+        src += 6;
+    }
+
+    if (n)
+        *(uint16_t *) d = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+}
+
+// Look up 8-bit palette indices
+//  Param:
+//      dst: 16-bit pixels
+//      src: palette indices
+//      palette: RGB565 colors
+//      n: number of pixels
+void Pix_Expand16(uint16_t *dst, const uint8_t *src, const uint16_t *palette, uint32_t n)
+{
+    Pix_Word *d;
+
+    if (((uintptr_t) dst & 2) && n)
+    {
+        *dst++ = palette[*src++];
+        n--;
+    }
+
+    d = (Pix_Word *) dst;
+    for (; n >= 4; n -= 4)
+    {
+        d[0] = Pix_Pkhbt(palette[src[0]], palette[src[1]]);
+        d[1] = Pix_Pkhbt(palette[src[2]], palette[src[3]]);
+        d += 2;
+        src += 4;
+    }
+
+    dst = (uint16_t *) d;
+    while (n--)
+        *dst++ = palette[*src++];
+}
+
+// Look up 8-bit palette indices, writing each pixel twice, for 2x horizontal scaling
+//  Param:
+//      dst: 16-bit pixels, 2 * n of them, 4-byte aligned
+//      src: palette indices
+//      palette: RGB565 colors
+//      n: number of palette indices
+void Pix_Expand16x2(uint16_t *dst, const uint8_t *src, const uint16_t *palette, uint32_t n)
+{
+    Pix_Word *d = (Pix_Word *) dst;
+
+    for (; n >= 4; n -= 4)
+    {
+        uint32_t c0 = palette[src[0]], c1 = palette[src[1]];
+        uint32_t c2 = palette[src[2]], c3 = palette[src[3]];
+
+        d[0] = Pix_Pkhbt(c0, c0);
+        d[1] = Pix_Pkhbt(c1, c1);
+        d[2] = Pix_Pkhbt(c2, c2);
+        d[3] = Pix_Pkhbt(c3, c3);
+        d += 4;
+        src += 4;
+    }
+    while (n--)
+    {
+        uint32_t c = palette[*src++];
+        *d++ = Pix_Pkhbt(c, c);
+    }
+}
+
+// Average of two runs of 16-bit pixels, rounded down in each channel
+// Two pixels per word: the low bit of every channel is cleared before the shift, so no bit
+// moves into the channel below
+//  Param:
+//      dst: result, can be a or b
+//      a, b: pixels
+//      n: number of pixels
+void Pix_Blend16(uint16_t *dst, const uint16_t *a, const uint16_t *b, uint32_t n)
+{
+    if (((uintptr_t) dst & 2) && n)
+    {
+        *dst++ = (*a & *b) + (((*a ^ *b) & 0xF7DE) >> 1);
+        a++;
+        b++;
+        n--;
+    }
+
+    if (!(((uintptr_t) a | (uintptr_t) b) & 2))
+    {
+        Pix_Word *d = (Pix_Word *) dst;
+        const Pix_Word *pa = (const Pix_Word *) a, *pb = (const Pix_Word *) b;
+
+        for (; n >= 2; n -= 2)
+        {
+            uint32_t x = *pa++, y = *pb++;
+            *d++ = (x & y) + (((x ^ y) & 0xF7DEF7DE) >> 1);
+        }
+        dst = (uint16_t *) d;
+        a = (const uint16_t *) pa;
+        b = (const uint16_t *) pb;
+    }
+
+    while (n--)
+    {
+        *dst++ = (*a & *b) + (((*a ^ *b) & 0xF7DE) >> 1);
+        a++;
+        b++;
+    }
+}
+
+// Average of two runs of bytes, rounded down, e.g. 24-bit pixels
+//  Param:
+//      dst: result, can be a or b
+//      a, b: bytes
+//      n: number of bytes
+void Pix_Blend8(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n)
+{
+    Pix_Word *d = (Pix_Word *) dst;
+    const Pix_Word *pa = (const Pix_Word *) a, *pb = (const Pix_Word *) b;
+
+    for (; n >= 4; n -= 4)
+        *d++ = Pix_Uhadd8(*pa++, *pb++);
+
+    dst = (uint8_t *) d;
+    a = (const uint8_t *) pa;
+    b = (const uint8_t *) pb;
+    while (n--)
+        *dst++ = (*a++ + *b++) >> 1;
+}
+
+// Blend bytes over others, dst = (src * alpha + dst * (256 - alpha)) / 256, rounded down
+// Each byte and its weight go in a pair of halfwords, so one SMLAD does a whole channel
+//  Param:
+//      dst: bytes blended into
+//      src: bytes blended over them
+//      alpha: weight of src, 0 - 256
+//      n: number of bytes
+void Pix_Alpha8(uint8_t *dst, const uint8_t *src, uint16_t alpha, uint32_t n)
+{
+    uint32_t weights = Pix_Pkhbt(alpha, 256 - alpha);
+    Pix_Word *d = (Pix_Word *) dst;
+    const Pix_Word *s = (const Pix_Word *) src;
+
+    for (; n >= 4; n -= 4)
+    {
+        uint32_t sw = *s++, dw = *d;
+        uint32_t se = sw & 0x00FF00FF, so = (sw >> 8) & 0x00FF00FF;       // bytes 0, 2 and 1, 3
+        uint32_t de = dw & 0x00FF00FF, dd = (dw >> 8) & 0x00FF00FF;
+        uint32_t b0 = Pix_Smlad(Pix_Pkhbt(se, de), weights, 0) >> 8;
+        uint32_t b1 = Pix_Smlad(Pix_Pkhbt(so, dd), weights, 0) >> 8;
+        uint32_t b2 = Pix_Smlad(Pix_Pkhtb(de, se), weights, 0) >> 8;
+        uint32_t b3 = Pix_Smlad(Pix_Pkhtb(dd, so), weights, 0) >> 8;
+
+        *d++ = b0 | (b1 << 8) | (b2 << 16) | (b3 << 24);
+    }
+
+    dst = (uint8_t *) d;
+    src = (const uint8_t *) s;
+    for (; n; n--, dst++)
+        *dst = (*src++ * alpha + *dst * (256 - alpha)) >> 8;
+}
+
+// Add bytes, saturating at 255, for additive effects like light and particles
+//  Param:
+//      dst: bytes added to
+//      src: bytes added
+//      n: number of bytes
+void Pix_AddSat8(uint8_t *dst, const uint8_t *src, uint32_t n)
+{
+    Pix_Word *d = (Pix_Word *) dst;
+    const Pix_Word *s = (const Pix_Word *) src;
+
+    for (; n >= 4; n -= 4, d++)
+        *d = Pix_Uqadd8(*d, *s++);
+
+    dst = (uint8_t *) d;
+    src = (const uint8_t *) s;
+    for (; n; n--, dst++)
+    {
+        uint16_t sum = *dst + *src++;
+        *dst = (sum > 0xFF) ? 0xFF : sum;
+    }
+}
+
+// Copy 8-bit palette indices, leaving dst as it was where src is 0
+//  Param:
+//      dst: indices copied into
+//      src: indices, 0 is transparent
+//      n: number of indices
+void Pix_Key8(uint8_t *dst, const uint8_t *src, uint32_t n)
+{
+    Pix_Word *d = (Pix_Word *) dst;
+    const Pix_Word *s = (const Pix_Word *) src;
+
+    for (; n >= 4; n -= 4, d++)
+        *d = Pix_Select8(*s++, *d);
+
+    dst = (uint8_t *) d;
+    src = (const uint8_t *) s;
+    for (; n; n--, dst++, src++)
+        if (*src)
+            *dst = *src;
+}
@@ -0,0 +1,108 @@
+#ifndef PIX_H
+#define PIX_H
+
+/*
+    Pixel kernels for buffered rendering: fills, format conversion, palette expansion and
+    blending over whole runs of pixels. On the Cortex-M4 they work on a 32-bit word at a time
+    with its SIMD instructions (UHADD8, UQADD8, SEL, PKHBT, SMLAD). Built anywhere else, the
+    same code runs with C versions of those instructions, so results can be checked on the
+    host bit for bit, see tools/pixcheck.c.
+
+    Two pixel formats are used:
+        16-bit: RGB565 in a uint16_t, what LCD_DMAPush sends
+        24-bit: the panel's 18-bit wire format, 3 bytes per pixel (R, G, B) with the 6-bit
+                channel in bits [7:2], what LCD_PushPixel sends
+
+    Pointers to 16-bit pixels must be 2-byte aligned. Byte kernels work on whole words, their
+    pointers must be 4-byte aligned, and any bytes past the last whole word are done one by one.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+// Word of pixels, for reading and writing uint16_t and uint8_t buffers 32 bits at a time. It
+// may alias any type, so the compiler keeps its accesses in order with the narrower ones
+typedef uint32_t __attribute__((may_alias)) Pix_Word;
+
+// Fill 16-bit pixels with a color
+//  Param:
+//      dst: pixels
+//      color: RGB565 color
+//      n: number of pixels
+void Pix_Fill16(uint16_t *dst, uint16_t color, uint32_t n);
+
+// Fill 24-bit pixels with a color
+//  Param:
+//      dst: pixels, 3 bytes each
+//      color: encoded color
+//      n: number of pixels
+void Pix_Fill24(uint8_t *dst, LCD_Color color, uint32_t n);
+
+// Convert 16-bit pixels to 24-bit pixels
+// 5-bit channels are widened to 6 bits by repeating their top bit
+//  Param:
+//      dst: 24-bit pixels
+//      src: 16-bit pixels
+//      n: number of pixels
+void Pix_16To24(uint8_t *dst, const uint16_t *src, uint32_t n);
+
+// Convert 24-bit pixels to 16-bit pixels, dropping the low bit of red and blue
+//  Param:
+//      dst: 16-bit pixels
+//      src: 24-bit pixels
+//      n: number of pixels
+void Pix_24To16(uint16_t *dst, const uint8_t *src, uint32_t n);
+
+// Look up 8-bit palette indices
+//  Param:
+//      dst: 16-bit pixels
+//      src: palette indices
+//      palette: RGB565 colors
+//      n: number of pixels
+void Pix_Expand16(uint16_t *dst, const uint8_t *src, const uint16_t *palette, uint32_t n);
+
+// Look up 8-bit palette indices, writing each pixel twice, for 2x horizontal scaling
+//  Param:
+//      dst: 16-bit pixels, 2 * n of them, 4-byte aligned
+//      src: palette indices
+//      palette: RGB565 colors
+//      n: number of palette indices
+void Pix_Expand16x2(uint16_t *dst, const uint8_t *src, const uint16_t *palette, uint32_t n);
+
+// Average of two runs of 16-bit pixels, rounded down in each channel
+//  Param:
+//      dst: result, can be a or b
+//      a, b: pixels
+//      n: number of pixels
+void Pix_Blend16(uint16_t *dst, const uint16_t *a, const uint16_t *b, uint32_t n);
+
+// Average of two runs of bytes, rounded down, e.g. 24-bit pixels
+//  Param:
+//      dst: result, can be a or b
+//      a, b: bytes
+//      n: number of bytes
+void Pix_Blend8(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n);
+
+// Blend bytes over others, dst = (src * alpha + dst * (256 - alpha)) / 256, rounded down
+//  Param:
+//      dst: bytes blended into
+//      src: bytes blended over them
+//      alpha: weight of src, 0 - 256
+//      n: number of bytes
+void Pix_Alpha8(uint8_t *dst, const uint8_t *src, uint16_t alpha, uint32_t n);
+
+// Add bytes, saturating at 255, for additive effects like light and particles
+//  Param:
+//      dst: bytes added to
+//      src: bytes added
+//      n: number of bytes
+void Pix_AddSat8(uint8_t *dst, const uint8_t *src, uint32_t n);
+
+// Copy 8-bit palette indices, leaving dst as it was where src is 0
+//  Param:
+//      dst: indices copied into
+//      src: indices, 0 is transparent
+//      n: number of indices
+void Pix_Key8(uint8_t *dst, const uint8_t *src, uint32_t n);
+
+#endif // PIX_H
@@ -0,0 +1,52 @@
+#include "random.h"
+
+// Seed a generator
+// The 32-bit seed is expanded into the full state with splitmix32
+//  Param:
+//      st: generator state
+//      seed: any value
+void Rand_Seed(Rand_State *st, uint32_t seed)
+{
+    uint32_t z;
+
+    for (int i = 0; i < 4; i++)
+    {
+        z = (seed += 0x9E3779B9);
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        st->s[i] = z ^ (z >> 16);
+    }
+
+    // All zeros is the only invalid state
+    if (!(st->s[0] | st->s[1] | st->s[2] | st->s[3]))
+        st->s[0] = 1;
+}
+
+// Fill a buffer with pseudo-random numbers
+// Faster than calling Rand_Next in a loop, as the state stays in registers
+//  Param:
+//      st: generator state
+//      buffer: destination
+//      count: amount of numbers to generate
+void Rand_Fill(Rand_State *st, uint32_t *buffer, uint32_t count)
+{
+    uint32_t s0 = st->s[0], s1 = st->s[1], s2 = st->s[2], s3 = st->s[3];
+    uint32_t t;
+
+    while (count--)
+    {
+        *buffer++ = Rand_Rotl(s1 * 5, 7) * 9;
+        t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = Rand_Rotl(s3, 11);
+    }
+
+    st->s[0] = s0;
+    st->s[1] = s1;
+    st->s[2] = s2;
+    st->s[3] = s3;
+}
@@ -0,0 +1,84 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+/*
+    Pseudo-random number generation. The generator is xoshiro128** with a period of 2^128 - 1,
+    and its state is kept in a Rand_State so independent streams can be used, e.g. one for
+    gameplay that stays deterministic given its seed and one for visual effects.
+    The core is inline so the hot paths do not pay for a call.
+*/
+
+#include <stdint.h>
+
+typedef struct Rand_State
+{
+    uint32_t s[4];
+} Rand_State;
+
+static inline uint32_t Rand_Rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+// Generate pseudo-random number
+//  Param:
+//      st: generator state
+//  Return:
+//      32 bit pseudo-random number
+static inline uint32_t Rand_Next(Rand_State *st)
+{
+    uint32_t *s = st->s;
+    const uint32_t result = Rand_Rotl(s[1] * 5, 7) * 9;
+    const uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rand_Rotl(s[3], 11);
+
+    return result;
+}
+
+// Generate pseudo-random number in [0, n) without modulo bias
+// Uses Lemire's multiply and reject method, which almost never needs a division
+//  Param:
+//      st: generator state
+//      n: upper bound, exclusive. Must be greater than 0
+//  Return:
+//      uniformly distributed number in [0, n)
+static inline uint32_t Rand_Range(Rand_State *st, uint32_t n)
+{
+    uint64_t m = (uint64_t) Rand_Next(st) * n;
+    uint32_t l = (uint32_t) m;
+
+    if (l < n)
+    {
+        uint32_t t = -n % n;
+        while (l < t)
+        {
+            m = (uint64_t) Rand_Next(st) * n;
+            l = (uint32_t) m;
+        }
+    }
+
+    return m >> 32;
+}
+
+// Seed a generator
+// The 32-bit seed is expanded into the full state, the same seed always gives the same sequence
+//  Param:
+//      st: generator state
+//      seed: any value
+void Rand_Seed(Rand_State *st, uint32_t seed);
+
+// Fill a buffer with pseudo-random numbers
+// Faster than calling Rand_Next in a loop, as the state stays in registers
+//  Param:
+//      st: generator state
+//      buffer: destination
+//      count: amount of numbers to generate
+void Rand_Fill(Rand_State *st, uint32_t *buffer, uint32_t count);
+
+#endif // RANDOM_H
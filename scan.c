@@ -0,0 +1,233 @@
+#include "scan.h"
+#include "pix.h"
+
+static const uint16_t *_palette = NULL;
+static const uint8_t *_tiles = NULL, *_map = NULL;
+static uint8_t _mapWidth = 0, _mapHeight = 0;
+static int16_t _scrollX = 0, _scrollY = 0;
+static const Scan_Sprite *_sprites = NULL;
+static uint8_t _spriteCount = 0;
+static const Text_Layer *_hud = NULL;
+static uint8_t _hudOpaque = 0;
+
+// Sprites sorted by y, and the ones crossing the current line
+static uint8_t _sorted[SCAN_SPRITES];
+static uint8_t _active[SCAN_LINE_SPRITES];
+static uint8_t _activeCount, _nextSprite;
+
+static void Scan_SortSprites(void);
+static void Scan_Tiles(uint16_t *line, int16_t y);
+static void Scan_Sprites(uint16_t *line, int16_t y);
+static void Scan_Text(uint16_t *line, int16_t y);
+
+// Set the palette used by tiles and sprites
+//  Param:
+//      palette: RGB565 colors, as many as the indices used
+void Scan_SetPalette(const uint16_t *palette)
+{
+    _palette = palette;
+}
+
+// Set the tilemap layer
+//  Param:
+//      tiles: 8x8 tiles, 64 palette indices each
+//      map: tile numbers, row by row. NULL turns the layer off, leaving palette color 0
+//      width, height: size of the map in tiles
+void Scan_SetTilemap(const uint8_t *tiles, const uint8_t *map, uint8_t width, uint8_t height)
+{
+    _tiles = tiles;
+    _map = map;
+    _mapWidth = width;
+    _mapHeight = height;
+}
+
+// Scroll the tilemap
+//  Param:
+//      x, y: map pixel shown at the top left corner of the screen
+void Scan_Scroll(int16_t x, int16_t y)
+{
+    _scrollX = x;
+    _scrollY = y;
+}
+
+// Set the sprite layer
+//  Param:
+//      sprites: sprites, can be moved between frames
+//      n: number of sprites (0 - SCAN_SPRITES)
+void Scan_SetSprites(const Scan_Sprite *sprites, uint8_t n)
+{
+    _sprites = sprites;
+    _spriteCount = min(n, SCAN_SPRITES);
+}
+
+// Set the HUD layer
+//  Param:
+//      hud: text layer, NULL for none
+//      opaque: 1 to draw the background of cells that are not spaces
+void Scan_SetHUD(const Text_Layer *hud, uint8_t opaque)
+{
+    _hud = hud;
+    _hudOpaque = opaque;
+}
+
+// Sort the visible sprites by y, insertion sort as there are few and they barely move
+// between frames
+static void Scan_SortSprites(void)
+{
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < _spriteCount; i++)
+    {
+        const Scan_Sprite *s = &_sprites[i];
+        uint8_t j;
+
+        if (!s->pixels || s->y >= LCD_HEIGHT || s->y + s->h <= 0)
+            continue;
+        j = n++;
+        while (j && _sprites[_sorted[j - 1]].y > s->y)
+        {
+            _sorted[j] = _sorted[j - 1];
+            j--;
+        }
+        _sorted[j] = i;
+    }
+
+    // Hidden and off screen sprites are left out, the list ends at the first 0xFF
+    for (uint8_t i = n; i < SCAN_SPRITES; i++)
+        _sorted[i] = 0xFF;
+    _nextSprite = 0;
+    _activeCount = 0;
+}
+
+// Tilemap part of a line
+static void Scan_Tiles(uint16_t *line, int16_t y)
+{
+    int16_t mapW = _mapWidth * 8, mapH = _mapHeight * 8;
+    int16_t px = ((_scrollX % mapW) + mapW) % mapW;
+    int16_t py = (((_scrollY + y) % mapH) + mapH) % mapH;
+    const uint8_t *row = &_map[(py >> 3) * _mapWidth];
+    uint8_t x = 0;
+
+    while (x < LCD_WIDTH)
+    {
+        const uint8_t *src = &_tiles[row[px >> 3] * 64 + (py & 7) * 8 + (px & 7)];
+        uint8_t n = min(8 - (px & 7), LCD_WIDTH - x);
+
+        Pix_Expand16(&line[x], src, _palette, n);
+        x += n;
+        px += n;
+        if (px == mapW)
+            px = 0;
+    }
+}
+
+// Sprite part of a line, updating the list of sprites crossing it
+static void Scan_Sprites(uint16_t *line, int16_t y)
+{
+    uint8_t n = 0;
+
+    // Drop the sprites that ended above this line
+    for (uint8_t i = 0; i < _activeCount; i++)
+    {
+        const Scan_Sprite *s = &_sprites[_active[i]];
+        if (s->y + s->h > y)
+            _active[n++] = _active[i];
+    }
+    _activeCount = n;
+
+    // Add the ones starting on it, in y order so lower ones end up drawn last. When the line is
+    // full they stay pending, and are only left out of lines until a place frees up
+    while (_nextSprite < SCAN_SPRITES && _sorted[_nextSprite] != 0xFF &&
+           _sprites[_sorted[_nextSprite]].y <= y)
+    {
+        uint8_t i = _sorted[_nextSprite];
+
+        if (_sprites[i].y + _sprites[i].h > y)
+        {
+            if (_activeCount == SCAN_LINE_SPRITES)
+                break;
+            _active[_activeCount++] = i;
+        }
+        _nextSprite++;
+    }
+
+    for (uint8_t i = 0; i < _activeCount; i++)
+    {
+        const Scan_Sprite *s = &_sprites[_active[i]];
+        const uint8_t *src = &s->pixels[(y - s->y) * s->w];
+        int16_t x0 = max(0, s->x), x1 = min(LCD_WIDTH, s->x + s->w);
+
+        for (int16_t x = x0; x < x1; x++)
+        {
+            uint8_t c = src[x - s->x];
+            if (c)
+                line[x] = _palette[c];
+        }
+    }
+}
+
+// HUD part of a line. Cell (col, row) has its glyph from x = 6 * col + 1 and y = 8 * row + 1,
+// with a background column on each side, like LCD_gChar
+static void Scan_Text(uint16_t *line, int16_t y)
+{
+    uint8_t row, bit;
+
+    if (y < 1 || (y - 1) / 8 >= TEXT_ROWS)
+        return;
+    row = (y - 1) / 8;
+    bit = 1 << ((y - 1) % 8);
+
+    for (uint8_t col = 0; col < TEXT_COLS; col++)
+    {
+        const Text_Cell *cell = &_hud->cells[row][col];
+        const uint8_t *glyph;
+        uint16_t fg, bg;
+        uint16_t *dst = &line[col * 6];
+
+        if (cell->c == ' ')
+            continue;
+        glyph = &LCD_Font[(uint8_t) cell->c * 5];
+        fg = LCD_PixelTo565(cell->fg);
+
+        if (_hudOpaque)
+        {
+            bg = LCD_PixelTo565(cell->bg);
+            dst[0] = bg;
+            for (uint8_t i = 0; i < 5; i++)
+                dst[i + 1] = (glyph[i] & bit) ? fg : bg;
+            dst[6] = bg;
+        }
+        else
+            for (uint8_t i = 0; i < 5; i++)
+                if (glyph[i] & bit)
+                    dst[i + 1] = fg;
+    }
+}
+
+// Draw a whole frame
+void Scan_Draw(void)
+{
+    uint16_t bg = _palette ? _palette[0] : 0;
+
+    Scan_SortSprites();
+    LCD_DMABegin(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+
+    for (int16_t y = 0; y < LCD_HEIGHT; y++)
+    {
+        uint16_t *line = LCD_DMALine();
+
+        if (_map && _tiles && _palette)
+            Scan_Tiles(line, y);
+        else
+            Pix_Fill16(line, bg, LCD_WIDTH);
+
+        if (_palette)
+            Scan_Sprites(line, y);
+        if (_hud)
+            Scan_Text(line, y);
+
+        LCD_DMAPush(line, LCD_WIDTH);
+    }
+
+    LCD_DMAEnd();
+}
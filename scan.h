@@ -0,0 +1,69 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+/*
+    Scanline compositor. The screen is made one line at a time, with no framebuffer: for each
+    line a tilemap, the sprites crossing it and a HUD text layer are drawn into a 128 pixel
+    line buffer, which uDMA sends to the panel while the next line is made in a second one.
+    Memory used is the sprite lists, the line buffers are the ones shared by LCD_DMALine.
+
+    Tiles and sprites are 8-bit palette indices into a palette of RGB565 colors. Tiles are 8x8,
+    64 bytes each, and the tilemap wraps around when scrolled past its edges. Sprite index 0
+    is transparent. Sprites are sorted by y every frame and kept in a list of the ones crossing
+    the current line, so each line only looks at those. Lower sprites are drawn over higher
+    ones, and at most SCAN_LINE_SPRITES share a line, the rest are left out of it.
+
+    The HUD is a Text_Layer drawn over everything, in the same cells LCD_gString uses. Spaces
+    are transparent.
+
+    Everything given here is kept by pointer and must stay valid while frames are drawn.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+#include "text.h"
+
+// Most sprites in a frame, and on a single line
+#define SCAN_SPRITES      32
+#define SCAN_LINE_SPRITES 12
+
+typedef struct Scan_Sprite
+{
+    int16_t x, y;               // top left corner, can be partly off screen
+    uint8_t w, h;
+    const uint8_t *pixels;      // w * h palette indices, row by row. NULL hides the sprite
+} Scan_Sprite;
+
+// Set the palette used by tiles and sprites
+//  Param:
+//      palette: RGB565 colors, as many as the indices used
+void Scan_SetPalette(const uint16_t *palette);
+
+// Set the tilemap layer
+//  Param:
+//      tiles: 8x8 tiles, 64 palette indices each
+//      map: tile numbers, row by row. NULL turns the layer off, leaving palette color 0
+//      width, height: size of the map in tiles
+void Scan_SetTilemap(const uint8_t *tiles, const uint8_t *map, uint8_t width, uint8_t height);
+
+// Scroll the tilemap
+//  Param:
+//      x, y: map pixel shown at the top left corner of the screen
+void Scan_Scroll(int16_t x, int16_t y);
+
+// Set the sprite layer
+//  Param:
+//      sprites: sprites, can be moved between frames
+//      n: number of sprites (0 - SCAN_SPRITES)
+void Scan_SetSprites(const Scan_Sprite *sprites, uint8_t n);
+
+// Set the HUD layer
+//  Param:
+//      hud: text layer, NULL for none
+//      opaque: 1 to draw the background of cells that are not spaces
+void Scan_SetHUD(const Text_Layer *hud, uint8_t opaque);
+
+// Draw a whole frame
+void Scan_Draw(void);
+
+#endif // SCAN_H
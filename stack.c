@@ -0,0 +1,49 @@
+#include "stack.h"
+#include "inc/tm4c123gh6pm.h"
+
+// Paints the unused part of the stack and sets up the guard region. Called from ResetISR
+void Stack_Init(void)
+{
+    uint32_t *p, *sp;
+
+    // Everything below the current stack pointer is unused
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+    for (p = &pui32Stack[STACK_GUARD_WORDS]; p < sp; p++)
+        *p = STACK_PAINT;
+
+    // MPU region 0: guard, no access and no execution
+    NVIC_MPU_NUMBER_R = 0;
+    NVIC_MPU_BASE_R = (uint32_t) pui32Stack;
+    NVIC_MPU_ATTR_R = (1 << 28) |            // XN
+                      (0 << 24) |            // AP: no access
+                      ((__builtin_ctz(STACK_GUARD_WORDS * 4) - 1) << 1) |   // SIZE: 2^(SIZE+1) bytes
+                      1;                     // ENABLE
+
+    NVIC_SYS_HND_CTRL_R |= (1 << 16);        // Enable MemManage fault
+    NVIC_MPU_CTRL_R = (1 << 2) | 1;          // Default memory map for everything else, enable MPU
+    __asm volatile ("dsb\n"
+                    "isb");
+}
+
+// Get the most stack used since reset
+//  Return:
+//      high-water mark in bytes
+uint32_t Stack_HighWater(void)
+{
+    uint32_t i;
+
+    // The stack grows down, the first overwritten word from the bottom is the deepest point
+    for (i = STACK_GUARD_WORDS; i < STACK_GUARD_WORDS + STACK_WORDS; i++)
+        if (pui32Stack[i] != STACK_PAINT)
+            break;
+
+    return (STACK_GUARD_WORDS + STACK_WORDS - i) * 4;
+}
+
+// Get the size of the stack
+//  Return:
+//      stack size in bytes, not counting the guard region
+uint32_t Stack_Size(void)
+{
+    return STACK_WORDS * 4;
+}
@@ -0,0 +1,43 @@
+#ifndef STACK_H
+#define STACK_H
+
+/*
+    System stack instrumentation. The stack reserved in startup_gcc.c is painted with a known
+    pattern at reset, so the deepest point it reached can be found later by looking for the
+    first word that was overwritten. Below the stack sits a small guard region that the MPU
+    makes inaccessible, so an overflow traps right away instead of corrupting other data.
+*/
+
+#include <stdint.h>
+
+// Usable stack size in 32-bit words. The deepest game and demo call chains add up to about 450
+// bytes of -fstack-usage frames, and the Timer1, Timer2, SSI2 and UART0 interrupts can nest
+// on top of them with a 104 byte exception frame each when they use the FPU, about 550 bytes
+// more. The rest is headroom
+#define STACK_WORDS 384
+
+// Guard region below the stack in 32-bit words. A function whose frame is larger than the
+// guard can step over it without touching it, so it is larger than any frame -fstack-usage
+// reports. The MPU needs a power of 2 of at least 32 bytes, aligned to its size
+#define STACK_GUARD_WORDS 64
+
+// Pattern the unused stack is filled with
+#define STACK_PAINT 0xDEADBEEF
+
+// System stack, guard region first
+extern uint32_t pui32Stack[STACK_GUARD_WORDS + STACK_WORDS];
+
+// Paints the unused part of the stack and sets up the guard region. Called from ResetISR
+void Stack_Init(void);
+
+// Get the most stack used since reset
+//  Return:
+//      high-water mark in bytes
+uint32_t Stack_HighWater(void);
+
+// Get the size of the stack
+//  Return:
+//      stack size in bytes, not counting the guard region
+uint32_t Stack_Size(void);
+
+#endif // STACK_H
@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
+#include "stack.h"
 
 //*****************************************************************************
 //
@@ -34,6 +35,7 @@
 void ResetISR(void);
 static void NmiSR(void);
 static void FaultISR(void);
+static void MPUFaultISR(void);
 static void IntDefaultHandler(void);
 
 //*****************************************************************************
@@ -45,10 +47,26 @@ extern int main(void);
 
 //*****************************************************************************
 //
-// Reserve space for the system stack.
+// External declarations for the interrupt handlers used by the application.
 //
 //*****************************************************************************
-static uint32_t pui32Stack[128];
+extern void LCD_InitTimerISR(void);
+extern void Task_PendSVISR(void);
+extern void Task_SysTickISR(void);
+extern void Audio_TimerISR(void);
+#ifdef GE_MIRROR
+extern void Mirror_UARTISR(void);
+#endif
+extern void LCD_SSIISR(void);
+
+//*****************************************************************************
+//
+// Reserve space for the system stack.  The lowest words are the guard region
+// set up by Stack_Init, so the array is aligned to the guard region size.
+//
+//*****************************************************************************
+__attribute__ ((aligned(STACK_GUARD_WORDS * 4)))
+uint32_t pui32Stack[STACK_GUARD_WORDS + STACK_WORDS];
 
 //*****************************************************************************
 //
@@ -64,7 +82,7 @@ void (* const g_pfnVectors[])(void) =
     ResetISR,                               // The reset handler
     NmiSR,                                  // The NMI handler
     FaultISR,                               // The hard fault handler
-    IntDefaultHandler,                      // The MPU fault handler
+    MPUFaultISR,                            // The MPU fault handler
     IntDefaultHandler,                      // The bus fault handler
     IntDefaultHandler,                      // The usage fault handler
     0,                                      // Reserved
@@ -74,14 +92,18 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
-    IntDefaultHandler,                      // The SysTick handler
+    Task_PendSVISR,                         // The PendSV handler
+    Task_SysTickISR,                        // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
+#ifdef GE_MIRROR
+    Mirror_UARTISR,                         // UART0 Rx and Tx
+#else
     IntDefaultHandler,                      // UART0 Rx and Tx
+#endif
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
@@ -97,9 +119,9 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // Watchdog timer
     IntDefaultHandler,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
-    IntDefaultHandler,                      // Timer 1 subtimer A
+    LCD_InitTimerISR,                       // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
-    IntDefaultHandler,                      // Timer 2 subtimer A
+    Audio_TimerISR,                         // Timer 2 subtimer A
     IntDefaultHandler,                      // Timer 2 subtimer B
     IntDefaultHandler,                      // Analog Comparator 0
     IntDefaultHandler,                      // Analog Comparator 1
@@ -133,7 +155,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port J
     IntDefaultHandler,                      // GPIO Port K
     IntDefaultHandler,                      // GPIO Port L
-    IntDefaultHandler,                      // SSI2 Rx and Tx
+    LCD_SSIISR,                             // SSI2 Rx and Tx
     IntDefaultHandler,                      // SSI3 Rx and Tx
     IntDefaultHandler,                      // UART3 Rx and Tx
     IntDefaultHandler,                      // UART4 Rx and Tx
@@ -229,6 +251,9 @@ extern uint32_t _data;
 extern uint32_t _edata;
 extern uint32_t _bss;
 extern uint32_t _ebss;
+extern uint32_t _lramfunc;
+extern uint32_t _ramfunc;
+extern uint32_t _eramfunc;
 
 //*****************************************************************************
 //
@@ -254,6 +279,15 @@ ResetISR(void)
         *pui32Dest++ = *pui32Src++;
     }
 
+    //
+    // Copy the functions placed in SRAM with RAMFUNC from flash.
+    //
+    pui32Src = &_lramfunc;
+    for(pui32Dest = &_ramfunc; pui32Dest < &_eramfunc; )
+    {
+        *pui32Dest++ = *pui32Src++;
+    }
+
     //
     // Zero fill the bss segment.
     //
@@ -281,6 +315,12 @@ ResetISR(void)
                          ~(NVIC_CPAC_CP10_M | NVIC_CPAC_CP11_M)) |
                         NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL);
 
+    //
+    // Paint the stack for high-water mark measurements and protect the guard
+    // region below it.
+    //
+    Stack_Init();
+
     //
     // Call the application's entry point.
     //
@@ -323,6 +363,25 @@ FaultISR(void)
     }
 }
 
+//*****************************************************************************
+//
+// This is the code that gets called when the processor receives a memory
+// management fault, most likely a stack overflow into the guard region.  This
+// simply enters an infinite loop, preserving the system state for examination
+// by a debugger.
+//
+//*****************************************************************************
+static void
+MPUFaultISR(void)
+{
+    //
+    // Enter an infinite loop.
+    //
+    while(1)
+    {
+    }
+}
+
 //*****************************************************************************
 //
 // This is the code that gets called when the processor receives an unexpected
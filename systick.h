@@ -6,6 +6,11 @@
 #define SYSTICK_VAL_R  (*((volatile uint32_t *)0xE000E018)) // NVIC_ST_CURRENT_R
 #define SYSTICK_CTRL_R (*((volatile uint32_t *)0xE000E010)) // NVIC_ST_CTRL_R
 
+// Debug cycle counter, counts core clock cycles while enabled
+#define DWT_CTRL_R     (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R   (*((volatile uint32_t *)0xE0001004))
+#define DEMCR_R        (*((volatile uint32_t *)0xE000EDFC)) // NVIC_DBG_INT_R
+
 void SysTick_Init(int n, char intEn);
 
 #endif // SYSTICK_H
@@ -0,0 +1,431 @@
+#include "task.h"
+#include "systick.h"
+#include "stack.h"
+#include "tiva-gc-inc.h"
+#include "inc/tm4c123gh6pm.h"
+
+#define TASK_READY    0
+#define TASK_SLEEPING 1     // blocked with a timeout
+#define TASK_WAITING  2     // blocked without a timeout
+#define TASK_DONE     3
+
+// Running task and task to switch to, used by Task_PendSVISR
+Task *Task_Current = NULL, *Task_Next = NULL;
+
+static Task *_tasks[TASK_MAX];
+static uint8_t _nTasks = 0;
+static volatile uint32_t _ticks = 0;
+
+// Idle task, runs when no other task is ready
+static Task _idle;
+static uint32_t _idleStack[64] __attribute__((aligned(8)));
+
+static uint32_t Task_Lock(void);
+static void Task_Unlock(uint32_t primask);
+static void Task_Schedule(uint8_t rotate);
+static int Task_Wait(const void *obj, uint32_t wake, uint32_t timeout);
+static void Task_Notify(const void *obj);
+static void Task_Exit(void);
+static void Task_Idle(void);
+
+// Disable interrupts
+//  Return:
+//      previous PRIMASK, to give to Task_Unlock
+static uint32_t Task_Lock(void)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n"
+                    "cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+// Restore interrupts to how they were before Task_Lock
+//  Param:
+//      primask: value returned by Task_Lock
+static void Task_Unlock(uint32_t primask)
+{
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+// Pick the task to run and request a context switch if it is not the running one.
+// Must be called with interrupts disabled
+//  Param:
+//      rotate: 1 to let the next task of the same priority run, 0 to keep the running one
+static void Task_Schedule(uint8_t rotate)
+{
+    Task *best = &_idle;
+    uint8_t start = 0;
+
+    // Start looking right after the running task, so tasks of the same priority take turns
+    for (uint8_t i = 0; i < _nTasks; i++)
+        if (_tasks[i] == Task_Current)
+            start = i + 1;
+
+    for (uint8_t i = 0; i < _nTasks; i++)
+    {
+        Task *t = _tasks[(start + i) % _nTasks];
+        if (t->state == TASK_READY && t->priority > best->priority)
+            best = t;
+    }
+
+    if (!rotate && Task_Current && Task_Current->state == TASK_READY &&
+        Task_Current->priority >= best->priority)
+        best = Task_Current;
+
+    Task_Next = best;
+    if (best != Task_Current)
+        NVIC_INT_CTRL_R = NVIC_INT_CTRL_PEND_SV;
+}
+
+// Block the running task until Task_Notify is called on obj or the timeout runs out.
+// Must be called with interrupts disabled from a task, returns with interrupts disabled
+//  Param:
+//      obj: object to wait on
+//      wake: tick to wake up at
+//      timeout: TASK_FOREVER to ignore wake
+//  Return:
+//      1 if notified, 0 on timeout
+static int Task_Wait(const void *obj, uint32_t wake, uint32_t timeout)
+{
+    Task *self = Task_Current;
+
+    if (timeout != TASK_FOREVER && (int32_t) (_ticks - wake) >= 0)
+        return 0;
+
+    self->waitObj = obj;
+    self->wake = wake;
+    self->state = (timeout == TASK_FOREVER) ? TASK_WAITING : TASK_SLEEPING;
+    Task_Schedule(0);
+
+    // PendSV switches away as soon as interrupts are enabled, and this task continues from
+    // here once it is ready again
+    Task_Unlock(0);
+    Task_Lock();
+
+    if (self->waitObj)
+    {
+        self->waitObj = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// Wake the highest priority task waiting on an object. Must be called with interrupts disabled
+//  Param:
+//      obj: object tasks wait on
+static void Task_Notify(const void *obj)
+{
+    Task *best = NULL;
+
+    for (uint8_t i = 0; i < _nTasks; i++)
+    {
+        Task *t = _tasks[i];
+        if (t->state != TASK_READY && t->state != TASK_DONE && t->waitObj == obj &&
+            (!best || t->priority > best->priority))
+            best = t;
+    }
+
+    if (best)
+    {
+        best->waitObj = NULL;
+        best->state = TASK_READY;
+        Task_Schedule(0);
+    }
+}
+
+// Where tasks return to when their function ends
+static void Task_Exit(void)
+{
+    Task_Lock();
+    Task_Current->state = TASK_DONE;
+    Task_Schedule(0);
+    Task_Unlock(0);
+    while (1);
+}
+
+// Sleeps until the next interrupt when there is nothing to do
+static void Task_Idle(void)
+{
+    while (1)
+        __asm volatile ("wfi");
+}
+
+// Create a task, ready to run once the kernel starts or right away if it already started
+//  Param:
+//      task: control block, must stay valid forever
+//      entry: task function. Returning from it ends the task
+//      stack: stack for the task, 8 byte aligned
+//      words: stack size in 32-bit words, at least 64 if the task uses floating point
+//      priority: higher runs first, above TASK_PRIO_IDLE
+//  Return:
+//      1 if created, 0 if there are already TASK_MAX tasks
+int Task_Create(Task *task, void (*entry)(void), uint32_t *stack, uint32_t words, uint8_t priority)
+{
+    uint32_t primask, *sp;
+
+    if (task != &_idle && _nTasks == TASK_MAX)
+        return 0;
+
+    // Painted for Task_StackHighWater
+    for (uint32_t i = 0; i < words; i++)
+        stack[i] = STACK_PAINT;
+
+    // Initial context, as if the task had been switched out right before its first instruction
+    sp = stack + (words & ~1);
+    *--sp = 0x01000000;                     // xPSR, Thumb state
+    *--sp = (uint32_t) entry & ~1;          // PC
+    *--sp = (uint32_t) Task_Exit;           // LR
+    for (int i = 0; i < 5; i++)
+        *--sp = 0;                          // R12, R3-R0
+    *--sp = 0xFFFFFFFD;                     // EXC_RETURN: thread mode, PSP, no FP context
+    for (int i = 0; i < 8; i++)
+        *--sp = 0;                          // R11-R4
+
+    task->sp = sp;
+    task->stack = stack;
+    task->stackWords = words;
+    task->priority = priority;
+    task->state = TASK_READY;
+    task->waitObj = NULL;
+    task->wake = 0;
+
+    if (task == &_idle)
+        return 1;
+
+    primask = Task_Lock();
+    _tasks[_nTasks++] = task;
+    if (Task_Current)
+        Task_Schedule(0);
+    Task_Unlock(primask);
+
+    return 1;
+}
+
+// Start the kernel. Sets up SysTick and runs the highest priority task, never returns
+void Task_Start(void)
+{
+    Task_Lock();
+
+    Task_Create(&_idle, Task_Idle, _idleStack, 64, TASK_PRIO_IDLE);
+
+    // SysTick above PendSV, both below every peripheral interrupt
+    NVIC_SYS_PRI3_R = (NVIC_SYS_PRI3_R & ~(NVIC_SYS_PRI3_TICK_M | NVIC_SYS_PRI3_PENDSV_M)) |
+                      (6 << 29) | (7 << 21);
+    SysTick_Init(CLOCKS_PER_SEC / TASK_TICK_HZ, ON);
+
+    // The first switch does not save anything, as there is no running task yet
+    Task_Current = NULL;
+    Task_Schedule(1);
+    Task_Unlock(0);
+
+    while (1);
+}
+
+// Get the number of ticks since the kernel started
+//  Return:
+//      ticks
+uint32_t Task_Ticks(void)
+{
+    return _ticks;
+}
+
+// Get the task that is running
+//  Return:
+//      running task, NULL before the kernel starts
+Task *Task_Self(void)
+{
+    return Task_Current;
+}
+
+// Let other tasks of the same priority run
+void Task_Yield(void)
+{
+    uint32_t primask = Task_Lock();
+    Task_Schedule(1);
+    Task_Unlock(primask);
+}
+
+// Block the running task for some time
+//  Param:
+//      ticks: time to sleep, in ticks
+void Task_Sleep(uint32_t ticks)
+{
+    uint32_t primask = Task_Lock();
+    Task_Wait(Task_Current, _ticks + ticks, ticks);
+    Task_Unlock(primask);
+}
+
+// Block the running task until a point in time, for periodic tasks that should not drift
+//  Param:
+//      last: tick the task last woke up at, updated to the new one
+//      period: ticks between wake ups
+void Task_SleepUntil(uint32_t *last, uint32_t period)
+{
+    uint32_t primask = Task_Lock();
+    *last += period;
+    Task_Wait(Task_Current, *last, period);
+    Task_Unlock(primask);
+}
+
+// Get the most stack a task has used
+//  Param:
+//      task: task to check
+//  Return:
+//      high-water mark in bytes
+uint32_t Task_StackHighWater(const Task *task)
+{
+    uint32_t i;
+
+    for (i = 0; i < task->stackWords; i++)
+        if (task->stack[i] != STACK_PAINT)
+            break;
+
+    return (task->stackWords - i) * 4;
+}
+
+// Set up a semaphore
+//  Param:
+//      sem: semaphore
+//      count: initial count
+void Task_SemInit(Task_Sem *sem, uint32_t count)
+{
+    sem->count = count;
+}
+
+// Take a semaphore, waiting for it if its count is 0
+//  Param:
+//      sem: semaphore
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if taken, 0 on timeout
+int Task_SemTake(Task_Sem *sem, uint32_t timeout)
+{
+    uint32_t primask = Task_Lock();
+    uint32_t wake = _ticks + timeout;
+
+    while (!sem->count)
+    {
+        if (timeout == TASK_NO_WAIT || !Task_Wait(sem, wake, timeout))
+        {
+            Task_Unlock(primask);
+            return 0;
+        }
+    }
+    sem->count--;
+
+    Task_Unlock(primask);
+    return 1;
+}
+
+// Give a semaphore, waking the highest priority task waiting on it
+//  Param:
+//      sem: semaphore
+void Task_SemGive(Task_Sem *sem)
+{
+    uint32_t primask = Task_Lock();
+    sem->count++;
+    Task_Notify(sem);
+    Task_Unlock(primask);
+}
+
+// Set up a queue
+//  Param:
+//      queue: queue
+//      buf: storage for length items of itemSize bytes
+//      itemSize: size of an item in bytes
+//      length: number of items the queue holds
+void Task_QueueInit(Task_Queue *queue, void *buf, uint16_t itemSize, uint16_t length)
+{
+    queue->buf = buf;
+    queue->itemSize = itemSize;
+    queue->length = length;
+    queue->head = 0;
+    queue->count = 0;
+}
+
+// Send an item to the back of a queue, waiting for space if it is full
+// Senders wait on the buffer, receivers on the queue itself
+//  Param:
+//      queue: queue
+//      item: item to copy into the queue
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if sent, 0 on timeout
+int Task_QueueSend(Task_Queue *queue, const void *item, uint32_t timeout)
+{
+    uint32_t primask = Task_Lock();
+    uint32_t wake = _ticks + timeout;
+    uint8_t *dst;
+
+    while (queue->count == queue->length)
+    {
+        if (timeout == TASK_NO_WAIT || !Task_Wait(queue->buf, wake, timeout))
+        {
+            Task_Unlock(primask);
+            return 0;
+        }
+    }
+
+    dst = queue->buf + ((queue->head + queue->count) % queue->length) * queue->itemSize;
+    for (uint16_t i = 0; i < queue->itemSize; i++)
+        dst[i] = ((const uint8_t *) item)[i];
+    queue->count++;
+    Task_Notify(queue);
+
+    Task_Unlock(primask);
+    return 1;
+}
+
+// Receive an item from the front of a queue, waiting for one if it is empty
+//  Param:
+//      queue: queue
+//      item: where to copy the item to
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if received, 0 on timeout
+int Task_QueueReceive(Task_Queue *queue, void *item, uint32_t timeout)
+{
+    uint32_t primask = Task_Lock();
+    uint32_t wake = _ticks + timeout;
+    uint8_t *src;
+
+    while (!queue->count)
+    {
+        if (timeout == TASK_NO_WAIT || !Task_Wait(queue, wake, timeout))
+        {
+            Task_Unlock(primask);
+            return 0;
+        }
+    }
+
+    src = queue->buf + queue->head * queue->itemSize;
+    for (uint16_t i = 0; i < queue->itemSize; i++)
+        ((uint8_t *) item)[i] = src[i];
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    Task_Notify(queue->buf);
+
+    Task_Unlock(primask);
+    return 1;
+}
+
+// Kernel tick, wakes sleeping tasks and lets tasks of the same priority take turns
+void Task_SysTickISR(void)
+{
+    // Higher priority interrupts can wake tasks too, the scan and the choice must not be split
+    uint32_t primask = Task_Lock();
+
+    _ticks++;
+
+    for (uint8_t i = 0; i < _nTasks; i++)
+    {
+        Task *t = _tasks[i];
+        if (t->state == TASK_SLEEPING && (int32_t) (_ticks - t->wake) >= 0)
+            t->state = TASK_READY;      // waitObj stays set, so Task_Wait sees a timeout
+    }
+
+    if (Task_Current)
+        Task_Schedule(1);
+
+    Task_Unlock(primask);
+}
@@ -0,0 +1,154 @@
+#ifndef TASK_H
+#define TASK_H
+
+/*
+    Minimal fixed-priority preemptive kernel. Tasks are created from statically allocated
+    control blocks and stacks, there is no heap. The highest priority task that is ready always
+    runs, tasks of the same priority take turns every tick. Context switches happen in PendSV,
+    at the lowest interrupt priority, so they never hold up other interrupts.
+
+    SysTick is the kernel tick once Task_Start is called, so GE_STGet, GE_STPop and
+    GE_STGetCount measure ticks of 1 / TASK_TICK_HZ seconds from then on. Use GE_NowCycles to
+    measure time instead.
+
+    Semaphores and queues can be given and sent to from interrupts, with a timeout of 0.
+*/
+
+#include <stdint.h>
+
+// Kernel tick frequency
+#define TASK_TICK_HZ 1000
+
+// Most tasks that can be created, not counting the idle task
+#define TASK_MAX 8
+
+// Lowest and highest task priorities. The idle task runs at TASK_PRIO_IDLE
+#define TASK_PRIO_IDLE 0
+#define TASK_PRIO_MAX  255
+
+// Timeouts, in ticks
+#define TASK_NO_WAIT  0
+#define TASK_FOREVER  0xFFFFFFFF
+
+// Task control block
+// sp must stay the first member, the context switch in task_switch.s relies on it
+typedef struct Task
+{
+    uint32_t *sp;           // saved stack pointer while not running
+    uint32_t *stack;        // bottom of the stack
+    uint32_t stackWords;
+    uint8_t priority;
+    uint8_t state;
+    const void *waitObj;    // object the task is blocked on, NULL if none
+    uint32_t wake;          // tick to wake up at if sleeping or waiting with a timeout
+} Task;
+
+// Counting semaphore
+typedef struct Task_Sem
+{
+    volatile uint32_t count;
+} Task_Sem;
+
+// Fixed size message queue, over a buffer given by the user
+typedef struct Task_Queue
+{
+    uint8_t *buf;
+    uint16_t itemSize, length;
+    volatile uint16_t head, count;
+} Task_Queue;
+
+// Create a task, ready to run once the kernel starts or right away if it already started
+//  Param:
+//      task: control block, must stay valid forever
+//      entry: task function. Returning from it ends the task
+//      stack: stack for the task, 8 byte aligned
+//      words: stack size in 32-bit words, at least 64 if the task uses floating point
+//      priority: higher runs first, above TASK_PRIO_IDLE
+//  Return:
+//      1 if created, 0 if there are already TASK_MAX tasks
+int Task_Create(Task *task, void (*entry)(void), uint32_t *stack, uint32_t words, uint8_t priority);
+
+// Start the kernel. Sets up SysTick and runs the highest priority task, never returns
+void Task_Start(void) __attribute__((noreturn));
+
+// Get the number of ticks since the kernel started
+//  Return:
+//      ticks
+uint32_t Task_Ticks(void);
+
+// Get the task that is running
+//  Return:
+//      running task, NULL before the kernel starts
+Task *Task_Self(void);
+
+// Let other tasks of the same priority run
+void Task_Yield(void);
+
+// Block the running task for some time
+//  Param:
+//      ticks: time to sleep, in ticks
+void Task_Sleep(uint32_t ticks);
+
+// Block the running task until a point in time, for periodic tasks that should not drift
+//  Param:
+//      last: tick the task last woke up at, updated to the new one
+//      period: ticks between wake ups
+void Task_SleepUntil(uint32_t *last, uint32_t period);
+
+// Get the most stack a task has used
+//  Param:
+//      task: task to check
+//  Return:
+//      high-water mark in bytes
+uint32_t Task_StackHighWater(const Task *task);
+
+// Set up a semaphore
+//  Param:
+//      sem: semaphore
+//      count: initial count
+void Task_SemInit(Task_Sem *sem, uint32_t count);
+
+// Take a semaphore, waiting for it if its count is 0
+//  Param:
+//      sem: semaphore
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if taken, 0 on timeout
+int Task_SemTake(Task_Sem *sem, uint32_t timeout);
+
+// Give a semaphore, waking the highest priority task waiting on it
+//  Param:
+//      sem: semaphore
+void Task_SemGive(Task_Sem *sem);
+
+// Set up a queue
+//  Param:
+//      queue: queue
+//      buf: storage for length items of itemSize bytes
+//      itemSize: size of an item in bytes
+//      length: number of items the queue holds
+void Task_QueueInit(Task_Queue *queue, void *buf, uint16_t itemSize, uint16_t length);
+
+// Send an item to the back of a queue, waiting for space if it is full
+//  Param:
+//      queue: queue
+//      item: item to copy into the queue
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if sent, 0 on timeout
+int Task_QueueSend(Task_Queue *queue, const void *item, uint32_t timeout);
+
+// Receive an item from the front of a queue, waiting for one if it is empty
+//  Param:
+//      queue: queue
+//      item: where to copy the item to
+//      timeout: ticks to wait at most, TASK_NO_WAIT or TASK_FOREVER
+//  Return:
+//      1 if received, 0 on timeout
+int Task_QueueReceive(Task_Queue *queue, void *item, uint32_t timeout);
+
+// Interrupt handlers, set in startup_gcc.c
+void Task_SysTickISR(void);
+void Task_PendSVISR(void);
+
+#endif // TASK_H
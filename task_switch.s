@@ -0,0 +1,43 @@
+/* Context switch for the kernel in task.c */
+
+    .syntax unified
+    .thumb
+    .global Task_PendSVISR
+    .text
+    .align 2
+
+/*
+    Saves the context of Task_Current on its stack and restores Task_Next.
+    The hardware already stacked R0-R3, R12, LR, PC and xPSR, and S0-S15 and FPSCR if the
+    task used the FPU. The rest goes below them, with EXC_RETURN so the frame type is known
+    when switching back. The stack pointer is kept in the first member of Task.
+*/
+    .thumb_func
+Task_PendSVISR:
+    cpsid   i
+    ldr     r2, =Task_Current
+    ldr     r1, [r2]
+    cbz     r1, restore         /* first switch, nothing to save */
+
+    mrs     r0, psp
+    tst     lr, #0x10           /* bit 4 clear: extended frame, FPU was used */
+    it      eq
+    vstmdbeq r0!, {s16-s31}
+    stmdb   r0!, {r4-r11, lr}
+    str     r0, [r1]
+
+restore:
+    ldr     r3, =Task_Next
+    ldr     r1, [r3]
+    str     r1, [r2]
+    ldr     r0, [r1]
+    ldmia   r0!, {r4-r11, lr}
+    tst     lr, #0x10
+    it      eq
+    vldmiaeq r0!, {s16-s31}
+    msr     psp, r0
+    cpsie   i
+    bx      lr
+
+    .ltorg
+    .p2align 2
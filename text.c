@@ -0,0 +1,330 @@
+#include <stdarg.h>
+#include "text.h"
+
+// Colors of the cells of the run being flushed, encoded once. Kept off the stack, which they
+// would take 168 bytes of on every flush
+static LCD_Color _fg[TEXT_COLS], _bg[TEXT_COLS];
+
+static uint8_t Text_SameColor(pixel a, pixel b);
+static void Text_PutPadded(Text_Layer *text, const char *str, uint8_t len, uint8_t width,
+                           char pad, uint8_t left);
+static void Text_FlushRun(Text_Layer *text, uint8_t row, uint8_t start, uint8_t end);
+
+static uint8_t Text_SameColor(pixel a, pixel b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// Set up a text layer, filled with spaces in the given colors
+// The screen is assumed to show that already, so nothing is drawn until cells change
+//  Param:
+//      text: layer
+//      fg, bg: text and background colors
+void Text_Init(Text_Layer *text, pixel fg, pixel bg)
+{
+    Text_SetColor(text, fg, bg);
+    Text_Clear(text);
+    for (uint8_t row = 0; row < TEXT_ROWS; row++)
+        text->dirty[row] = 0;
+}
+
+// Set the colors used for new text
+//  Param:
+//      text: layer
+//      fg, bg: text and background colors
+void Text_SetColor(Text_Layer *text, pixel fg, pixel bg)
+{
+    text->fg = fg;
+    text->bg = bg;
+}
+
+// Move the cursor
+//  Param:
+//      text: layer
+//      col: column (0 - 20)
+//      row: row (0 - 15)
+void Text_Goto(Text_Layer *text, uint8_t col, uint8_t row)
+{
+    text->col = (col < TEXT_COLS) ? col : TEXT_COLS - 1;
+    text->row = (row < TEXT_ROWS) ? row : TEXT_ROWS - 1;
+}
+
+// Write a character at the cursor and move it to the next cell
+// '\n' moves the cursor to the start of the next row. Text going past the last column
+// continues on the next row, and past the last row it goes back to the first one
+//  Param:
+//      text: layer
+//      c: character
+void Text_PutChar(Text_Layer *text, char c)
+{
+    Text_Cell *cell;
+
+    if (c != '\n')
+    {
+        cell = &text->cells[text->row][text->col];
+        if (cell->c != c || !Text_SameColor(cell->fg, text->fg) || !Text_SameColor(cell->bg, text->bg))
+        {
+            cell->c = c;
+            cell->fg = text->fg;
+            cell->bg = text->bg;
+            text->dirty[text->row] |= 1u << text->col;
+        }
+    }
+
+    if (c == '\n' || ++text->col == TEXT_COLS)
+    {
+        text->col = 0;
+        if (++text->row == TEXT_ROWS)
+            text->row = 0;
+    }
+}
+
+// Write a string at the cursor
+//  Param:
+//      text: layer
+//      str: string
+void Text_PutString(Text_Layer *text, const char *str)
+{
+    while (*str)
+        Text_PutChar(text, *str++);
+}
+
+// Write len characters of str, padded up to width
+static void Text_PutPadded(Text_Layer *text, const char *str, uint8_t len, uint8_t width,
+                           char pad, uint8_t left)
+{
+    if (!left)
+        for (uint8_t i = len; i < width; i++)
+            Text_PutChar(text, pad);
+
+    for (uint8_t i = 0; i < len; i++)
+        Text_PutChar(text, str[i]);
+
+    if (left)
+        for (uint8_t i = len; i < width; i++)
+            Text_PutChar(text, ' ');
+}
+
+// Formatted write at the cursor, a small subset of printf
+// Supports %d, %u, %x, %c, %s and %%, with an optional '-' flag to align left,
+// '0' flag to pad numbers with zeros and a width, e.g. "%03u" or "%-6s"
+//  Param:
+//      text: layer
+//      fmt: format string
+//      ...: values
+void Text_Print(Text_Layer *text, const char *fmt, ...)
+{
+    va_list args;
+    char buf[12];
+    uint8_t left, width, len;
+    char pad;
+
+    va_start(args, fmt);
+    for (; *fmt; fmt++)
+    {
+        if (*fmt != '%')
+        {
+            Text_PutChar(text, *fmt);
+            continue;
+        }
+        fmt++;
+
+        // Flags and width
+        left = 0;
+        pad = ' ';
+        width = 0;
+        if (*fmt == '-')
+        {
+            left = 1;
+            fmt++;
+        }
+        if (*fmt == '0')
+        {
+            pad = '0';
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9')
+            width = width * 10 + *fmt++ - '0';
+
+        switch (*fmt)
+        {
+        case 'd':
+        case 'u':
+        case 'x':
+        {
+            uint32_t n, base = (*fmt == 'x') ? 16 : 10;
+            uint8_t neg = 0;
+            int32_t d;
+
+            if (*fmt == 'd')
+            {
+                d = va_arg(args, int);
+                neg = d < 0;
+                n = neg ? -(uint32_t) d : (uint32_t) d;
+            }
+            else
+                n = va_arg(args, unsigned int);
+
+            // Digits are written from the end of the buffer
+            len = 0;
+            do
+            {
+                buf[sizeof(buf) - 1 - len++] = "0123456789ABCDEF"[n % base];
+                n /= base;
+            } while (n);
+
+            if (neg)
+            {
+                // The sign goes before zero padding and after space padding
+                if (pad == '0')
+                {
+                    Text_PutChar(text, '-');
+                    if (width)
+                        width--;
+                }
+                else
+                    buf[sizeof(buf) - 1 - len++] = '-';
+            }
+            Text_PutPadded(text, &buf[sizeof(buf) - len], len, width, pad, left);
+            break;
+        }
+        case 'c':
+            buf[0] = (char) va_arg(args, int);
+            Text_PutPadded(text, buf, 1, width, ' ', left);
+            break;
+        case 's':
+        {
+            const char *str = va_arg(args, const char *);
+            for (len = 0; str[len]; len++);
+            Text_PutPadded(text, str, len, width, ' ', left);
+            break;
+        }
+        case '%':
+            Text_PutChar(text, '%');
+            break;
+        default:
+            // Unknown conversion, nothing sensible to print
+            if (!*fmt)
+                fmt--;
+            break;
+        }
+    }
+    va_end(args);
+}
+
+// Fill the whole layer with spaces in the current colors
+//  Param:
+//      text: layer
+void Text_Clear(Text_Layer *text)
+{
+    text->col = 0;
+    text->row = 0;
+    for (uint16_t i = 0; i < TEXT_COLS * TEXT_ROWS; i++)
+        Text_PutChar(text, ' ');
+}
+
+// Mark the cells under a rectangle of the screen to be redrawn, e.g. after drawing over them
+//  Param:
+//      text: layer
+//      x, y: top left corner in pixels
+//      w, h: size in pixels
+void Text_Touch(Text_Layer *text, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    // Cell (col, row) covers x from 6 * col to 6 * col + 6 and y from 8 * row + 1 to 8 * row + 8
+    int16_t col0 = max(0, (x - 1) / 6), col1 = min(TEXT_COLS - 1, (x + w - 1) / 6);
+    int16_t row0 = max(0, (y - 1) / 8), row1 = min(TEXT_ROWS - 1, (y + h - 2) / 8);
+    uint32_t bits;
+
+    if (w <= 0 || h <= 0 || col0 > col1 || row0 > row1)
+        return;
+
+    bits = ((1u << (col1 - col0 + 1)) - 1) << col0;
+    for (int16_t row = row0; row <= row1; row++)
+        text->dirty[row] |= bits;
+}
+
+// Mark every cell to be redrawn
+//  Param:
+//      text: layer
+void Text_Invalidate(Text_Layer *text)
+{
+    for (uint8_t row = 0; row < TEXT_ROWS; row++)
+        text->dirty[row] = (1u << TEXT_COLS) - 1;
+}
+
+// Draw cells [start, end) of a row in one window
+// Looks the same as LCD_gChar, including the background column left of the first character
+static void Text_FlushRun(Text_Layer *text, uint8_t row, uint8_t start, uint8_t end)
+{
+    int16_t y = row * 8 + 1;
+    uint8_t lines = min(8, LCD_HEIGHT - y);
+    Text_Cell *cells = text->cells[row];
+    LCD_Color *fg = _fg, *bg = _bg;
+
+    // Colors are encoded once for the whole run
+    for (uint8_t col = start; col < end; col++)
+    {
+        fg[col] = LCD_Encode(cells[col].fg);
+        bg[col] = LCD_Encode(cells[col].bg);
+    }
+
+    LCD_SetArea(start * 6, y, end * 6, y + lines - 1);
+    LCD_ActivateWrite();
+
+    // Pixels of the same color in a row are sent as one run
+    for (uint8_t line = 0; line < lines; line++)
+    {
+        LCD_Color run = bg[start];
+        uint8_t n = 1;
+
+        for (uint8_t col = start; col < end; col++)
+        {
+            const uint8_t *glyph = &LCD_Font[(uint8_t) cells[col].c * 5];
+
+            for (uint8_t i = 0; i <= 5; i++)
+            {
+                LCD_Color c = (i < 5 && (glyph[i] & (1 << line))) ? fg[col] : bg[col];
+
+                if (c != run)
+                {
+                    LCD_PushColor(run, n);
+                    run = c;
+                    n = 0;
+                }
+                n++;
+            }
+        }
+        LCD_PushColor(run, n);
+    }
+}
+
+// Draw the cells that changed since the last flush
+//  Param:
+//      text: layer
+void Text_Flush(Text_Layer *text)
+{
+    for (uint8_t row = 0; row < TEXT_ROWS; row++)
+    {
+        uint32_t dirty = text->dirty[row];
+        uint8_t col = 0, start;
+
+        if (!dirty)
+            continue;
+        text->dirty[row] = 0;
+
+        // Runs of dirty cells
+        while (col < TEXT_COLS)
+        {
+            if (!(dirty & (1u << col)))
+            {
+                col++;
+                continue;
+            }
+
+            start = col;
+            while (col < TEXT_COLS && (dirty & (1u << col)))
+                col++;
+            Text_FlushRun(text, row, start, col);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+/*
+    Character cell text layer. Keeps a character and its colors for every cell of the 21x16
+    grid used by LCD_gString, and marks the cells whose content changes. Text_Flush only
+    sends those cells, with neighbouring cells on the same row sent in a single window, so
+    text that did not change costs nothing to keep on screen.
+
+    Cells are always drawn with their background, there is no transparent text.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+#define TEXT_COLS 21
+#define TEXT_ROWS 16
+
+typedef struct Text_Cell
+{
+    char c;
+    pixel fg, bg;
+} Text_Cell;
+
+typedef struct Text_Layer
+{
+    Text_Cell cells[TEXT_ROWS][TEXT_COLS];
+    uint32_t dirty[TEXT_ROWS];      // one bit per column
+    uint8_t col, row;               // cursor
+    pixel fg, bg;                   // colors for new text
+} Text_Layer;
+
+// Set up a text layer, filled with spaces in the given colors
+// The screen is assumed to show that already, so nothing is drawn until cells change
+//  Param:
+//      text: layer
+//      fg, bg: text and background colors
+void Text_Init(Text_Layer *text, pixel fg, pixel bg);
+
+// Set the colors used for new text
+//  Param:
+//      text: layer
+//      fg, bg: text and background colors
+void Text_SetColor(Text_Layer *text, pixel fg, pixel bg);
+
+// Move the cursor
+//  Param:
+//      text: layer
+//      col: column (0 - 20)
+//      row: row (0 - 15)
+void Text_Goto(Text_Layer *text, uint8_t col, uint8_t row);
+
+// Write a character at the cursor and move it to the next cell
+// '\n' moves the cursor to the start of the next row. Text going past the last column
+// continues on the next row, and past the last row it goes back to the first one
+//  Param:
+//      text: layer
+//      c: character
+void Text_PutChar(Text_Layer *text, char c);
+
+// Write a string at the cursor
+//  Param:
+//      text: layer
+//      str: string
+void Text_PutString(Text_Layer *text, const char *str);
+
+// Formatted write at the cursor, a small subset of printf
+// Supports %d, %u, %x, %c, %s and %%, with an optional '-' flag to align left,
+// '0' flag to pad numbers with zeros and a width, e.g. "%03u" or "%-6s"
+//  Param:
+//      text: layer
+//      fmt: format string
+//      ...: values
+void Text_Print(Text_Layer *text, const char *fmt, ...);
+
+// Fill the whole layer with spaces in the current colors
+//  Param:
+//      text: layer
+void Text_Clear(Text_Layer *text);
+
+// Mark the cells under a rectangle of the screen to be redrawn, e.g. after drawing over them
+//  Param:
+//      text: layer
+//      x, y: top left corner in pixels
+//      w, h: size in pixels
+void Text_Touch(Text_Layer *text, int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Mark every cell to be redrawn
+//  Param:
+//      text: layer
+void Text_Invalidate(Text_Layer *text);
+
+// Draw the cells that changed since the last flush
+//  Param:
+//      text: layer
+void Text_Flush(Text_Layer *text);
+
+#endif // TEXT_H
@@ -17,6 +17,20 @@
 
 #define CLOCKS_PER_SEC 16000000
 
+// Places a function in SRAM, where it runs without flash wait states. ResetISR copies these
+// functions from flash at boot. Must be used on the prototype as well as on the definition,
+// as calls from flash need to be long calls to reach SRAM. Empty when headers are used by
+// host tools
+#if defined(__arm__)
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#else
+#define RAMFUNC
+#endif
+
+// Fixed point numbers, see fixed.h. 16.16 and 8.8 bits of integer and fraction
+typedef int32_t q16;
+typedef int16_t q8;
+
 typedef struct point
 {
     int32_t x, y;
@@ -27,4 +41,10 @@ typedef struct fpoint
     float x, y;
 } fpoint;
 
+// Point or vector of q16 numbers, used by the vector functions of fixed.h
+typedef struct qpoint
+{
+    q16 x, y;
+} qpoint;
+
 #endif // TIVA_GC_INC_H
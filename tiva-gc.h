@@ -7,6 +7,15 @@
 
 #include "tiva-ge.h"
 #include "LCD.h"
+#include "fixed.h"
+#include "ui.h"
+#include "text.h"
+#include "band.h"
+#include "lowres.h"
+#include "scan.h"
+#include "asset.h"
+#include "font.h"
+#include "affine.h"
 #include "delay.h"
 
 // ---------------------------
@@ -1,18 +1,36 @@
 #include "tiva-ge.h"
 #include "systick.h"
-#include "xorshift.h"
-#include "delay.h"
+#include "clock.h"
 
 GE_Button SW1 = {0}, SW2 = {0}, SEL = {0};
 GE_Joystick JS = {0};
+GE_Co GE_CoState = {0};
 
 static void (*_mainMenu)(void) = NULL;
+static void (*_mainMenuInit)(void) = NULL;
 static int (*_update)(void) = NULL;
+static const GE_Game *_game = NULL;
 
-static uint32_t xorshift32_state = 0x12345678;
+// Game arena, handed to the running game and reclaimed when it ends
+static uint64_t _arena[GE_ARENA_SIZE / sizeof(uint64_t)];
+static uint32_t _arenaTop = 0;
+
+Rand_State GE_RandGame, GE_RandFX;
+static uint32_t _randSeed = 0x12345678;
+
+// Intro card duration in ms, 0 skips it
+static uint32_t _introMs = 1500;
+// Cycles from the start of GE_Setup to the end of the first menu frame, 0 until then
+static uint32_t _bootCycles = 0;
+
+// Button debouncing, a press counts once the button has been closed for GE_DEBOUNCE_MS
+#define GE_DEBOUNCE_MS 10
+// Cycle count of when each button closed, 0 while open
+static uint64_t _closedSince[3] = {0};
 
 void GE_Input(void);
-void GE_Intro(void);
+void GE_Debounce(GE_Button *button, uint8_t raw, uint64_t *since, uint64_t now);
+int GE_Intro(void);
 
 int GE_STPop(void)
 {
@@ -31,55 +49,123 @@ char GE_STGetCount(void)
     return SYSTICK_CTRL_R >> 16;
 }
 
-uint32_t GE_Rand(void)
+uint64_t GE_NowCycles(void)
+{
+    return Clock_Get();
+}
+
+uint64_t GE_NowUs(void)
+{
+    return Clock_Get() / (CLOCKS_PER_SEC / 1000000);
+}
+
+uint64_t GE_ElapsedCycles(uint64_t since)
+{
+    return Clock_Get() - since;
+}
+
+uint64_t GE_ElapsedUs(uint64_t since)
+{
+    return (Clock_Get() - since) / (CLOCKS_PER_SEC / 1000000);
+}
+
+void GE_RandSeed(uint32_t seed)
 {
-    return xorshift32_state = xorshift32(xorshift32_state);
+    _randSeed = seed;
+    Rand_Seed(&GE_RandGame, seed);
+}
+
+uint32_t GE_RandGetSeed(void)
+{
+    return _randSeed;
 }
 
 // Performs input and screen initializations and clears screen to black.
 void GE_Setup(void)
 {
+    // Boot time measurement, DWT cycle counter
+    DEMCR_R |= 0x01000000;      // TRCENA
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= 0x01;         // CYCCNTENA
+
     // SysTick init
     SysTick_Init(CLOCKS_PER_SEC, OFF);
 
+    // Monotonic time base
+    Clock_Init();
+
+    // Output init, the LCD reset and sleep out waits run in the background
+    LCD_InitAsync();
+    Audio_Init();
+#ifdef GE_MIRROR
+    Mirror_Init();
+#endif
+
     // Input init
     InitGPIO_EdumkiiButtons();
     InitGPIO_EdumkiiJoystick();
 
-    // Output init
-    LCD_Init();
-    LCD_CS(LOW);
-
-    LCD_SetBGColor(LCD_BLACK);
-    LCD_gClear();
-
     // RNG seed, 32 bits of noise generated from ADC
     for (int i = 0; i < 8; i++)
     {
         JS.pos = Input_ReadJoystickRaw();
-        xorshift32_state ^= ((JS.pos.x & 0x03) << 2) | (JS.pos.y & 0x03);
-        xorshift32_state <<= 4;
+        _randSeed ^= ((JS.pos.x & 0x03) << 2) | (JS.pos.y & 0x03);
+        _randSeed <<= 4;
     }
+    GE_RandSeed(_randSeed);
+    Rand_Seed(&GE_RandFX, ~_randSeed);
 
     // Settings
     JS.threshold = (point) { .x = 1024, .y = 1024 };
+
+    // Let inputs stabilize, especially JS
+    for (int i = 0; i < 3; i++)
+    {
+        GE_Input();
+    }
+
+    // First frame
+    while (!LCD_InitDone());
+    LCD_CS(LOW);
+
+    LCD_SetBGColor(LCD_BLACK);
+    LCD_gClear();
+}
+
+// Debounce a button without waiting, using the time it has been closed for
+//  Param:
+//      button: button to update
+//      raw: current reading of the button
+//      since: time the button closed, kept between calls
+//      now: current time from GE_NowCycles
+void GE_Debounce(GE_Button *button, uint8_t raw, uint64_t *since, uint64_t now)
+{
+    button->pressed = 0;
+    if (!raw)
+    {
+        button->held = 0;
+        *since = 0;
+        return;
+    }
+
+    if (!*since)
+        *since = now | 1;   // never 0 while closed
+    if (!button->held && now - *since >= GE_DEBOUNCE_MS * (CLOCKS_PER_SEC / 1000))
+    {
+        button->pressed = 1;
+        button->held = 1;
+    }
 }
 
 // Reads from all input buttons and the joystick. Used by the game engine
 void GE_Input(void)
 {
-    uint8_t sw1_s, sw2_s, sel_s;
     point old = JS.pos;
+    uint64_t now = GE_NowCycles();
 
-    sw1_s = Input_ReadButtonRaw(BUTTON_EDUMKII_SW1);
-    sw2_s = Input_ReadButtonRaw(BUTTON_EDUMKII_SW2);
-    sel_s = Input_ReadButtonRaw(BUTTON_EDUMKII_SEL);
-    SW1.pressed = Input_ReadButton(BUTTON_EDUMKII_SW1);
-    SW2.pressed = Input_ReadButton(BUTTON_EDUMKII_SW2);
-    SEL.pressed = Input_ReadButton(BUTTON_EDUMKII_SEL);
-    SW1.held = SW1.pressed || (sw1_s && Input_ReadButtonRaw(BUTTON_EDUMKII_SW1));
-    SW2.held = SW2.pressed || (sw2_s && Input_ReadButtonRaw(BUTTON_EDUMKII_SW2));
-    SEL.held = SEL.pressed || (sel_s && Input_ReadButtonRaw(BUTTON_EDUMKII_SEL));
+    GE_Debounce(&SW1, Input_ReadButtonRaw(BUTTON_EDUMKII_SW1), &_closedSince[0], now);
+    GE_Debounce(&SW2, Input_ReadButtonRaw(BUTTON_EDUMKII_SW2), &_closedSince[1], now);
+    GE_Debounce(&SEL, Input_ReadButtonRaw(BUTTON_EDUMKII_SEL), &_closedSince[2], now);
 
     JS.pos = Input_ReadJoystick();
     JS.changed = (old.x != JS.pos.x || old.y != JS.pos.y);
@@ -112,11 +198,84 @@ void GE_SetMainMenu(void (*func)(void))
 void GE_SetUpdate(int (*func)(void))
 {
     _update = func;
+    _game = NULL;
+    GE_CoState.line = 0;
+}
+
+// Set the main menu init function, called whenever the main menu is entered, i.e. when the
+// gameloop starts and after every game ends
+//  Param:
+//      func: pointer to void function, can be NULL
+void GE_SetMainMenuInit(void (*func)(void))
+{
+    _mainMenuInit = func;
+}
+
+// Set the game to run
+// Like GE_SetUpdate, but also runs the init and exit functions of the game
+// Param:
+//      game: game to run
+void GE_SetGame(const GE_Game *game)
+{
+    _update = game->update;
+    _game = game;
+    GE_CoState.line = 0;
+}
+
+// Allocate memory from the game arena
+// Memory is zeroed and 8 byte aligned. It stays valid until the running game ends
+// Param:
+//      size: bytes to allocate
+// Return:
+//      pointer to the memory, NULL if the arena does not have enough space left
+void *GE_Alloc(uint32_t size)
+{
+    uint64_t *p;
+
+    size = (size + 7) >> 3;     // in 8 byte words
+    if (size > GE_ARENA_SIZE / 8 - _arenaTop)
+        return NULL;
+
+    p = &_arena[_arenaTop];
+    _arenaTop += size;
+    for (uint32_t i = 0; i < size; i++)
+        p[i] = 0;
+
+    return p;
+}
+
+// Get how much of the game arena is still available
+// Return:
+//      free bytes
+uint32_t GE_ArenaFree(void)
+{
+    return GE_ARENA_SIZE - (_arenaTop << 3);
+}
+
+// Set how long the intro card is shown. Pressing any button also ends it early
+//  Param:
+//      ms: duration in milliseconds, 0 skips the intro
+void GE_SetIntro(uint32_t ms)
+{
+    _introMs = ms;
+}
+
+// Get the time it took from GE_Setup to the first menu frame being drawn
+//  Return:
+//      Boot time in microseconds, 0 if the first frame is not done yet
+uint32_t GE_BootTime(void)
+{
+    return _bootCycles / (CLOCKS_PER_SEC / 1000000);
 }
 
 // Show a little intro card, with the project name and a small wireframe of the console
-void GE_Intro(void)
+// Runs as a coroutine, like a game
+//  Return:
+//      1 while the intro is shown, 0 once it ends
+int GE_Intro(void)
 {
+    GE_Begin();
+
     LCD_gFillRect(LCD_WIDTH / 8, LCD_HEIGHT / 8, LCD_WIDTH * 3 / 4, LCD_HEIGHT * 3 / 4, LCD_RED);
     LCD_gRect(LCD_WIDTH / 8, LCD_HEIGHT / 8, LCD_WIDTH * 3 / 4, LCD_HEIGHT * 3 / 4, 2, LCD_WHITE);
 
@@ -142,15 +301,23 @@ void GE_Intro(void)
 
     LCD_SetBGColor(LCD_BLACK);
 
-    delay(1500);
+    // Any button skips the rest of the intro, the press is consumed so the menu does not see it
+    GE_CoState.wake = GE_NowCycles() + (uint64_t) _introMs * (CLOCKS_PER_SEC / 1000);
+    GE_AwaitUntil(GE_NowCycles() >= GE_CoState.wake || SW1.pressed || SW2.pressed || SEL.pressed);
+
+    GE_End();
 }
 
 // Runs the main menu and gameloop
 void GE_Loop(void)
 {
-    LCD_SetBGColor(LCD_BLACK);
-    LCD_gClear();
-    GE_Intro();
+    if (_introMs)
+    {
+        GE_CoState.line = 0;
+        do
+            GE_Input();
+        while (GE_Intro());
+    }
 
     // Checks for menus or games set
     if (!_mainMenu && !_update)
@@ -160,28 +327,41 @@ void GE_Loop(void)
         while (1);
     }
 
-    // Let inputs stabilize, especially JS
-    for (int i = 0; i < 3; i++)
-    {
-        GE_Input();
-    }
-
     // Main program loop
     while (1)
     {
         // Menu
+        if (_mainMenuInit)
+            _mainMenuInit();
         while (!_update)
         {
             GE_Input();
             _mainMenu();
+#ifdef GE_MIRROR
+            Mirror_Frame();
+#endif
+
+            if (!_bootCycles)
+                _bootCycles = DWT_CYCCNT_R;
         }
 
         // Gameloop
+        _arenaTop = 0;
+        if (_game && _game->init)
+            _game->init();
         while (_update)
         {
             GE_Input();
             if (!_update())
                 _update = NULL;
+#ifdef GE_MIRROR
+            Mirror_Frame();
+#endif
         }
+        if (_game && _game->exit)
+            _game->exit();
+        _game = NULL;
+        Audio_Stop();
+        _arenaTop = 0;
     }
 }
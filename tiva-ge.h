@@ -11,6 +11,9 @@
 #include "LCD.h"
 #include "Input.h"
 #include "systick.h"
+#include "random.h"
+#include "audio.h"
+#include "mirror.h"
 #include "tiva-gc-inc.h"
 
 typedef struct GE_Button
@@ -30,9 +33,76 @@ typedef struct GE_Joystick
 
 extern GE_Joystick JS;
 
-// function pointer main menu
-
-// function pointer current game, can be null
+// Game description
+// A game is run by the engine from the moment it is set with GE_SetGame until its update
+// function returns 0. Its state should be allocated with GE_Alloc from init, as the arena
+// is reclaimed once the game ends and handed to the next one.
+typedef struct GE_Game
+{
+    const char *name;
+    void (*init)(void);     // called once before the first update, can be NULL
+    int (*update)(void);    // same as the function given to GE_SetUpdate
+    void (*exit)(void);     // called once after update returns 0, can be NULL
+} GE_Game;
+
+// Size of the game arena in bytes, enough for the largest game state, snake's at about 6 KB.
+// Games that need more can define it larger, their state is checked against it at build time
+#ifndef GE_ARENA_SIZE
+#define GE_ARENA_SIZE 6144
+#endif
+
+// Coroutine state of the running update function
+// An update function can be written as a sequence of steps that wait on time or input,
+// instead of a hand written state machine. Between GE_Begin and GE_End, the GE_Await macros
+// return to the gameloop while their condition is not met, so input keeps being read, and
+// the function resumes right after the macro on the next loop.
+// Local variables are not kept across waits, state has to be in the arena or be static.
+// The macros cannot be used inside a switch statement, and only one can be used per line.
+typedef struct GE_Co
+{
+    uint16_t line;      // where to resume, 0 to start from GE_Begin
+    uint64_t wake;      // wake up time of GE_Await, in GE_NowCycles cycles
+} GE_Co;
+
+// Coroutine state of the update function currently run by the engine, reset whenever the
+// update function or game is set
+extern GE_Co GE_CoState;
+
+// Start of the coroutine, must be the first statement of the update function
+#define GE_Begin()  switch (GE_CoState.line) { case 0:
+
+// End of the coroutine, ends the game when reached
+#define GE_End()    } GE_CoState.line = 0; return 0
+
+// Wait until cond is true, checked once every loop
+#define GE_AwaitUntil(cond)                         \
+    do {                                            \
+        GE_CoState.line = __LINE__; case __LINE__:  \
+        if (!(cond))                                \
+            return 1;                               \
+    } while (0)
+
+// Give the loop back for one iteration
+#define GE_Yield()                                  \
+    do {                                            \
+        GE_CoState.line = __LINE__;                 \
+        return 1;                                   \
+        case __LINE__:;                             \
+    } while (0)
+
+// Wait for some time to pass
+//  Param:
+//      ms: time in milliseconds
+#define GE_Await(ms)                                \
+    do {                                            \
+        GE_CoState.wake = GE_NowCycles() + (uint64_t) (ms) * (CLOCKS_PER_SEC / 1000); \
+        GE_AwaitUntil(GE_NowCycles() >= GE_CoState.wake); \
+    } while (0)
+
+// Wait for a button to be pressed
+//  Param:
+//      button: one of SW1, SW2, SEL
+#define GE_AwaitButton(button) GE_AwaitUntil((button).pressed)
 
 // Performs input and screen initializations and clears screen to black.
 void GE_Setup(void);
@@ -43,6 +113,12 @@ void GE_Setup(void);
 //      func: pointer to void function
 void GE_SetMainMenu(void (*func)(void));
 
+// Set the main menu init function, called whenever the main menu is entered, i.e. when the
+// gameloop starts and after every game ends
+//  Param:
+//      func: pointer to void function, can be NULL
+void GE_SetMainMenuInit(void (*func)(void));
+
 // Set update function/game
 // The logic for the game must be in a function to be looped by the game engine.
 // Input is handled by the engine, and the elapsed time is given as a parameter.
@@ -53,9 +129,65 @@ void GE_SetMainMenu(void (*func)(void));
 //      func: pointer to function taking one float parameter and returning int
 void GE_SetUpdate(int (*func)(void));
 
+// Set the game to run
+// Like GE_SetUpdate, but also runs the init and exit functions of the game
+// Param:
+//      game: game to run
+void GE_SetGame(const GE_Game *game);
+
+// Allocate memory from the game arena
+// Memory is zeroed and 8 byte aligned. It stays valid until the running game ends, there is
+// no way to free single allocations
+// Param:
+//      size: bytes to allocate
+// Return:
+//      pointer to the memory, NULL if the arena does not have enough space left
+void *GE_Alloc(uint32_t size);
+
+// Get how much of the game arena is still available
+// Return:
+//      free bytes
+uint32_t GE_ArenaFree(void);
+
+// Set how long the intro card is shown. Pressing any button also ends it early
+//  Param:
+//      ms: duration in milliseconds, 0 skips the intro
+void GE_SetIntro(uint32_t ms);
+
+// Get the time it took from GE_Setup to the first menu frame being drawn
+//  Return:
+//      Boot time in microseconds, 0 if the first frame is not done yet
+uint32_t GE_BootTime(void);
+
 // Runs the main gameloop
 void GE_Loop(void) __attribute__((noreturn));
 
+// Get time from the monotonic clock
+// Unlike SysTick, this clock never wraps or resets, so it can be shared by any number
+// of users. Take a timestamp and pass it to GE_ElapsedCycles or GE_ElapsedUs later
+// Return:
+//      Core clock cycles since GE_Setup
+uint64_t GE_NowCycles(void);
+
+// Get time from the monotonic clock
+// Return:
+//      Microseconds since GE_Setup
+uint64_t GE_NowUs(void);
+
+// Time passed since a timestamp, without modifying any state
+// Param:
+//      since: timestamp from GE_NowCycles
+// Return:
+//      Core clock cycles since the timestamp
+uint64_t GE_ElapsedCycles(uint64_t since);
+
+// Time passed since a timestamp, without modifying any state
+// Param:
+//      since: timestamp from GE_NowCycles
+// Return:
+//      Microseconds since the timestamp
+uint64_t GE_ElapsedUs(uint64_t since);
+
 // Get time from SysTick
 // Return:
 //      Ticks since last reload
@@ -71,10 +203,39 @@ int GE_STPop(void);
 //      1 if reloaded, 0 if not
 char GE_STGetCount(void);
 
-// Generate pseudo-random number
-// Uses an xorshift with 3 shifts for a period of 2^32 - 1
+// Random number streams, seeded from ADC noise in GE_Setup
+// GE_RandGame is used by GE_Rand and GE_RandRange and should only be used for game logic,
+// so the game plays out the same given the same seed and inputs. Anything else, like
+// visual effects, should use GE_RandFX
+extern Rand_State GE_RandGame, GE_RandFX;
+
+// Generate pseudo-random number from the gameplay stream
+// Uses xoshiro128** for a period of 2^128 - 1
 // Return:
 //      32 bit pseudo-random number
-uint32_t GE_Rand(void);
+static inline uint32_t GE_Rand(void)
+{
+    return Rand_Next(&GE_RandGame);
+}
+
+// Generate pseudo-random number in [0, n) from the gameplay stream, without modulo bias
+// Param:
+//      n: upper bound, exclusive. Must be greater than 0
+// Return:
+//      uniformly distributed number in [0, n)
+static inline uint32_t GE_RandRange(uint32_t n)
+{
+    return Rand_Range(&GE_RandGame, n);
+}
+
+// Reseed the gameplay stream, e.g. to replay a recorded game
+// Param:
+//      seed: any value
+void GE_RandSeed(uint32_t seed);
+
+// Get the seed the gameplay stream was last seeded with
+// Return:
+//      seed
+uint32_t GE_RandGetSeed(void);
 
 #endif // TIVA_GE_H
@@ -19,7 +19,7 @@ enable_language(ASM)
 set(CPU "-mcpu=cortex-m4")
 set(FPU "-mfpu=fpv4-sp-d16 -mfloat-abi=hard")
 set(CMAKE_ASM_FLAGS "${CMAKE_ASM_FLAGS} ${CPU}  ${FPU} -MD")
-set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mthumb ${CPU} ${FPU} -std=gnu99 -Os -ffunction-sections -fdata-sections -MD -Wall -pedantic -I${TIVAWARE_PATH}/inc -I${TIVAWARE_PATH}")
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mthumb ${CPU} ${FPU} -std=gnu99 -Os -ffunction-sections -fdata-sections -fstack-usage -MD -Wall -pedantic -I${TIVAWARE_PATH}/inc -I${TIVAWARE_PATH}")
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mthumb ${CPU} ${FPU}  -Os -ffunction-sections -fdata-sections -MD -Wall -pedantic -fno-exceptions -fno-rtti")
 
 set(CMAKE_SHARED_LIBRARY_LINK_C_FLAGS "")
@@ -31,6 +31,13 @@ add_definitions(-DPART_TM4C123GH6PM)
 add_definitions(-DTARGET_IS_TM4C123_RA1)
 add_definitions(-Dgcc)
 
+# Per-function stack usage, from the .su files written by -fstack-usage, largest first
+ADD_CUSTOM_TARGET("stack_usage" DEPENDS ${CMAKE_PROJECT_NAME}.axf
+  COMMAND sh -c "find . -name '*.su' -exec cat {} + | sort -k2 -n -r"
+  WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+  VERBATIM
+)
+
 set(FLASH_EXECUTABLE "lm4flash")
 ADD_CUSTOM_TARGET("flash" DEPENDS ${CMAKE_PROJECT_NAME}.axf 
   COMMAND ${CMAKE_OBJCOPY} -O binary ${CMAKE_PROJECT_NAME}.axf ${CMAKE_PROJECT_NAME}.bin 
@@ -0,0 +1,1301 @@
+/*
+    Asset compiler. Reads a JSON manifest listing the assets of the game, loads the PNG files
+    it names and writes the asset pack described in asset.h as a C array, along with a header
+    of asset IDs. The build runs it on assets/assets.json, see CMakeLists.txt.
+
+    Build and run from the project root:
+        cc -I. tools/assetc.c image.c pix.c -o assetc
+        ./assetc assets/assets.json assets.c asset_ids.h
+
+    The manifest is an array of assets, each an object with a "name" and a "type". The ID of
+    an asset is its position in the array, named ASSET_<NAME> in the header. File names are
+    relative to the manifest.
+
+        palette     "colors": ["#RRGGBB", ...], or "file": PNG whose opaque colors are taken
+                    in the order they first appear. At most 256 colors
+        bitmap      "file": PNG. "format": "indexed" (default) maps every pixel to the nearest
+                    color of "palette"; with "transparent": true, pixels with alpha under 128
+                    become index 0 and the others never do. "rgb565" keeps the colors,
+                    "compressed" keeps them in the format of image.h, up to 128 pixels wide
+        tiles       "file": PNG cut into 8x8 tiles, left to right and top to bottom, mapped
+                    like an indexed bitmap through "palette"
+        tilemap     "tiles": tiles asset, "width" and "height" in tiles, "data": tile numbers
+        font        "file": PNG strip of glyphs "width" pixels wide, as tall as the image
+                    (up to 8). Light opaque pixels are set. "first": first character, 32 if
+                    not given
+        sound       "notes": [[note, length], ...], MIDI note numbers with 0 for rests
+        face        "file": PNG strip of glyphs "width" pixels wide, like a font but any height.
+                    Glyphs are trimmed to their set columns, blank ones are "space" wide
+                    (half the width if not given). "first": first character of the strip, 32
+                    if not given; "range": first and last characters to keep, e.g. "09".
+                    "scale": 1 - 8, every pixel becomes scale x scale. "spacing": blank
+                    columns between glyphs, 1 if not given. "kerning": [["A", "V", -1], ...]
+                    changes the spacing of pairs of characters. Sizes are given unscaled
+
+    Only non-interlaced PNGs with 8 bits per channel, or palette images of any bit depth,
+    are read. Colors are rounded to RGB565.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <strings.h>
+#include "asset.h"
+#include "image.h"
+
+static const char *_context = "";
+
+static void die(const char *fmt, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "assetc: %s: ", _context);
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void *xmalloc(size_t size)
+{
+    void *p = calloc(1, size ? size : 1);
+    if (!p)
+        die("out of memory");
+    return p;
+}
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data;
+    long size;
+
+    if (!f)
+        die("cannot open %s", path);
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = xmalloc(size + 1);
+    if (fread(data, 1, size, f) != (size_t) size)
+        die("cannot read %s", path);
+    fclose(f);
+    data[size] = 0;
+    *len = size;
+    return data;
+}
+
+/* Output buffer
+ */
+
+typedef struct Buf
+{
+    uint8_t *data;
+    size_t len, cap;
+} Buf;
+
+static void put8(Buf *b, uint8_t v)
+{
+    if (b->len == b->cap)
+    {
+        b->cap = b->cap ? b->cap * 2 : 4096;
+        b->data = realloc(b->data, b->cap);
+        if (!b->data)
+            die("out of memory");
+    }
+    b->data[b->len++] = v;
+}
+
+static void put16(Buf *b, uint16_t v)
+{
+    put8(b, v);
+    put8(b, v >> 8);
+}
+
+static void put32(Buf *b, uint32_t v)
+{
+    put16(b, v);
+    put16(b, v >> 16);
+}
+
+static void align4(Buf *b)
+{
+    while (b->len & 3)
+        put8(b, 0);
+}
+
+/* Inflate, for the PNG image data
+ */
+
+typedef struct Inflate
+{
+    const uint8_t *src, *end;
+    uint32_t bits;
+    int count;
+    Buf out;
+} Inflate;
+
+typedef struct Huffman
+{
+    uint16_t counts[16];
+    uint16_t symbols[288];
+} Huffman;
+
+static int inf_bits(Inflate *s, int n)
+{
+    int v;
+
+    while (s->count < n)
+    {
+        if (s->src == s->end)
+            die("truncated image data");
+        s->bits |= (uint32_t) *s->src++ << s->count;
+        s->count += 8;
+    }
+    v = s->bits & ((1u << n) - 1);
+    s->bits >>= n;
+    s->count -= n;
+    return v;
+}
+
+static void inf_build(Huffman *h, const uint8_t *lengths, int n)
+{
+    uint16_t offsets[16];
+
+    memset(h->counts, 0, sizeof(h->counts));
+    for (int i = 0; i < n; i++)
+        h->counts[lengths[i]]++;
+    h->counts[0] = 0;
+    offsets[1] = 0;
+    for (int i = 1; i < 15; i++)
+        offsets[i + 1] = offsets[i] + h->counts[i];
+    for (int i = 0; i < n; i++)
+        if (lengths[i])
+            h->symbols[offsets[lengths[i]]++] = i;
+}
+
+static int inf_decode(Inflate *s, const Huffman *h)
+{
+    int code = 0, first = 0, index = 0;
+
+    for (int len = 1; len < 16; len++)
+    {
+        code |= inf_bits(s, 1);
+        if (code - first < h->counts[len])
+            return h->symbols[index + code - first];
+        index += h->counts[len];
+        first = (first + h->counts[len]) << 1;
+        code <<= 1;
+    }
+    die("bad compressed data");
+    return 0;
+}
+
+static void inf_block(Inflate *s, const Huffman *lit, const Huffman *dist)
+{
+    static const uint16_t lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const uint8_t lextra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const uint16_t dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                        8193, 12289, 16385, 24577 };
+    static const uint8_t dextra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    while (1)
+    {
+        int sym = inf_decode(s, lit), len, d;
+
+        if (sym < 256)
+        {
+            put8(&s->out, sym);
+            continue;
+        }
+        if (sym == 256)
+            return;
+
+        sym -= 257;
+        if (sym >= 29)
+            die("bad compressed data");
+        len = lbase[sym] + inf_bits(s, lextra[sym]);
+        sym = inf_decode(s, dist);
+        if (sym >= 30)
+            die("bad compressed data");
+        d = dbase[sym] + inf_bits(s, dextra[sym]);
+        if ((size_t) d > s->out.len)
+            die("bad compressed data");
+        while (len--)
+            put8(&s->out, s->out.data[s->out.len - d]);
+    }
+}
+
+static Buf inflate_zlib(const uint8_t *src, size_t len)
+{
+    static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    Inflate s = { .src = src + 2, .end = src + len };
+    Huffman lit, dist;
+    uint8_t lengths[320];
+    int last;
+
+    if (len < 2 || (src[0] & 0x0F) != 8)
+        die("unsupported compression");
+
+    do
+    {
+        int type;
+
+        last = inf_bits(&s, 1);
+        type = inf_bits(&s, 2);
+
+        if (type == 0)
+        {
+            uint16_t n;
+
+            s.bits = 0;
+            s.count = 0;
+            if (s.end - s.src < 4)
+                die("truncated image data");
+            n = s.src[0] | (s.src[1] << 8);
+            s.src += 4;
+            if (s.end - s.src < n)
+                die("truncated image data");
+            while (n--)
+                put8(&s.out, *s.src++);
+        }
+        else if (type == 1)
+        {
+            for (int i = 0; i < 288; i++)
+                lengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+            inf_build(&lit, lengths, 288);
+            for (int i = 0; i < 30; i++)
+                lengths[i] = 5;
+            inf_build(&dist, lengths, 30);
+            inf_block(&s, &lit, &dist);
+        }
+        else if (type == 2)
+        {
+            int nlit = inf_bits(&s, 5) + 257, ndist = inf_bits(&s, 5) + 1, ncode = inf_bits(&s, 4) + 4;
+            Huffman code;
+
+            memset(lengths, 0, sizeof(lengths));
+            for (int i = 0; i < ncode; i++)
+                lengths[order[i]] = inf_bits(&s, 3);
+            inf_build(&code, lengths, 19);
+
+            memset(lengths, 0, sizeof(lengths));
+            for (int i = 0; i < nlit + ndist; )
+            {
+                int sym = inf_decode(&s, &code), rep = 0, val = 0;
+
+                if (sym < 16)
+                {
+                    lengths[i++] = sym;
+                    continue;
+                }
+                if (sym == 16)
+                {
+                    if (!i)
+                        die("bad compressed data");
+                    val = lengths[i - 1];
+                    rep = 3 + inf_bits(&s, 2);
+                }
+                else if (sym == 17)
+                    rep = 3 + inf_bits(&s, 3);
+                else
+                    rep = 11 + inf_bits(&s, 7);
+                if (i + rep > nlit + ndist)
+                    die("bad compressed data");
+                while (rep--)
+                    lengths[i++] = val;
+            }
+            inf_build(&lit, lengths, nlit);
+            inf_build(&dist, lengths + nlit, ndist);
+            inf_block(&s, &lit, &dist);
+        }
+        else
+            die("bad compressed data");
+    } while (!last);
+
+    return s.out;
+}
+
+/* PNG
+ */
+
+typedef struct Image
+{
+    int width, height;
+    uint8_t *rgba;              // width * height * 4
+} Image;
+
+static uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static int paeth(int a, int b, int c)
+{
+    int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+        return a;
+    return (pb <= pc) ? b : c;
+}
+
+static Image load_png(const char *path)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    static const uint8_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    size_t len;
+    uint8_t *file = read_file(path, &len), *p = file + 8;
+    uint8_t plte[256][4], depth = 0, colorType = 0;
+    Buf idat = {0}, raw;
+    Image img = {0};
+    int bpp, stride;
+
+    memset(plte, 0xFF, sizeof(plte));
+    if (len < 8 || memcmp(file, signature, 8))
+        die("%s is not a PNG", path);
+
+    while (p + 12 <= file + len)
+    {
+        uint32_t n = be32(p);
+        const uint8_t *data = p + 8;
+
+        if (data + n + 4 > file + len)
+            die("%s is truncated", path);
+
+        if (!memcmp(p + 4, "IHDR", 4))
+        {
+            img.width = be32(data);
+            img.height = be32(data + 4);
+            depth = data[8];
+            colorType = data[9];
+            if (data[12])
+                die("%s: interlaced images are not supported", path);
+            if (colorType > 6 || !channels[colorType] || (colorType != 3 && depth != 8))
+                die("%s: only 8-bit channels or palette images are supported", path);
+        }
+        else if (!memcmp(p + 4, "PLTE", 4))
+            for (uint32_t i = 0; i < n / 3 && i < 256; i++)
+            {
+                plte[i][0] = data[i * 3];
+                plte[i][1] = data[i * 3 + 1];
+                plte[i][2] = data[i * 3 + 2];
+            }
+        else if (!memcmp(p + 4, "tRNS", 4) && colorType == 3)
+            for (uint32_t i = 0; i < n && i < 256; i++)
+                plte[i][3] = data[i];
+        else if (!memcmp(p + 4, "IDAT", 4))
+            for (uint32_t i = 0; i < n; i++)
+                put8(&idat, data[i]);
+        else if (!memcmp(p + 4, "IEND", 4))
+            break;
+        p += n + 12;
+    }
+    if (!img.width || !img.height)
+        die("%s has no image", path);
+
+    // Filters work on whole bytes, sub-byte palette images count as 1 byte per pixel for them
+    bpp = (colorType == 3) ? 1 : channels[colorType];
+    stride = (img.width * channels[colorType] * depth + 7) / 8;
+    raw = inflate_zlib(idat.data, idat.len);
+    if (raw.len < (size_t) (stride + 1) * img.height)
+        die("%s: image data is too short", path);
+
+    for (int y = 0; y < img.height; y++)
+    {
+        uint8_t *row = raw.data + y * (stride + 1) + 1, filter = row[-1];
+        const uint8_t *prev = y ? row - stride - 1 : NULL;
+
+        for (int x = 0; x < stride; x++)
+        {
+            int a = (x >= bpp) ? row[x - bpp] : 0, b = prev ? prev[x] : 0;
+            int c = (prev && x >= bpp) ? prev[x - bpp] : 0;
+
+            switch (filter)
+            {
+            case 0: break;
+            case 1: row[x] += a; break;
+            case 2: row[x] += b; break;
+            case 3: row[x] += (a + b) >> 1; break;
+            case 4: row[x] += paeth(a, b, c); break;
+            default: die("%s: bad filter", path);
+            }
+        }
+    }
+
+    img.rgba = xmalloc((size_t) img.width * img.height * 4);
+    for (int y = 0; y < img.height; y++)
+    {
+        const uint8_t *row = raw.data + y * (stride + 1) + 1;
+
+        for (int x = 0; x < img.width; x++)
+        {
+            uint8_t *out = &img.rgba[(y * img.width + x) * 4];
+            const uint8_t *in = &row[x * channels[colorType]];
+
+            switch (colorType)
+            {
+            case 0: out[0] = out[1] = out[2] = in[0]; out[3] = 255; break;
+            case 2: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255; break;
+            case 3:
+            {
+                int i = (row[x * depth / 8] >> (8 - depth - (x * depth) % 8)) & ((1 << depth) - 1);
+                memcpy(out, plte[i], 4);
+                break;
+            }
+            case 4: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break;
+            default: memcpy(out, in, 4); break;
+            }
+        }
+    }
+
+    free(file);
+    free(idat.data);
+    free(raw.data);
+    return img;
+}
+
+/* JSON
+ */
+
+typedef enum { J_NULL, J_BOOL, J_NUM, J_STR, J_ARR, J_OBJ } JType;
+
+typedef struct JNode
+{
+    JType type;
+    double num;
+    char *str;
+    struct JNode **items;
+    char **keys;
+    int count;
+} JNode;
+
+static const char *_json;
+
+static void json_space(void)
+{
+    while (isspace((unsigned char) *_json))
+        _json++;
+}
+
+static JNode *json_value(void);
+
+static char *json_string(void)
+{
+    Buf b = {0};
+
+    _json++;
+    while (*_json != '"')
+    {
+        if (!*_json)
+            die("unterminated string");
+        if (*_json == '\\')
+        {
+            _json++;
+            switch (*_json)
+            {
+            case 'n': put8(&b, '\n'); break;
+            case 't': put8(&b, '\t'); break;
+            case 0: die("unterminated string"); break;
+            default: put8(&b, *_json); break;
+            }
+            _json++;
+            continue;
+        }
+        put8(&b, *_json++);
+    }
+    _json++;
+    put8(&b, 0);
+    return (char *) b.data;
+}
+
+static void json_add(JNode *n, char *key, JNode *item)
+{
+    n->items = realloc(n->items, (n->count + 1) * sizeof(JNode *));
+    n->keys = realloc(n->keys, (n->count + 1) * sizeof(char *));
+    if (!n->items || !n->keys)
+        die("out of memory");
+    n->items[n->count] = item;
+    n->keys[n->count] = key;
+    n->count++;
+}
+
+static JNode *json_value(void)
+{
+    JNode *n = xmalloc(sizeof(JNode));
+
+    json_space();
+    if (*_json == '{' || *_json == '[')
+    {
+        char close = (*_json == '{') ? '}' : ']';
+
+        n->type = (close == '}') ? J_OBJ : J_ARR;
+        _json++;
+        json_space();
+        while (*_json != close)
+        {
+            char *key = NULL;
+
+            if (n->type == J_OBJ)
+            {
+                if (*_json != '"')
+                    die("expected a key near \"%.16s\"", _json);
+                key = json_string();
+                json_space();
+                if (*_json++ != ':')
+                    die("expected ':' after \"%s\"", key);
+            }
+            json_add(n, key, json_value());
+            json_space();
+            if (*_json == ',')
+            {
+                _json++;
+                json_space();
+            }
+            else if (*_json != close)
+                die("expected ',' or '%c' near \"%.16s\"", close, _json);
+        }
+        _json++;
+    }
+    else if (*_json == '"')
+    {
+        n->type = J_STR;
+        n->str = json_string();
+    }
+    else if (!strncmp(_json, "true", 4) || !strncmp(_json, "false", 5))
+    {
+        n->type = J_BOOL;
+        n->num = (*_json == 't');
+        _json += (*_json == 't') ? 4 : 5;
+    }
+    else if (!strncmp(_json, "null", 4))
+        _json += 4;
+    else
+    {
+        char *end;
+
+        n->type = J_NUM;
+        n->num = strtod(_json, &end);
+        if (end == _json)
+            die("unexpected \"%.16s\"", _json);
+        _json = end;
+    }
+    return n;
+}
+
+static JNode *json_get(const JNode *obj, const char *key)
+{
+    for (int i = 0; i < obj->count; i++)
+        if (!strcmp(obj->keys[i], key))
+            return obj->items[i];
+    return NULL;
+}
+
+static const char *json_str(const JNode *obj, const char *key, const char *def)
+{
+    JNode *n = json_get(obj, key);
+
+    if (!n)
+    {
+        if (!def)
+            die("missing \"%s\"", key);
+        return def;
+    }
+    if (n->type != J_STR)
+        die("\"%s\" must be a string", key);
+    return n->str;
+}
+
+static int json_int(const JNode *obj, const char *key, int def, int lo, int hi)
+{
+    JNode *n = json_get(obj, key);
+    int v;
+
+    if (!n)
+    {
+        if (def < lo)
+            die("missing \"%s\"", key);
+        return def;
+    }
+    if (n->type != J_NUM)
+        die("\"%s\" must be a number", key);
+    v = (int) n->num;
+    if (v < lo || v > hi)
+        die("\"%s\" must be %d - %d", key, lo, hi);
+    return v;
+}
+
+/* Assets
+ */
+
+typedef struct Asset
+{
+    const char *name;
+    uint8_t type, format;
+    const JNode *json;
+    // Palettes, for mapping other assets
+    uint32_t colors[256];       // 0xRRGGBB, already rounded to RGB565
+    int colorCount;
+} Asset;
+
+static Asset *_assets;
+static int _assetCount;
+static char _dir[1024];
+
+static uint16_t rgb565(int r, int g, int b)
+{
+    return (((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255);
+}
+
+static uint32_t rgb565_to_rgb(uint16_t c)
+{
+    int r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    return ((uint32_t) (r * 255 / 31) << 16) | ((g * 255 / 63) << 8) | (b * 255 / 31);
+}
+
+static int find_asset(const char *name, uint8_t type)
+{
+    for (int i = 0; i < _assetCount; i++)
+        if (!strcmp(_assets[i].name, name))
+        {
+            if (_assets[i].type != type)
+                die("\"%s\" has the wrong type", name);
+            return i;
+        }
+    die("no asset named \"%s\"", name);
+    return -1;
+}
+
+static Image load_asset_png(const Asset *a)
+{
+    char path[2048];
+
+    snprintf(path, sizeof(path), "%s%s", _dir, json_str(a->json, "file", NULL));
+    return load_png(path);
+}
+
+// Palette index of a pixel
+static uint8_t map_pixel(const Asset *pal, const uint8_t *rgba, int transparent)
+{
+    uint32_t c = rgb565_to_rgb(rgb565(rgba[0], rgba[1], rgba[2]));
+    int best = -1;
+    long bestDist = 0;
+
+    if (transparent && rgba[3] < 128)
+        return 0;
+
+    for (int i = transparent ? 1 : 0; i < pal->colorCount; i++)
+    {
+        long dr = (long) (c >> 16) - (pal->colors[i] >> 16);
+        long dg = (long) ((c >> 8) & 0xFF) - ((pal->colors[i] >> 8) & 0xFF);
+        long db = (long) (c & 0xFF) - (pal->colors[i] & 0xFF);
+        long dist = dr * dr * 3 + dg * dg * 4 + db * db * 2;
+
+        if (best < 0 || dist < bestDist)
+        {
+            best = i;
+            bestDist = dist;
+        }
+    }
+    if (best < 0)
+        die("palette has no usable colors");
+    return best;
+}
+
+static void add_color(Asset *a, uint32_t c)
+{
+    for (int i = 0; i < a->colorCount; i++)
+        if (a->colors[i] == c)
+            return;
+    if (a->colorCount == 256)
+        die("more than 256 colors");
+    a->colors[a->colorCount++] = c;
+}
+
+// Colors of a palette, so the assets after it can be mapped to it
+static void read_palette(Asset *a)
+{
+    const JNode *list = json_get(a->json, "colors");
+
+    if (list)
+    {
+        if (list->type != J_ARR)
+            die("\"colors\" must be an array");
+        for (int i = 0; i < list->count; i++)
+        {
+            unsigned int rgb;
+
+            if (list->items[i]->type != J_STR || sscanf(list->items[i]->str, "#%6x", &rgb) != 1)
+                die("colors must be \"#RRGGBB\"");
+            a->colors[a->colorCount++] = rgb565_to_rgb(rgb565(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF));
+            if (a->colorCount > 256)
+                die("more than 256 colors");
+        }
+    }
+    else
+    {
+        Image img = load_asset_png(a);
+
+        for (int i = 0; i < img.width * img.height; i++)
+            if (img.rgba[i * 4 + 3] >= 128)
+                add_color(a, rgb565_to_rgb(rgb565(img.rgba[i * 4], img.rgba[i * 4 + 1], img.rgba[i * 4 + 2])));
+        free(img.rgba);
+    }
+    if (!a->colorCount)
+        die("palette has no colors");
+}
+
+static void write_palette(Buf *b, Asset *a)
+{
+    put16(b, a->colorCount);
+    put16(b, 0);
+    for (int i = 0; i < a->colorCount; i++)
+        put16(b, rgb565(a->colors[i] >> 16, (a->colors[i] >> 8) & 0xFF, a->colors[i] & 0xFF));
+}
+
+// Runs of the previous color, split over as many run operations as needed
+static void encode_run(Buf *b, int run)
+{
+    while (run > IMAGE_RUN_MAX)
+    {
+        int m = (run < IMAGE_LONGRUN_MAX) ? run : IMAGE_LONGRUN_MAX;
+
+        put8(b, IMAGE_OP_LONGRUN | ((m - 65) >> 8));
+        put8(b, (m - 65) & 0xFF);
+        run -= m;
+    }
+    if (run)
+        put8(b, IMAGE_OP_RUN | (run - 1));
+}
+
+// Difference between channel values, wrapped to the range of a bits wide channel
+static int wrap(int d, int bits)
+{
+    int range = 1 << bits;
+
+    d &= range - 1;
+    return (d >= range / 2) ? d - range : d;
+}
+
+// Compress RGB565 pixels, see image.h. The result is decoded again to check it
+static void encode_image(Buf *b, const uint16_t *px, int n)
+{
+    uint16_t table[64] = {0}, prev = 0, *check;
+    size_t start = b->len;
+    int run = 0;
+    Image_Decoder dec;
+
+    for (int i = 0; i < n; i++)
+    {
+        uint16_t c = px[i];
+        int dr, dg, db;
+
+        if (c == prev)
+        {
+            run++;
+            continue;
+        }
+        encode_run(b, run);
+        run = 0;
+
+        if (table[IMAGE_HASH(c)] == c)
+        {
+            put8(b, IMAGE_OP_INDEX | IMAGE_HASH(c));
+            prev = c;
+            continue;
+        }
+        table[IMAGE_HASH(c)] = c;
+
+        dr = wrap((c >> 11) - (prev >> 11), 5);
+        dg = wrap(((c >> 5) & 0x3F) - ((prev >> 5) & 0x3F), 6);
+        db = wrap((c & 0x1F) - (prev & 0x1F), 5);
+
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            put8(b, IMAGE_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+        else
+        {
+            int base = (dg + 16) / 2 - 8;
+            int vr = wrap(dr - base, 5), vb = wrap(db - base, 5);
+
+            if (dg >= -16 && dg <= 15 && vr >= -8 && vr <= 7 && vb >= -8 && vb <= 7)
+            {
+                put8(b, IMAGE_OP_LUMA | (dg + 16));
+                put8(b, ((vr + 8) << 4) | (vb + 8));
+            }
+            else
+            {
+                put8(b, IMAGE_OP_COLOR);
+                put8(b, c >> 8);
+                put8(b, c & 0xFF);
+            }
+        }
+        prev = c;
+    }
+    encode_run(b, run);
+
+    check = xmalloc(n * sizeof(uint16_t));
+    Image_Begin(&dec, b->data + start);
+    Image_Decode(&dec, check, n);
+    if (memcmp(check, px, n * sizeof(uint16_t)) || dec.src != b->data + b->len)
+        die("compressed image does not decode back to the original");
+    free(check);
+}
+
+static void write_bitmap(Buf *b, Asset *a)
+{
+    const char *format = json_str(a->json, "format", "indexed");
+    Image img = load_asset_png(a);
+    int transparent = json_get(a->json, "transparent") && json_get(a->json, "transparent")->num;
+    int pal = -1;
+
+    if (img.width > 0xFFFF || img.height > 0xFFFF)
+        die("image is too large");
+
+    if (!strcmp(format, "rgb565"))
+        a->format = ASSET_RGB565;
+    else if (!strcmp(format, "compressed"))
+    {
+        a->format = ASSET_COMPRESSED;
+        if (img.width > LCD_WIDTH)
+            die("compressed images can be %d pixels wide at most", LCD_WIDTH);
+    }
+    else if (!strcmp(format, "indexed"))
+    {
+        a->format = ASSET_INDEXED8;
+        pal = find_asset(json_str(a->json, "palette", NULL), ASSET_PALETTE);
+    }
+    else
+        die("unknown format \"%s\"", format);
+
+    put16(b, img.width);
+    put16(b, img.height);
+    put16(b, (pal < 0) ? ASSET_NONE : pal);
+    put16(b, 0);
+
+    if (a->format == ASSET_COMPRESSED)
+    {
+        uint16_t *px = xmalloc(img.width * img.height * sizeof(uint16_t));
+        size_t start = b->len;
+
+        for (int i = 0; i < img.width * img.height; i++)
+            px[i] = rgb565(img.rgba[i * 4], img.rgba[i * 4 + 1], img.rgba[i * 4 + 2]);
+        encode_image(b, px, img.width * img.height);
+        printf("%s: %d bytes compressed to %zu\n", a->name, img.width * img.height * 2, b->len - start);
+        free(px);
+        free(img.rgba);
+        return;
+    }
+
+    for (int i = 0; i < img.width * img.height; i++)
+    {
+        const uint8_t *px = &img.rgba[i * 4];
+
+        if (a->format == ASSET_RGB565)
+            put16(b, rgb565(px[0], px[1], px[2]));
+        else
+            put8(b, map_pixel(&_assets[pal], px, transparent));
+    }
+    free(img.rgba);
+}
+
+static void write_tiles(Buf *b, Asset *a)
+{
+    Image img = load_asset_png(a);
+    int pal = find_asset(json_str(a->json, "palette", NULL), ASSET_PALETTE);
+    int cols = img.width / 8, rows = img.height / 8;
+    int transparent = json_get(a->json, "transparent") && json_get(a->json, "transparent")->num;
+
+    if (img.width % 8 || img.height % 8)
+        die("tile images must be a multiple of 8 pixels in both directions");
+    if (cols * rows > 256)
+        die("more than 256 tiles");
+
+    put16(b, cols * rows);
+    put16(b, pal);
+    for (int t = 0; t < cols * rows; t++)
+        for (int y = 0; y < 8; y++)
+            for (int x = 0; x < 8; x++)
+            {
+                int px = (t % cols) * 8 + x, py = (t / cols) * 8 + y;
+                put8(b, map_pixel(&_assets[pal], &img.rgba[(py * img.width + px) * 4], transparent));
+            }
+    a->colorCount = cols * rows;        // tile count, checked by tilemaps
+    free(img.rgba);
+}
+
+static void write_tilemap(Buf *b, Asset *a)
+{
+    int tiles = find_asset(json_str(a->json, "tiles", NULL), ASSET_TILES);
+    int w = json_int(a->json, "width", -1, 1, 255), h = json_int(a->json, "height", -1, 1, 255);
+    const JNode *data = json_get(a->json, "data");
+
+    if (!data || data->type != J_ARR || data->count != w * h)
+        die("\"data\" must be an array of width * height tile numbers");
+
+    put8(b, w);
+    put8(b, h);
+    put16(b, tiles);
+    for (int i = 0; i < w * h; i++)
+    {
+        int t = (int) data->items[i]->num;
+
+        if (data->items[i]->type != J_NUM || t < 0 || t >= _assets[tiles].colorCount)
+            die("tile %d of \"data\" is not in \"%s\"", i, _assets[tiles].name);
+        put8(b, t);
+    }
+}
+
+// Light opaque pixels are set in fonts and faces
+static int glyph_pixel(const Image *img, int x, int y)
+{
+    const uint8_t *px = &img->rgba[(y * img->width + x) * 4];
+
+    return px[3] >= 128 && px[0] * 3 + px[1] * 6 + px[2] >= 128 * 10;
+}
+
+static void write_font(Buf *b, Asset *a)
+{
+    Image img = load_asset_png(a);
+    int w = json_int(a->json, "width", -1, 1, 32), first = json_int(a->json, "first", 32, 0, 255);
+    int count = img.width / w;
+
+    if (img.height > 8)
+        die("font images can be 8 pixels tall at most");
+    if (first + count > 256)
+        die("glyphs go past character 255");
+
+    put8(b, first);
+    put8(b, count);
+    put8(b, w);
+    put8(b, img.height);
+    for (int i = 0; i < count * w; i++)
+    {
+        uint8_t column = 0;
+
+        for (int y = 0; y < img.height; y++)
+            if (glyph_pixel(&img, i, y))
+                column |= 1 << y;
+        put8(b, column);
+    }
+    free(img.rgba);
+}
+
+// Glyph rows as background and text run pairs, see font.h. Rows the same as the one above
+// are a single 0 byte
+static void encode_glyph(Buf *b, const Image *img, int x0, int w, int scale)
+{
+    Buf prev = {0};
+
+    for (int y = 0; y < img->height * scale; y++)
+    {
+        Buf row = {0};
+        int x = 0;
+
+        while (x < w * scale)
+        {
+            int bg = 0, fg = 0;
+
+            while (x < w * scale && !glyph_pixel(img, x0 + x / scale, y / scale))
+                bg++, x++;
+            while (x < w * scale && glyph_pixel(img, x0 + x / scale, y / scale))
+                fg++, x++;
+            while (bg > 15)
+            {
+                put8(&row, 0xF0);
+                bg -= 15;
+            }
+            while (fg > 15)
+            {
+                put8(&row, (bg << 4) | 15);
+                bg = 0;
+                fg -= 15;
+            }
+            put8(&row, (bg << 4) | fg);
+        }
+
+        if (y && row.len == prev.len && !memcmp(row.data, prev.data, row.len))
+            put8(b, 0);
+        else
+            for (size_t i = 0; i < row.len; i++)
+                put8(b, row.data[i]);
+        free(prev.data);
+        prev = row;
+    }
+    free(prev.data);
+}
+
+static int compare_kerning(const void *a, const void *b)
+{
+    const uint8_t *ka = a, *kb = b;
+
+    return (ka[0] << 8 | ka[1]) - (kb[0] << 8 | kb[1]);
+}
+
+static void write_face(Buf *b, Asset *a)
+{
+    Image img = load_asset_png(a);
+    int w = json_int(a->json, "width", -1, 1, 32), first = json_int(a->json, "first", 32, 0, 255);
+    int scale = json_int(a->json, "scale", 1, 1, 8), spacing = json_int(a->json, "spacing", 1, 0, 8);
+    int space = json_int(a->json, "space", (w + 1) / 2, 1, 32);
+    int count = img.width / w, lo = first, hi = first + count - 1;
+    const char *range = json_str(a->json, "range", "");
+    const JNode *kerning = json_get(a->json, "kerning");
+    int pairs = kerning ? kerning->count : 0;
+    uint8_t (*kern)[4];
+    Buf rows = {0};
+
+    if (first + count > 256)
+        die("glyphs go past character 255");
+    if (img.height * scale > LCD_HEIGHT || w * scale > 255)
+        die("glyphs are too large at scale %d", scale);
+    if (*range)
+    {
+        if (strlen(range) != 2 || (uint8_t) range[0] < lo || (uint8_t) range[1] > hi || range[0] > range[1])
+            die("\"range\" must be the first and last characters to keep, e.g. \"09\"");
+        lo = (uint8_t) range[0];
+        hi = (uint8_t) range[1];
+    }
+    if (kerning && kerning->type != J_ARR)
+        die("\"kerning\" must be an array of [left, right, adjust]");
+
+    put8(b, lo);
+    put8(b, hi - lo + 1);
+    put8(b, img.height * scale);
+    put8(b, spacing * scale);
+    put16(b, pairs);
+    put16(b, 0);
+
+    // Glyphs, trimmed to their set columns. Blank ones are "space" columns wide
+    for (int c = lo; c <= hi; c++)
+    {
+        int x0 = (c - first) * w, left = w, right = -1;
+
+        for (int x = 0; x < w; x++)
+            for (int y = 0; y < img.height; y++)
+                if (glyph_pixel(&img, x0 + x, y))
+                {
+                    left = (x < left) ? x : left;
+                    right = x;
+                }
+        if (right < 0)
+        {
+            left = 0;
+            right = space - 1;
+            x0 = -1;
+        }
+
+        if (rows.len > 0xFFFF)
+            die("glyphs take more than 64 KiB");
+        put16(b, rows.len);
+        put8(b, (right - left + 1) * scale);
+        put8(b, 0);
+        if (x0 < 0)
+        {
+            // Blank rows, one byte each if the glyph is narrow enough
+            Image blank = { .width = right + 1, .height = img.height };
+
+            blank.rgba = xmalloc(blank.width * blank.height * 4);
+            encode_glyph(&rows, &blank, 0, blank.width, scale);
+            free(blank.rgba);
+        }
+        else
+            encode_glyph(&rows, &img, x0 + left, right - left + 1, scale);
+    }
+
+    kern = xmalloc((pairs ? pairs : 1) * sizeof(*kern));
+    for (int i = 0; i < pairs; i++)
+    {
+        const JNode *k = kerning->items[i];
+
+        if (k->type != J_ARR || k->count != 3 || k->items[0]->type != J_STR || strlen(k->items[0]->str) != 1
+            || k->items[1]->type != J_STR || strlen(k->items[1]->str) != 1 || k->items[2]->type != J_NUM)
+            die("kerning pair %d must be [\"left\", \"right\", adjust]", i);
+        if (k->items[2]->num < -spacing || k->items[2]->num > 8)
+            die("kerning pair %d must adjust by %d - 8", i, -spacing);
+        kern[i][0] = k->items[0]->str[0];
+        kern[i][1] = k->items[1]->str[0];
+        kern[i][2] = (int8_t) (k->items[2]->num * scale);
+        kern[i][3] = 0;
+    }
+    qsort(kern, pairs, sizeof(*kern), compare_kerning);
+    for (int i = 0; i < pairs; i++)
+    {
+        if (i && !compare_kerning(kern[i - 1], kern[i]))
+            die("two kerning pairs for \"%c%c\"", kern[i][0], kern[i][1]);
+        for (int k = 0; k < 4; k++)
+            put8(b, kern[i][k]);
+    }
+
+    for (size_t i = 0; i < rows.len; i++)
+        put8(b, rows.data[i]);
+    printf("%s: %d glyphs %dx%d, %zu bytes of rows\n", a->name, hi - lo + 1, w * scale,
+           img.height * scale, rows.len);
+    free(kern);
+    free(rows.data);
+    free(img.rgba);
+}
+
+static void write_sound(Buf *b, Asset *a)
+{
+    const JNode *notes = json_get(a->json, "notes");
+
+    if (!notes || notes->type != J_ARR)
+        die("\"notes\" must be an array of [note, length]");
+
+    put16(b, notes->count);
+    put16(b, 0);
+    for (int i = 0; i < notes->count; i++)
+    {
+        const JNode *n = notes->items[i];
+
+        if (n->type != J_ARR || n->count != 2 || n->items[0]->num < 0 || n->items[0]->num > 131
+            || n->items[1]->num < 1 || n->items[1]->num > 255)
+            die("note %d must be [0 - 131, 1 - 255]", i);
+        put8(b, (int) n->items[0]->num);
+        put8(b, (int) n->items[1]->num);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const char *types[] = { NULL, "palette", "bitmap", "tiles", "tilemap", "font", "sound", "face" };
+    Buf pack = {0};
+    JNode *root;
+    size_t len;
+    FILE *f;
+    const char *slash;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "usage: %s manifest.json out.c out_ids.h\n", argv[0]);
+        return 1;
+    }
+
+    _context = argv[1];
+    slash = strrchr(argv[1], '/');
+    if (slash)
+        snprintf(_dir, sizeof(_dir), "%.*s/", (int) (slash - argv[1]), argv[1]);
+
+    _json = (const char *) read_file(argv[1], &len);
+    root = json_value();
+    if (root->type != J_ARR)
+        die("the manifest must be an array of assets");
+
+    _assetCount = root->count;
+    _assets = xmalloc(_assetCount * sizeof(Asset));
+    for (int i = 0; i < _assetCount; i++)
+    {
+        Asset *a = &_assets[i];
+
+        if (root->items[i]->type != J_OBJ)
+            die("asset %d is not an object", i);
+        a->json = root->items[i];
+        a->name = json_str(a->json, "name", NULL);
+        for (uint8_t t = ASSET_PALETTE; t <= ASSET_FACE; t++)
+            if (!strcmp(json_str(a->json, "type", NULL), types[t]))
+                a->type = t;
+        if (!a->type)
+            die("asset \"%s\" has an unknown type", a->name);
+        if (!isalpha((unsigned char) a->name[0]))
+            die("asset names must start with a letter");
+        for (uint8_t t = ASSET_PALETTE; t <= ASSET_FACE; t++)
+            if (!strcasecmp(a->name, types[t]))
+                die("\"%s\" would clash with ASSET_%s in asset.h", a->name, types[t]);
+        for (int j = 0; j < i; j++)
+            if (!strcmp(_assets[j].name, a->name))
+                die("two assets named \"%s\"", a->name);
+    }
+
+    // Header and entries, the entries are filled in as the assets are written
+    put32(&pack, ASSET_MAGIC);
+    put16(&pack, ASSET_VERSION);
+    put16(&pack, _assetCount);
+    for (int i = 0; i < _assetCount * 3; i++)
+        put32(&pack, 0);
+
+    // Palettes first, so they can be used by assets listed before them
+    for (int i = 0; i < _assetCount; i++)
+        if (_assets[i].type == ASSET_PALETTE)
+        {
+            _context = _assets[i].name;
+            read_palette(&_assets[i]);
+        }
+    // Tile counts, for tilemaps listed before their tiles
+    for (int i = 0; i < _assetCount; i++)
+        if (_assets[i].type == ASSET_TILES)
+        {
+            Buf scratch = {0};
+            _context = _assets[i].name;
+            write_tiles(&scratch, &_assets[i]);
+            free(scratch.data);
+        }
+
+    for (int i = 0; i < _assetCount; i++)
+    {
+        Asset *a = &_assets[i];
+        size_t start;
+        uint8_t *entry;
+
+        _context = a->name;
+        align4(&pack);
+        start = pack.len;
+        switch (a->type)
+        {
+        case ASSET_PALETTE: write_palette(&pack, a); break;
+        case ASSET_BITMAP:  write_bitmap(&pack, a); break;
+        case ASSET_TILES:   write_tiles(&pack, a); break;
+        case ASSET_TILEMAP: write_tilemap(&pack, a); break;
+        case ASSET_FONT:    write_font(&pack, a); break;
+        case ASSET_FACE:    write_face(&pack, a); break;
+        default:            write_sound(&pack, a); break;
+        }
+
+        entry = pack.data + sizeof(Asset_Header) + i * sizeof(Asset_Entry);
+        entry[0] = a->type;
+        entry[1] = a->format;
+        for (int k = 0; k < 4; k++)
+        {
+            entry[4 + k] = start >> (8 * k);
+            entry[8 + k] = (pack.len - start) >> (8 * k);
+        }
+    }
+    align4(&pack);
+
+    _context = argv[2];
+    f = fopen(argv[2], "w");
+    if (!f)
+        die("cannot write");
+    fprintf(f, "// Generated by tools/assetc.c from %s, do not edit\n\n", argv[1]);
+    fprintf(f, "#include <stdint.h>\n\n");
+    fprintf(f, "const uint32_t Asset_Pack[%zu] = {", pack.len / 4);
+    for (size_t i = 0; i < pack.len; i += 4)
+        fprintf(f, "%s0x%08X,", (i % 32) ? " " : "\n    ",
+                pack.data[i] | (pack.data[i + 1] << 8) | (pack.data[i + 2] << 16) | ((uint32_t) pack.data[i + 3] << 24));
+    fprintf(f, "\n};\n");
+    fclose(f);
+
+    _context = argv[3];
+    f = fopen(argv[3], "w");
+    if (!f)
+        die("cannot write");
+    fprintf(f, "// Generated by tools/assetc.c from %s, do not edit\n\n", argv[1]);
+    fprintf(f, "#ifndef ASSET_IDS_H\n#define ASSET_IDS_H\n\n");
+    for (int i = 0; i < _assetCount; i++)
+    {
+        fprintf(f, "#define ASSET_");
+        for (const char *c = _assets[i].name; *c; c++)
+            fputc(isalnum((unsigned char) *c) ? toupper((unsigned char) *c) : '_', f);
+        fprintf(f, " %d\n", i);
+    }
+    fprintf(f, "\n#endif // ASSET_IDS_H\n");
+    fclose(f);
+
+    printf("%s: %d assets, %zu bytes\n", argv[2], _assetCount, pack.len);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+    Rebuilds the screen from the stream sent by mirror.c and saves it as PPM images, one for
+    every frame that changed something. The stream format is described in mirror.h.
+
+    Build from the project root and run with the LaunchPad's serial port, or a file captured
+    from it:
+        cc -I. tools/mirrorview.c -o mirrorview
+        ./mirrorview /dev/ttyACM0 frames/
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "mirror.h"
+
+#define WIDTH  128
+#define HEIGHT 128
+
+static uint8_t screen[HEIGHT][WIDTH][3];
+static uint8_t window[4], cx, cy, hasWindow;
+static uint8_t colorA[3], colorB[3];
+
+// Open the input, setting up the serial port if it is one
+static FILE *open_input(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    struct termios tty;
+
+    if (fd < 0)
+        return NULL;
+
+    if (isatty(fd) && !tcgetattr(fd, &tty))
+    {
+        cfmakeraw(&tty);
+        cfsetispeed(&tty, B115200);     // MIRROR_BAUD
+        cfsetospeed(&tty, B115200);
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    return fdopen(fd, "rb");
+}
+
+static int save(const char *dir, unsigned index)
+{
+    char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/frame_%05u.ppm", dir, index);
+    f = fopen(path, "wb");
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+    fwrite(screen, 1, sizeof(screen), f);
+    fclose(f);
+    return 1;
+}
+
+// Fill n pixels of the window with a color, wrapping like the panel does
+static void fill(const uint8_t color[3], unsigned n)
+{
+    if (!hasWindow)
+        return;
+
+    while (n--)
+    {
+        memcpy(screen[cy][cx], color, 3);
+        if (++cx > window[2])
+        {
+            cx = window[0];
+            if (++cy > window[3])
+                cy = window[1];
+        }
+    }
+}
+
+// Read count bytes of a packet
+static int read_bytes(FILE *in, uint8_t *buf, size_t count)
+{
+    return fread(buf, 1, count, in) == count;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in;
+    uint8_t buf[4], tmp[3];
+    int c, synced = 0, changed = 0;
+    unsigned saved = 0, match = 0;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <serial port or capture> <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    in = open_input(argv[1]);
+    if (!in)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while ((c = fgetc(in)) != EOF)
+    {
+        // Look for a frame marker, everything before the first one is skipped
+        if (!synced)
+        {
+            static const uint8_t marker[3] = { MIRROR_FRAME, 0x5A, 0xA5 };
+
+            match = (c == marker[match]) ? match + 1 : (c == marker[0]);
+            if (match == 3)
+            {
+                if (fgetc(in) == EOF)
+                    break;
+                synced = 1;
+                match = 0;
+                hasWindow = 0;
+                memset(colorA, 0, 3);
+                memset(colorB, 0, 3);
+            }
+            continue;
+        }
+
+        switch (c & 0xC0)
+        {
+        case MIRROR_RUN_A:
+            fill(colorA, (c & 0x3F) + 1);
+            changed = 1;
+            continue;
+        case MIRROR_RUN_B:
+            memcpy(tmp, colorB, 3);
+            memcpy(colorB, colorA, 3);
+            memcpy(colorA, tmp, 3);
+            fill(colorA, (c & 0x3F) + 1);
+            changed = 1;
+            continue;
+        case MIRROR_RUN_NEW:
+            if (!read_bytes(in, buf, 3))
+                break;
+            memcpy(colorB, colorA, 3);
+            for (int i = 0; i < 3; i++)
+                colorA[i] = ((buf[i] & 0x3F) << 2) | ((buf[i] & 0x3F) >> 4);
+            fill(colorA, (c & 0x3F) + 1);
+            changed = 1;
+            continue;
+        }
+
+        switch (c)
+        {
+        case MIRROR_WINDOW:
+            if (!read_bytes(in, window, 4))
+                break;
+            if (window[2] >= WIDTH || window[3] >= HEIGHT || window[0] > window[2] || window[1] > window[3])
+            {
+                fprintf(stderr, "bad window, resyncing\n");
+                synced = 0;
+                break;
+            }
+            cx = window[0];
+            cy = window[1];
+            hasWindow = 1;
+            break;
+        case MIRROR_LOST:
+            if (!read_bytes(in, buf, 4))
+                break;
+            fprintf(stderr, "lost writes in %u,%u - %u,%u\n", buf[0], buf[1], buf[2], buf[3]);
+            break;
+        case MIRROR_FRAME:
+            if (!read_bytes(in, buf, 3))
+                break;
+            if (buf[0] != 0x5A || buf[1] != 0xA5)
+            {
+                fprintf(stderr, "bad frame marker, resyncing\n");
+                synced = 0;
+                break;
+            }
+            if (changed)
+            {
+                if (!save(argv[2], saved))
+                    return 1;
+                printf("frame %u -> frame_%05u.ppm\n", buf[2], saved++);
+                fflush(stdout);
+                changed = 0;
+            }
+            memset(colorA, 0, 3);
+            memset(colorB, 0, 3);
+            break;
+        default:
+            fprintf(stderr, "unknown packet 0x%02X, resyncing\n", c);
+            synced = 0;
+            break;
+        }
+    }
+
+    return 0;
+}
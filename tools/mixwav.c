@@ -0,0 +1,96 @@
+/*
+    Renders the mixer to a WAV file on the host, to hear and inspect sounds without the board.
+    Uses the same mixer.c that runs in the audio interrupt.
+
+    Build and run from the project root:
+        cc -I. tools/mixwav.c mixer.c -o mixwav
+        ./mixwav out.wav
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include "mixer.h"
+#include "audio.h"
+
+// Four bars over the three tonal voices, then a noise hit
+static const Mixer_Note melody[] = {
+    {72, 2}, {76, 2}, {79, 2}, {84, 2}, {83, 2}, {79, 2}, {76, 4},
+    {74, 2}, {77, 2}, {81, 2}, {86, 2}, {84, 4}, { 0, 4},
+};
+static const Mixer_Note bass[] = {
+    {48, 8}, {43, 8}, {50, 8}, {43, 8},
+};
+static const Mixer_Note arp[] = {
+    {60, 1}, {64, 1}, {67, 1}, {64, 1},
+};
+static const Mixer_Note drum[] = {
+    {96, 4}, { 0, 4},
+};
+
+static void put16(FILE *f, uint16_t v)
+{
+    fputc(v & 0xFF, f);
+    fputc(v >> 8, f);
+}
+
+static void put32(FILE *f, uint32_t v)
+{
+    put16(f, v & 0xFFFF);
+    put16(f, v >> 16);
+}
+
+int main(int argc, char **argv)
+{
+    static Mixer mixer;
+    static uint8_t samples[AUDIO_RATE * 4];
+    const uint32_t n = sizeof(samples);
+    FILE *f;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s out.wav\n", argv[0]);
+        return 1;
+    }
+
+    Mixer_Init(&mixer, AUDIO_RATE);
+    Mixer_SetTempo(&mixer, 120, 4);
+    Mixer_SetVoice(&mixer, 0, MIXER_SQUARE, 160);
+    Mixer_SetEnvelope(&mixer, 0, 5, 80, 120, 60);
+    Mixer_SetVoice(&mixer, 1, MIXER_TRIANGLE, 255);
+    Mixer_SetEnvelope(&mixer, 1, 10, 100, 200, 100);
+    Mixer_SetVoice(&mixer, 2, MIXER_SAW, 60);
+    Mixer_SetEnvelope(&mixer, 2, 1, 60, 0, 20);
+    Mixer_SetVoice(&mixer, 3, MIXER_NOISE, 120);
+    Mixer_SetEnvelope(&mixer, 3, 1, 40, 0, 10);
+
+    Mixer_Play(&mixer, 0, melody, sizeof(melody) / sizeof(melody[0]), 1);
+    Mixer_Play(&mixer, 1, bass, sizeof(bass) / sizeof(bass[0]), 1);
+    Mixer_Play(&mixer, 2, arp, sizeof(arp) / sizeof(arp[0]), 1);
+    Mixer_Play(&mixer, 3, drum, sizeof(drum) / sizeof(drum[0]), 1);
+    Mixer_Render(&mixer, samples, n);
+
+    f = fopen(argv[1], "wb");
+    if (!f)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    // 8-bit unsigned mono PCM, the format the buzzer plays
+    fwrite("RIFF", 1, 4, f);
+    put32(f, 36 + n);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put32(f, 16);
+    put16(f, 1);                // PCM
+    put16(f, 1);                // mono
+    put32(f, AUDIO_RATE);
+    put32(f, AUDIO_RATE);       // bytes per second
+    put16(f, 1);                // block align
+    put16(f, 8);                // bits per sample
+    fwrite("data", 1, 4, f);
+    put32(f, n);
+    fwrite(samples, 1, n, f);
+    fclose(f);
+
+    return 0;
+}
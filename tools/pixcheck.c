@@ -0,0 +1,189 @@
+/*
+    Checks the pixel kernels in pix.c against plain per-pixel versions, on random data with
+    every alignment and length up to a few words. Built on the host, this runs the C versions
+    of the SIMD instructions; they must match the M4 instructions, which the same checks
+    confirm when pix.c is built for the board.
+
+    Build and run from the project root:
+        cc -I. tools/pixcheck.c pix.c -o pixcheck
+        ./pixcheck
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pix.h"
+
+#define LEN 64
+
+static uint32_t _seed = 12345;
+static int _failed = 0;
+
+static uint8_t rnd(void)
+{
+    _seed = _seed * 1103515245 + 12345;
+    return _seed >> 16;
+}
+
+static void fill(void *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        ((uint8_t *) buf)[i] = rnd();
+}
+
+static void check(const char *name, const void *got, const void *want, size_t bytes, int off, int n)
+{
+    if (memcmp(got, want, bytes))
+    {
+        printf("%s: mismatch at offset %d, length %d\n", name, off, n);
+        _failed = 1;
+    }
+}
+
+int main(void)
+{
+    // Guard pixels on both sides catch writes outside the run
+    static uint16_t a16[LEN + 8], b16[LEN + 8], got16[LEN + 8], want16[LEN + 8];
+    static uint8_t a8[LEN * 3 + 8], b8[LEN * 3 + 8], got8[LEN * 3 + 8], want8[LEN * 3 + 8];
+    static uint16_t palette[256];
+
+    fill(palette, sizeof(palette));
+
+    for (int round = 0; round < 50; round++)
+    for (int n = 0; n <= 24; n++)
+    {
+        // 16-bit kernels at both halfword alignments, byte kernels at word alignment
+        for (int off = 0; off < 2; off++)
+        {
+            uint16_t color = rnd() | (rnd() << 8);
+            pixel p = { .r = rnd() & 0x3F, .g = rnd() & 0x3F, .b = rnd() & 0x3F };
+
+            fill(a16, sizeof(a16));
+            fill(b16, sizeof(b16));
+            fill(a8, sizeof(a8));
+            fill(b8, sizeof(b8));
+
+            // Fill16
+            memcpy(got16, a16, sizeof(a16));
+            memcpy(want16, a16, sizeof(a16));
+            Pix_Fill16(got16 + off, color, n);
+            for (int i = 0; i < n; i++)
+                want16[off + i] = color;
+            check("Pix_Fill16", got16, want16, sizeof(got16), off, n);
+
+            // Expand16
+            memcpy(got16, a16, sizeof(a16));
+            memcpy(want16, a16, sizeof(a16));
+            Pix_Expand16(got16 + off, a8 + off, palette, n);
+            for (int i = 0; i < n; i++)
+                want16[off + i] = palette[a8[off + i]];
+            check("Pix_Expand16", got16, want16, sizeof(got16), off, n);
+
+            // Blend16, dst and sources at the same or different alignments
+            memcpy(got16, a16, sizeof(a16));
+            memcpy(want16, a16, sizeof(a16));
+            Pix_Blend16(got16 + off, a16 + 2, b16 + 1 + off, n);
+            for (int i = 0; i < n; i++)
+            {
+                uint16_t x = a16[2 + i], y = b16[1 + off + i];
+                uint16_t r = ((x >> 11) + (y >> 11)) >> 1;
+                uint16_t g = (((x >> 5) & 0x3F) + ((y >> 5) & 0x3F)) >> 1;
+                uint16_t b = ((x & 0x1F) + (y & 0x1F)) >> 1;
+                want16[off + i] = (r << 11) | (g << 5) | b;
+            }
+            check("Pix_Blend16", got16, want16, sizeof(got16), off, n);
+
+            // 24To16
+            memcpy(got16, a16, sizeof(a16));
+            memcpy(want16, a16, sizeof(a16));
+            Pix_24To16(got16 + off, a8, n);
+            for (int i = 0; i < n; i++)
+                want16[off + i] = ((a8[i * 3] >> 3) << 11) | ((a8[i * 3 + 1] >> 2) << 5) | (a8[i * 3 + 2] >> 3);
+            check("Pix_24To16", got16, want16, sizeof(got16), off, n);
+
+            if (off)
+                continue;
+
+            // Expand16x2
+            memcpy(got16, a16, sizeof(a16));
+            memcpy(want16, a16, sizeof(a16));
+            Pix_Expand16x2(got16, a8, palette, n / 2);
+            for (int i = 0; i < n / 2 * 2; i++)
+                want16[i] = palette[a8[i / 2]];
+            check("Pix_Expand16x2", got16, want16, sizeof(got16), off, n);
+
+            // Fill24
+            memcpy(got8, a8, sizeof(a8));
+            memcpy(want8, a8, sizeof(a8));
+            Pix_Fill24(got8, LCD_Encode(p), n);
+            for (int i = 0; i < n; i++)
+            {
+                want8[i * 3] = p.r << 2;
+                want8[i * 3 + 1] = p.g << 2;
+                want8[i * 3 + 2] = p.b << 2;
+            }
+            check("Pix_Fill24", got8, want8, sizeof(got8), off, n);
+
+            // 16To24, every 5-bit and 6-bit value has to reach the same 6-bit value as
+            // scaling to 63 and rounding would, give or take one
+            memcpy(got8, a8, sizeof(a8));
+            Pix_16To24(got8, a16, n);
+            for (int i = 0; i < n; i++)
+            {
+                int r = (a16[i] >> 11) * 63 * 2 / 31, b = (a16[i] & 0x1F) * 63 * 2 / 31;
+                if (abs((got8[i * 3] >> 2) - (r + 1) / 2) > 1 || got8[i * 3 + 1] >> 2 != ((a16[i] >> 5) & 0x3F)
+                    || abs((got8[i * 3 + 2] >> 2) - (b + 1) / 2) > 1 || (got8[i * 3] & 3))
+                {
+                    printf("Pix_16To24: bad value %04X at %d\n", a16[i], i);
+                    _failed = 1;
+                }
+            }
+            if (memcmp(got8 + n * 3, a8 + n * 3, sizeof(a8) - n * 3))
+            {
+                printf("Pix_16To24: wrote past length %d\n", n);
+                _failed = 1;
+            }
+
+            // Byte kernels
+            memcpy(got8, a8, sizeof(a8));
+            memcpy(want8, a8, sizeof(a8));
+            Pix_Blend8(got8, a8, b8, n);
+            for (int i = 0; i < n; i++)
+                want8[i] = (a8[i] + b8[i]) >> 1;
+            check("Pix_Blend8", got8, want8, sizeof(got8), off, n);
+
+            for (int alpha = 0; alpha <= 256; alpha += 32)
+            {
+                memcpy(got8, a8, sizeof(a8));
+                memcpy(want8, a8, sizeof(a8));
+                Pix_Alpha8(got8, b8, alpha, n);
+                for (int i = 0; i < n; i++)
+                    want8[i] = (b8[i] * alpha + a8[i] * (256 - alpha)) >> 8;
+                check("Pix_Alpha8", got8, want8, sizeof(got8), alpha, n);
+            }
+
+            memcpy(got8, a8, sizeof(a8));
+            memcpy(want8, a8, sizeof(a8));
+            Pix_AddSat8(got8, b8, n);
+            for (int i = 0; i < n; i++)
+                want8[i] = (a8[i] + b8[i] > 255) ? 255 : a8[i] + b8[i];
+            check("Pix_AddSat8", got8, want8, sizeof(got8), off, n);
+
+            // Key8 with plenty of transparent indices
+            for (int i = 0; i < n; i++)
+                if (b8[i] & 1)
+                    b8[i] = 0;
+            memcpy(got8, a8, sizeof(a8));
+            memcpy(want8, a8, sizeof(a8));
+            Pix_Key8(got8, b8, n);
+            for (int i = 0; i < n; i++)
+                if (b8[i])
+                    want8[i] = b8[i];
+            check("Pix_Key8", got8, want8, sizeof(got8), off, n);
+        }
+    }
+
+    printf(_failed ? "FAILED\n" : "all kernels match\n");
+    return _failed;
+}
@@ -0,0 +1,247 @@
+#include "ui.h"
+
+static uint8_t UI_SameColor(pixel a, pixel b);
+static void UI_Text(int16_t col, int16_t row, uint8_t width, const char *text, pixel fg, pixel bg);
+static void UI_DrawList(UI_List *list);
+static void UI_DrawSelector(UI_Selector *selector);
+
+static uint8_t UI_SameColor(pixel a, pixel b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// Draw text padded with the background up to width characters
+static void UI_Text(int16_t col, int16_t row, uint8_t width, const char *text, pixel fg, pixel bg)
+{
+    pixel old = LCD_GetSettings().BGColor;
+    uint32_t n;
+
+    LCD_SetBGColor(bg);
+    n = LCD_gString(col, row, text, width, fg);
+    if (n < width && !UI_SameColor(fg, bg))
+        LCD_gFillRect((col + n) * 6, row * 8, (width - n) * 6, 8, bg);
+    LCD_SetBGColor(old);
+}
+
+// Set up a panel
+//  Param:
+//      panel: panel
+//      x, y: top left corner in pixels
+//      width, height: size in pixels
+//      color: fill color
+void UI_PanelInit(UI_Panel *panel, int16_t x, int16_t y, uint8_t width, uint8_t height, pixel color)
+{
+    panel->w.type = UI_PANEL;
+    panel->w.damage = UI_DAMAGE_ALL;
+    panel->x = x;
+    panel->y = y;
+    panel->width = width;
+    panel->height = height;
+    panel->color = color;
+}
+
+// Set up a label
+//  Param:
+//      label: label
+//      col, row: position of the first character
+//      width: characters taken up, the text is cut or padded to it
+//      text: text to show
+//      fg, bg: text and background colors. If they are the same, the background is not drawn
+void UI_LabelInit(UI_Label *label, int16_t col, int16_t row, uint8_t width, const char *text,
+                  pixel fg, pixel bg)
+{
+    label->w.type = UI_LABEL;
+    label->w.damage = UI_DAMAGE_ALL;
+    label->col = col;
+    label->row = row;
+    label->width = width;
+    label->text = text;
+    label->fg = fg;
+    label->bg = bg;
+}
+
+// Change the text of a label
+//  Param:
+//      label: label
+//      text: text to show
+void UI_LabelSetText(UI_Label *label, const char *text)
+{
+    label->text = text;
+    label->w.damage = UI_DAMAGE_ALL;
+}
+
+// Set up a list, with the first item selected
+//  Param:
+//      list: list
+//      col, row: position of the first item
+//      width: characters taken up by each item
+//      item: function giving the text of each item
+//      count: number of items, up to 32
+//      fg, bg: colors of the items that are not selected
+void UI_ListInit(UI_List *list, int16_t col, int16_t row, uint8_t width,
+                 const char *(*item)(uint8_t index), uint8_t count, pixel fg, pixel bg)
+{
+    list->w.type = UI_LIST;
+    list->w.damage = UI_DAMAGE_ALL;
+    list->col = col;
+    list->row = row;
+    list->width = width;
+    list->item = item;
+    list->count = count;
+    list->selected = 0;
+    list->held = 0;
+    list->fg = fg;
+    list->bg = bg;
+    list->selFg = LCD_BLACK;
+    list->selBg = LCD_LIGHT_GREY;
+    list->heldBg = LCD_WHITE;
+}
+
+// Select an item of a list
+//  Param:
+//      list: list
+//      index: item to select
+void UI_ListSelect(UI_List *list, uint8_t index)
+{
+    if (index == list->selected || index >= list->count)
+        return;
+
+    list->w.damage |= (1u << list->selected) | (1u << index);
+    list->selected = index;
+}
+
+// Move the selection of a list, wrapping around at either end
+//  Param:
+//      list: list
+//      delta: items to move by, negative to move up
+void UI_ListMove(UI_List *list, int8_t delta)
+{
+    int16_t i = (list->selected + delta) % list->count;
+
+    UI_ListSelect(list, (i < 0) ? i + list->count : i);
+}
+
+// Show the selected item of a list as held or not
+//  Param:
+//      list: list
+//      held: 1 if held
+void UI_ListSetHeld(UI_List *list, uint8_t held)
+{
+    if (held == list->held)
+        return;
+
+    list->held = held;
+    list->w.damage |= 1u << list->selected;
+}
+
+// Set up a selector, with the first value selected
+//  Param:
+//      selector: selector
+//      col, row: position of the left arrow
+//      width: characters taken up by the values
+//      values: text of each value
+//      count: number of values
+//      fg, bg: colors
+void UI_SelectorInit(UI_Selector *selector, int16_t col, int16_t row, uint8_t width,
+                     const char *const *values, uint8_t count, pixel fg, pixel bg)
+{
+    selector->w.type = UI_SELECTOR;
+    selector->w.damage = UI_DAMAGE_ALL;
+    selector->col = col;
+    selector->row = row;
+    selector->width = width;
+    selector->values = values;
+    selector->count = count;
+    selector->selected = 0;
+    selector->fg = fg;
+    selector->bg = bg;
+}
+
+// Move the value of a selector, wrapping around at either end
+// Only the value is redrawn, the arrows stay
+//  Param:
+//      selector: selector
+//      delta: values to move by
+void UI_SelectorMove(UI_Selector *selector, int8_t delta)
+{
+    int16_t i = (selector->selected + delta) % selector->count;
+
+    if (i < 0)
+        i += selector->count;
+    if (i == selector->selected)
+        return;
+
+    selector->selected = i;
+    selector->w.damage |= 1;
+}
+
+// Mark a whole widget to be redrawn
+//  Param:
+//      widget: widget
+void UI_Damage(UI_Widget *widget)
+{
+    widget->damage = UI_DAMAGE_ALL;
+}
+
+static void UI_DrawList(UI_List *list)
+{
+    for (uint8_t i = 0; i < list->count; i++)
+    {
+        if (!(list->w.damage & (1u << i)))
+            continue;
+
+        if (i == list->selected)
+            UI_Text(list->col, list->row + i, list->width, list->item(i), list->selFg,
+                    list->held ? list->heldBg : list->selBg);
+        else
+            UI_Text(list->col, list->row + i, list->width, list->item(i), list->fg, list->bg);
+    }
+}
+
+static void UI_DrawSelector(UI_Selector *selector)
+{
+    if (selector->w.damage == UI_DAMAGE_ALL)
+    {
+        UI_Text(selector->col, selector->row, 1, "<", selector->fg, selector->bg);
+        UI_Text(selector->col + 1 + selector->width, selector->row, 1, ">", selector->fg, selector->bg);
+    }
+    UI_Text(selector->col + 1, selector->row, selector->width, selector->values[selector->selected],
+            selector->fg, selector->bg);
+}
+
+// Draw the damaged parts of a screen
+//  Param:
+//      widgets: widgets of the screen, drawn in order
+//      n: number of widgets
+void UI_Draw(UI_Widget *const *widgets, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++)
+    {
+        UI_Widget *w = widgets[i];
+        if (!w->damage)
+            continue;
+
+        switch (w->type)
+        {
+        case UI_PANEL:
+        {
+            UI_Panel *p = (UI_Panel *) w;
+            LCD_gFillRect(p->x, p->y, p->width, p->height, p->color);
+            break;
+        }
+        case UI_LABEL:
+        {
+            UI_Label *l = (UI_Label *) w;
+            UI_Text(l->col, l->row, l->width, l->text, l->fg, l->bg);
+            break;
+        }
+        case UI_LIST:
+            UI_DrawList((UI_List *) w);
+            break;
+        case UI_SELECTOR:
+            UI_DrawSelector((UI_Selector *) w);
+            break;
+        }
+        w->damage = 0;
+    }
+}
@@ -0,0 +1,159 @@
+#ifndef UI_H
+#define UI_H
+
+/*
+    Retained mode widgets for menus. Widgets keep their own state and remember which parts of
+    them changed since they were last drawn, so UI_Draw only sends those parts to the LCD.
+    Moving the selection of a list redraws the two rows involved, not the whole list.
+
+    Widgets are placed on the 21x16 text grid used by LCD_gString, except panels, which are
+    placed in pixels. A screen is an array of widget pointers drawn in order, so later
+    widgets are drawn over earlier ones. Redrawing a widget does not redraw the ones over it,
+    damage them too with UI_Damage if they overlap.
+*/
+
+#include <stdint.h>
+#include "LCD.h"
+
+#define UI_DAMAGE_ALL 0xFFFFFFFF
+
+typedef enum UI_Type
+{
+    UI_PANEL,
+    UI_LABEL,
+    UI_LIST,
+    UI_SELECTOR
+} UI_Type;
+
+// Common part of all widgets, must be the first member of each one
+typedef struct UI_Widget
+{
+    UI_Type type;
+    uint32_t damage;        // parts to redraw, one bit per row for lists
+} UI_Widget;
+
+// Filled rectangle, in pixels
+typedef struct UI_Panel
+{
+    UI_Widget w;
+    int16_t x, y;
+    uint8_t width, height;
+    pixel color;
+} UI_Panel;
+
+// Single line of text, padded with the background up to width characters
+typedef struct UI_Label
+{
+    UI_Widget w;
+    int16_t col, row;
+    uint8_t width;
+    const char *text;
+    pixel fg, bg;
+} UI_Label;
+
+// Vertical list of items with one selected, up to 32 items
+// The selected item can be shown as held, e.g. while the select button is down
+typedef struct UI_List
+{
+    UI_Widget w;
+    int16_t col, row;
+    uint8_t width;
+    const char *(*item)(uint8_t index);     // text of each item
+    uint8_t count, selected, held;
+    pixel fg, bg;
+    pixel selFg, selBg, heldBg;             // black on light grey, white when held by default
+} UI_List;
+
+// Choice between a set of values, shown as "<value>"
+typedef struct UI_Selector
+{
+    UI_Widget w;
+    int16_t col, row;
+    uint8_t width;                          // not counting the arrows
+    const char *const *values;
+    uint8_t count, selected;
+    pixel fg, bg;
+} UI_Selector;
+
+// Set up a panel
+//  Param:
+//      panel: panel
+//      x, y: top left corner in pixels
+//      width, height: size in pixels
+//      color: fill color
+void UI_PanelInit(UI_Panel *panel, int16_t x, int16_t y, uint8_t width, uint8_t height, pixel color);
+
+// Set up a label
+//  Param:
+//      label: label
+//      col, row: position of the first character
+//      width: characters taken up, the text is cut or padded to it
+//      text: text to show
+//      fg, bg: text and background colors. If they are the same, the background is not drawn
+void UI_LabelInit(UI_Label *label, int16_t col, int16_t row, uint8_t width, const char *text,
+                  pixel fg, pixel bg);
+
+// Change the text of a label
+//  Param:
+//      label: label
+//      text: text to show
+void UI_LabelSetText(UI_Label *label, const char *text);
+
+// Set up a list, with the first item selected
+//  Param:
+//      list: list
+//      col, row: position of the first item
+//      width: characters taken up by each item
+//      item: function giving the text of each item
+//      count: number of items, up to 32
+//      fg, bg: colors of the items that are not selected
+void UI_ListInit(UI_List *list, int16_t col, int16_t row, uint8_t width,
+                 const char *(*item)(uint8_t index), uint8_t count, pixel fg, pixel bg);
+
+// Select an item of a list
+//  Param:
+//      list: list
+//      index: item to select
+void UI_ListSelect(UI_List *list, uint8_t index);
+
+// Move the selection of a list, wrapping around at either end
+//  Param:
+//      list: list
+//      delta: items to move by, negative to move up
+void UI_ListMove(UI_List *list, int8_t delta);
+
+// Show the selected item of a list as held or not
+//  Param:
+//      list: list
+//      held: 1 if held
+void UI_ListSetHeld(UI_List *list, uint8_t held);
+
+// Set up a selector, with the first value selected
+//  Param:
+//      selector: selector
+//      col, row: position of the left arrow
+//      width: characters taken up by the values
+//      values: text of each value
+//      count: number of values
+//      fg, bg: colors
+void UI_SelectorInit(UI_Selector *selector, int16_t col, int16_t row, uint8_t width,
+                     const char *const *values, uint8_t count, pixel fg, pixel bg);
+
+// Move the value of a selector, wrapping around at either end
+//  Param:
+//      selector: selector
+//      delta: values to move by
+void UI_SelectorMove(UI_Selector *selector, int8_t delta);
+
+// Mark a whole widget to be redrawn
+//  Param:
+//      widget: widget
+void UI_Damage(UI_Widget *widget);
+
+// Draw the damaged parts of a screen
+//  Param:
+//      widgets: widgets of the screen, drawn in order
+//      n: number of widgets
+void UI_Draw(UI_Widget *const *widgets, uint8_t n);
+
+#endif // UI_H
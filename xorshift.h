@@ -1,8 +0,0 @@
-#ifndef XORSHIFT_H
-#define XORSHIFT_H
-
-#include <stdint.h>
-
-uint32_t xorshift32(uint32_t state);
-
-#endif // XORSHIFT_H
\ No newline at end of file